@@ -589,12 +589,6 @@ int main (int argc, char *argv[])
     arpra_range *syn_GSyn = malloc(p_syn_size * sizeof(arpra_range));
     arpra_range *I = malloc(p_in_size * sizeof(arpra_range));
     int *in = malloc(p_in_size * sizeof(int));
-    arpra_uint *nrn_M_reduce_epoch = malloc(p_nrn_size * sizeof(arpra_uint));
-    arpra_uint *nrn_H_reduce_epoch = malloc(p_nrn_size * sizeof(arpra_uint));
-    arpra_uint *nrn_N_reduce_epoch = malloc(p_nrn_size * sizeof(arpra_uint));
-    arpra_uint *nrn_V_reduce_epoch = malloc(p_nrn_size * sizeof(arpra_uint));
-    arpra_uint *syn_R_reduce_epoch = malloc(p_syn_size * sizeof(arpra_uint));
-    arpra_uint *syn_S_reduce_epoch = malloc(p_syn_size * sizeof(arpra_uint));
 
     mpfr_t in_p0, rand_uf, rand_nf;
     arpra_range nrn_GL, nrn_VL, nrn_GNa, nrn_VNa, nrn_GK, nrn_VK,
@@ -926,6 +920,15 @@ int main (int argc, char *argv[])
     //arpra_ode_stepper_init(&ode_stepper, &ode_system, arpra_ode_bogsham32);
     //arpra_ode_stepper_init(&ode_stepper, &ode_system, arpra_ode_dopri54);
     //arpra_ode_stepper_init(&ode_stepper, &ode_system, arpra_ode_dopri87);
+    //arpra_ode_stepper_init(&ode_stepper, &ode_system, arpra_ode_ros2);
+
+    // Deviation term reduction
+    arpra_ode_reduce ode_reduce = {
+        .step_terms = 1,
+        .rel_threshold = reduce_rel,
+        .interval = p_reduce_step,
+    };
+    arpra_ode_stepper_set_reduce(&ode_stepper, &ode_reduce);
 
 
     // Begin simulation loop
@@ -936,17 +939,6 @@ int main (int argc, char *argv[])
     for (i = 0; i < p_sim_steps; i++) {
         if (i % p_report_step == 0) printf("%lu\n", i);
 
-        for (j = 0; j < p_nrn_size; j++) {
-            nrn_M_reduce_epoch[j] = ode_system.x[grp_nrn_M][j].nTerms;
-            nrn_H_reduce_epoch[j] = ode_system.x[grp_nrn_H][j].nTerms;
-            nrn_N_reduce_epoch[j] = ode_system.x[grp_nrn_N][j].nTerms;
-            nrn_V_reduce_epoch[j] = ode_system.x[grp_nrn_V][j].nTerms;
-        }
-        for (j = 0; j < p_syn_size; j++) {
-            syn_R_reduce_epoch[j] = ode_system.x[grp_syn_R][j].nTerms;
-            syn_S_reduce_epoch[j] = ode_system.x[grp_syn_S][j].nTerms;
-        }
-
         // Event(s) occur if urandom >= e^-rate
         for (j = 0; j < p_in_size; j++) {
             mpfr_urandom(rand_uf, rng_uf, MPFR_RNDN);
@@ -955,40 +947,10 @@ int main (int argc, char *argv[])
         }
         fprintf(stderr, "\n");
 
-        // Step system
+        // Step system (inputs changed, so carried over stages are stale)
+        arpra_ode_stepper_invalidate(&ode_stepper);
         arpra_ode_stepper_step(&ode_stepper, &h);
 
-        arpra_uint reduce_n;
-        for (j = 0; j < p_nrn_size; j++) {
-            reduce_n = ode_system.x[grp_nrn_M][j].nTerms - nrn_M_reduce_epoch[j];
-            arpra_reduce_last_n(&(ode_system.x[grp_nrn_M][j]), &(ode_system.x[grp_nrn_M][j]), reduce_n);
-            reduce_n = ode_system.x[grp_nrn_H][j].nTerms - nrn_H_reduce_epoch[j];
-            arpra_reduce_last_n(&(ode_system.x[grp_nrn_H][j]), &(ode_system.x[grp_nrn_H][j]), reduce_n);
-            reduce_n = ode_system.x[grp_nrn_N][j].nTerms - nrn_N_reduce_epoch[j];
-            arpra_reduce_last_n(&(ode_system.x[grp_nrn_N][j]), &(ode_system.x[grp_nrn_N][j]), reduce_n);
-            reduce_n = ode_system.x[grp_nrn_V][j].nTerms - nrn_V_reduce_epoch[j];
-            arpra_reduce_last_n(&(ode_system.x[grp_nrn_V][j]), &(ode_system.x[grp_nrn_V][j]), reduce_n);
-        }
-        for (j = 0; j < p_syn_size; j++) {
-            reduce_n = ode_system.x[grp_syn_R][j].nTerms - syn_R_reduce_epoch[j];
-            arpra_reduce_last_n(&(ode_system.x[grp_syn_R][j]), &(ode_system.x[grp_syn_R][j]), reduce_n);
-            reduce_n = ode_system.x[grp_syn_S][j].nTerms - syn_S_reduce_epoch[j];
-            arpra_reduce_last_n(&(ode_system.x[grp_syn_S][j]), &(ode_system.x[grp_syn_S][j]), reduce_n);
-        }
-
-        if (i % p_reduce_step == 0) {
-            for (j = 0; j < p_nrn_size; j++) {
-                arpra_reduce_small_rel(&(ode_system.x[grp_nrn_M][j]), &(ode_system.x[grp_nrn_M][j]), reduce_rel);
-                arpra_reduce_small_rel(&(ode_system.x[grp_nrn_H][j]), &(ode_system.x[grp_nrn_H][j]), reduce_rel);
-                arpra_reduce_small_rel(&(ode_system.x[grp_nrn_N][j]), &(ode_system.x[grp_nrn_N][j]), reduce_rel);
-                arpra_reduce_small_rel(&(ode_system.x[grp_nrn_V][j]), &(ode_system.x[grp_nrn_V][j]), reduce_rel);
-            }
-            for (j = 0; j < p_syn_size; j++) {
-                arpra_reduce_small_rel(&(ode_system.x[grp_syn_R][j]), &(ode_system.x[grp_syn_R][j]), reduce_rel);
-                arpra_reduce_small_rel(&(ode_system.x[grp_syn_S][j]), &(ode_system.x[grp_syn_S][j]), reduce_rel);
-            }
-        }
-
         file_write(&sys_t, 1, f_time_c, f_time_r, f_time_n, f_time_s, f_time_d);
 
         file_write(nrn_M, p_nrn_size, f_nrn_M_c, f_nrn_M_r, f_nrn_M_n, f_nrn_M_s, f_nrn_M_d);
@@ -1002,6 +964,7 @@ int main (int argc, char *argv[])
 
     run_time = clock() - run_time;
     printf("Finished in %f seconds.\n", ((float) run_time) / CLOCKS_PER_SEC);
+    printf("Condensed %lu deviation terms.\n", ode_reduce.condensed);
 
     // End simulation loop
     // ===================
@@ -1089,12 +1052,6 @@ int main (int argc, char *argv[])
     free(syn_GSyn);
     free(I);
     free(in);
-    free(nrn_M_reduce_epoch);
-    free(nrn_H_reduce_epoch);
-    free(nrn_N_reduce_epoch);
-    free(nrn_V_reduce_epoch);
-    free(syn_R_reduce_epoch);
-    free(syn_S_reduce_epoch);
 
     // Clear report files
     file_clear(1, f_time_c, f_time_r, f_time_n, f_time_s, f_time_d);
@@ -1143,6 +1100,7 @@ int main (int argc, char *argv[])
     /* free(f_syn_S_d); */
 
     arpra_ode_stepper_clear(&ode_stepper);
+    arpra_ode_clear_tableaus();
     arpra_clear_buffers();
     gmp_randclear(rng_uf);
     gmp_randclear(rng_nf);
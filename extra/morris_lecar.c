@@ -221,62 +221,65 @@ struct dNdt_params
     arpra_range *pos_1;
     arpra_range *pos_2;
     arpra_range *neg_2;
-    arpra_range *temp1;
-    arpra_range *temp2;
-    arpra_range *N_ss;
 };
 
-void dNdt (arpra_range *y, const void *params,
+void dNdt (arpra_range *y, const void *params, arpra_range *temp,
            const arpra_range *t, const arpra_range **x,
-           const arpra_uint x_grp, const arpra_uint x_dim)
+           const arpra_uint x_grp, const arpra_uint x_dims)
 {
     const struct dNdt_params *p = (struct dNdt_params *) params;
-    const arpra_range *N = &(x[x_grp][x_dim]);
-    const arpra_range *V = &(x[p->grp_V][x_dim]);
     const arpra_range *V3 = p->V3;
     const arpra_range *V4 = p->V4;
     const arpra_range *phi = p->phi;
     const arpra_range *pos_1 = p->pos_1;
     const arpra_range *pos_2 = p->pos_2;
     const arpra_range *neg_2 = p->neg_2;
-    arpra_range *temp1 = p->temp1;
-    arpra_range *temp2 = p->temp2;
-    arpra_range *N_ss = p->N_ss;
-
-    // K+ channel activation steady-state
-    // N_ss = 1 / (1 + exp(-2 (V - V3) / V4))
-    arpra_sub(temp1, V, V3);
-    arpra_mul(N_ss, neg_2, temp1);
-    arpra_div(N_ss, N_ss, V4);
-    arpra_exp(N_ss, N_ss);
-    arpra_add(N_ss, pos_1, N_ss);
-    arpra_inv(N_ss, N_ss);
-
-    // tau of K+ channel activation
-    // tau = 1 / (phi ((p + q) / 2))
-    // p = exp(-(V - V3) / (2 V4))
-    // q = exp( (V - V3) / (2 V4))
-    arpra_mul(temp2, pos_2, V4);
-    arpra_div(temp2, temp1, temp2);
-    arpra_neg(temp1, temp2);
-    arpra_exp(temp1, temp1);
-    arpra_exp(temp2, temp2);
-    arpra_add(temp1, temp1, temp2);
-    arpra_div(temp1, temp1, pos_2);
-    arpra_mul(temp1, phi, temp1);
-    arpra_inv(temp1, temp1);
-
-    // delta of K+ channel activation
-    // dN/dt = (N_ss - N) / tau
-    arpra_sub(y, N_ss, N);
-    arpra_div(y, y, temp1);
+    arpra_range *V4_2 = &(temp[0]);
+    arpra_range *temp1 = &(temp[1]);
+    arpra_range *temp2 = &(temp[2]);
+    arpra_range *N_ss = &(temp[3]);
+    arpra_uint x_dim;
+
+    // 2 V4 is the same for all neurons
+    arpra_mul(V4_2, pos_2, V4);
+
+    for (x_dim = 0; x_dim < x_dims; x_dim++) {
+        const arpra_range *N = &(x[x_grp][x_dim]);
+        const arpra_range *V = &(x[p->grp_V][x_dim]);
+
+        // K+ channel activation steady-state
+        // N_ss = 1 / (1 + exp(-2 (V - V3) / V4))
+        arpra_sub(temp1, V, V3);
+        arpra_mul(N_ss, neg_2, temp1);
+        arpra_div(N_ss, N_ss, V4);
+        arpra_exp(N_ss, N_ss);
+        arpra_add(N_ss, pos_1, N_ss);
+        arpra_inv(N_ss, N_ss);
+
+        // tau of K+ channel activation
+        // tau = 1 / (phi ((p + q) / 2))
+        // p = exp(-(V - V3) / (2 V4))
+        // q = exp( (V - V3) / (2 V4))
+        arpra_div(temp2, temp1, V4_2);
+        arpra_neg(temp1, temp2);
+        arpra_exp(temp1, temp1);
+        arpra_exp(temp2, temp2);
+        arpra_add(temp1, temp1, temp2);
+        arpra_div(temp1, temp1, pos_2);
+        arpra_mul(temp1, phi, temp1);
+        arpra_inv(temp1, temp1);
+
+        // delta of K+ channel activation
+        // dN/dt = (N_ss - N) / tau
+        arpra_sub(&(y[x_dim]), N_ss, N);
+        arpra_div(&(y[x_dim]), &(y[x_dim]), temp1);
+    }
 }
 
 struct dVdt_params
 {
     arpra_uint grp_N;
-    arpra_uint grp_S;
-    arpra_range *GSyn;
+    arpra_range *ISyn;
     arpra_range *VSyn;
     arpra_range *GL;
     arpra_range *VL;
@@ -287,10 +290,8 @@ struct dVdt_params
     arpra_range *V1;
     arpra_range *V2;
     arpra_range *C;
-    arpra_uint pre_syn_size;
     arpra_range *pos_1;
     arpra_range *neg_2;
-    arpra_range *I;
     arpra_range *temp1;
     arpra_range *M_ss;
 };
@@ -302,8 +303,7 @@ void dVdt (arpra_range *y, const void *params,
     const struct dVdt_params *p = (struct dVdt_params *) params;
     const arpra_range *V = &(x[x_grp][x_dim]);
     const arpra_range *N = &(x[p->grp_N][x_dim]);
-    const arpra_range *S = &(x[p->grp_S][x_dim * p->pre_syn_size]);
-    const arpra_range *GSyn = &(p->GSyn[x_dim * p->pre_syn_size]);
+    const arpra_range *ISyn = &(p->ISyn[x_dim]);
     const arpra_range *VSyn = p->VSyn;
     const arpra_range *GL = p->GL;
     const arpra_range *VL = p->VL;
@@ -316,10 +316,8 @@ void dVdt (arpra_range *y, const void *params,
     const arpra_range *C = p->C;
     const arpra_range *pos_1 = p->pos_1;
     const arpra_range *neg_2 = p->neg_2;
-    arpra_range *I = p->I;
     arpra_range *temp1 = p->temp1;
     arpra_range *M_ss = p->M_ss;
-    arpra_uint i;
 
     // Ca++ channel activation steady-state
     // M_ss = 1 / (1 + exp(-2 (V - V1) / V2))
@@ -331,18 +329,9 @@ void dVdt (arpra_range *y, const void *params,
     arpra_inv(M_ss, M_ss);
 
     // Synapse current
+    // ISyn = GSyn_1 S_1 + ... + GSyn_n S_n is the coupled sum of this neuron.
     arpra_sub(temp1, VSyn, V);
-    for (i = 0; i < p->pre_syn_size; i++) {
-        arpra_mul(&(I[i]), temp1, &(GSyn[i]));
-        arpra_mul(&(I[i]), &(I[i]), &(S[i]));
-    }
-    if (p->pre_syn_size > 0) {
-        arpra_sum_recursive(y, I, p->pre_syn_size);
-        //arpra_sum(y, I, p->pre_syn_size);
-    }
-    else {
-        arpra_set_zero(y);
-    }
+    arpra_mul(y, temp1, ISyn);
 
     // Leak current
     arpra_sub(temp1, V, VL);
@@ -496,17 +485,15 @@ int main (int argc, char *argv[])
 
     // Allocate other arrays
     arpra_range *syn_GSyn = malloc(p_syn_size * sizeof(arpra_range));
-    arpra_range *I = malloc(p_in_size * sizeof(arpra_range));
+    arpra_range *nrn_ISyn = malloc(p_nrn_size * sizeof(arpra_range));
+    arpra_uint *syn_row = malloc((p_nrn_size + 1) * sizeof(arpra_uint));
+    arpra_uint *syn_col = malloc(p_syn_size * sizeof(arpra_uint));
     int *in = malloc(p_in_size * sizeof(int));
-    arpra_uint *nrn_N_reduce_epoch = malloc(p_nrn_size * sizeof(arpra_uint));
-    arpra_uint *nrn_V_reduce_epoch = malloc(p_nrn_size * sizeof(arpra_uint));
-    arpra_uint *syn_R_reduce_epoch = malloc(p_syn_size * sizeof(arpra_uint));
-    arpra_uint *syn_S_reduce_epoch = malloc(p_syn_size * sizeof(arpra_uint));
 
     mpfr_t in_p0, rand_uf, rand_nf;
     arpra_range nrn_GL, nrn_VL, nrn_GCa, nrn_VCa, nrn_GK, nrn_VK, nrn_V1, nrn_V2,
         nrn_V3, nrn_V4, nrn_phi, nrn_C, syn_VSyn, syn_thr, syn_a, syn_b, syn_k,
-        pos_1, pos_2, neg_2, temp1, temp2, M_ss, N_ss, in_V_lo, in_V_hi;
+        pos_1, pos_2, neg_2, temp1, temp2, M_ss, in_V_lo, in_V_hi;
 
     struct timespec clock_time;
 
@@ -586,9 +573,8 @@ int main (int argc, char *argv[])
     arpra_init2(&temp1, p_prec);
     arpra_init2(&temp2, p_prec);
     arpra_init2(&M_ss, p_prec);
-    arpra_init2(&N_ss, p_prec);
-    for (i = 0; i < p_in_size; i++) {
-        arpra_init2(&(I[i]), p_prec);
+    for (i = 0; i < p_nrn_size; i++) {
+        arpra_init2(&(nrn_ISyn[i]), p_prec);
     }
 
     // Set system state
@@ -685,15 +671,11 @@ int main (int argc, char *argv[])
         .pos_1 = &pos_1,
         .pos_2 = &pos_2,
         .neg_2 = &neg_2,
-        .temp1 = &temp1,
-        .temp2 = &temp2,
-        .N_ss = &N_ss,
     };
 
     struct dVdt_params params_nrn_V = {
         .grp_N = grp_nrn_N,
-        .grp_S = grp_syn_S,
-        .GSyn = syn_GSyn,
+        .ISyn = nrn_ISyn,
         .VSyn = &syn_VSyn,
         .GL = &nrn_GL,
         .VL = &nrn_VL,
@@ -704,10 +686,8 @@ int main (int argc, char *argv[])
         .V1 = &nrn_V1,
         .V2 = &nrn_V2,
         .C = &nrn_C,
-        .pre_syn_size = p_in_size,
         .pos_1 = &pos_1,
         .neg_2 = &neg_2,
-        .I = I,
         .temp1 = &temp1,
         .M_ss = &M_ss,
     };
@@ -741,7 +721,13 @@ int main (int argc, char *argv[])
         p_syn_size, p_syn_size,
     };
     arpra_ode_f sys_f[4] = {
-        dNdt, dVdt, dRdt, dSdt,
+        NULL, dVdt, dRdt, dSdt,
+    };
+    arpra_ode_f_grp sys_f_grp[4] = {
+        dNdt, NULL, NULL, NULL,
+    };
+    arpra_uint sys_f_grp_temps[4] = {
+        4, 0, 0, 0,
     };
     void *sys_params[4] = {
         &params_nrn_N, &params_nrn_V,
@@ -750,13 +736,35 @@ int main (int argc, char *argv[])
     arpra_range *sys_x[4] = {
         nrn_N, nrn_V, syn_R, syn_S,
     };
+
+    // Synapse S to neuron ISyn coupling
+    for (i = 0; i < p_nrn_size; i++) {
+        syn_row[i] = i * p_in_size;
+    }
+    syn_row[p_nrn_size] = p_syn_size;
+    for (i = 0; i < p_syn_size; i++) {
+        syn_col[i] = i;
+    }
+    arpra_ode_coupling sys_coupling = {
+        .x_grp = grp_syn_S,
+        .rows = p_nrn_size,
+        .row = syn_row,
+        .col = syn_col,
+        .weight = syn_GSyn,
+        .sum = nrn_ISyn,
+    };
+
     arpra_ode_system ode_system = {
         .f = sys_f,
+        .f_grp = sys_f_grp,
+        .f_grp_temps = sys_f_grp_temps,
         .params = sys_params,
         .t = &sys_t,
         .x = sys_x,
         .grps = sys_grps,
         .dims = sys_dims,
+        .coupling = &sys_coupling,
+        .n_coupling = 1,
     };
 
     // ODE stepper
@@ -766,6 +774,15 @@ int main (int argc, char *argv[])
     //arpra_ode_stepper_init(&ode_stepper, &ode_system, arpra_ode_bogsham32);
     //arpra_ode_stepper_init(&ode_stepper, &ode_system, arpra_ode_dopri54);
     //arpra_ode_stepper_init(&ode_stepper, &ode_system, arpra_ode_dopri87);
+    //arpra_ode_stepper_init(&ode_stepper, &ode_system, arpra_ode_ros2);
+
+    // Deviation term reduction
+    arpra_ode_reduce ode_reduce = {
+        .step_terms = 1,
+        .rel_threshold = reduce_rel,
+        .interval = p_reduce_step,
+    };
+    arpra_ode_stepper_set_reduce(&ode_stepper, &ode_reduce);
 
 
     // Begin simulation loop
@@ -776,15 +793,6 @@ int main (int argc, char *argv[])
     for (i = 0; i < p_sim_steps; i++) {
         if (i % p_report_step == 0) printf("%lu\n", i);
 
-        for (j = 0; j < p_nrn_size; j++) {
-            nrn_N_reduce_epoch[j] = ode_system.x[grp_nrn_N][j].nTerms;
-            nrn_V_reduce_epoch[j] = ode_system.x[grp_nrn_V][j].nTerms;
-        }
-        for (j = 0; j < p_syn_size; j++) {
-            syn_R_reduce_epoch[j] = ode_system.x[grp_syn_R][j].nTerms;
-            syn_S_reduce_epoch[j] = ode_system.x[grp_syn_S][j].nTerms;
-        }
-
         // Event(s) occur if urandom >= e^-rate
         for (j = 0; j < p_in_size; j++) {
             mpfr_urandom(rand_uf, rng_uf, MPFR_RNDN);
@@ -793,34 +801,10 @@ int main (int argc, char *argv[])
         }
         fprintf(stderr, "\n");
 
-        // Step system
+        // Step system (inputs changed, so carried over stages are stale)
+        arpra_ode_stepper_invalidate(&ode_stepper);
         arpra_ode_stepper_step(&ode_stepper, &h);
 
-        arpra_uint reduce_n;
-        for (j = 0; j < p_nrn_size; j++) {
-            reduce_n = ode_system.x[grp_nrn_N][j].nTerms - nrn_N_reduce_epoch[j];
-            arpra_reduce_last_n(&(ode_system.x[grp_nrn_N][j]), &(ode_system.x[grp_nrn_N][j]), reduce_n);
-            reduce_n = ode_system.x[grp_nrn_V][j].nTerms - nrn_V_reduce_epoch[j];
-            arpra_reduce_last_n(&(ode_system.x[grp_nrn_V][j]), &(ode_system.x[grp_nrn_V][j]), reduce_n);
-        }
-        for (j = 0; j < p_syn_size; j++) {
-            reduce_n = ode_system.x[grp_syn_R][j].nTerms - syn_R_reduce_epoch[j];
-            arpra_reduce_last_n(&(ode_system.x[grp_syn_R][j]), &(ode_system.x[grp_syn_R][j]), reduce_n);
-            reduce_n = ode_system.x[grp_syn_S][j].nTerms - syn_S_reduce_epoch[j];
-            arpra_reduce_last_n(&(ode_system.x[grp_syn_S][j]), &(ode_system.x[grp_syn_S][j]), reduce_n);
-        }
-
-        if (i % p_reduce_step == 0) {
-            for (j = 0; j < p_nrn_size; j++) {
-                arpra_reduce_small_rel(&(ode_system.x[grp_nrn_N][j]), &(ode_system.x[grp_nrn_N][j]), reduce_rel);
-                arpra_reduce_small_rel(&(ode_system.x[grp_nrn_V][j]), &(ode_system.x[grp_nrn_V][j]), reduce_rel);
-            }
-            for (j = 0; j < p_syn_size; j++) {
-                arpra_reduce_small_rel(&(ode_system.x[grp_syn_R][j]), &(ode_system.x[grp_syn_R][j]), reduce_rel);
-                arpra_reduce_small_rel(&(ode_system.x[grp_syn_S][j]), &(ode_system.x[grp_syn_S][j]), reduce_rel);
-            }
-        }
-
         file_write(&sys_t, 1, f_time_c, f_time_r, f_time_n, f_time_s, f_time_d);
 
         file_write(nrn_N, p_nrn_size, f_nrn_N_c, f_nrn_N_r, f_nrn_N_n, f_nrn_N_s, f_nrn_N_d);
@@ -832,6 +816,7 @@ int main (int argc, char *argv[])
 
     run_time = clock() - run_time;
     printf("Finished in %f seconds.\n", ((float) run_time) / CLOCKS_PER_SEC);
+    printf("Condensed %lu deviation terms.\n", ode_reduce.condensed);
 
     // End simulation loop
     // ===================
@@ -892,9 +877,8 @@ int main (int argc, char *argv[])
     arpra_clear(&temp1);
     arpra_clear(&temp2);
     arpra_clear(&M_ss);
-    arpra_clear(&N_ss);
-    for (i = 0; i < p_in_size; i++) {
-        arpra_clear(&(I[i]));
+    for (i = 0; i < p_nrn_size; i++) {
+        arpra_clear(&(nrn_ISyn[i]));
     }
 
     // Free system state
@@ -905,12 +889,10 @@ int main (int argc, char *argv[])
 
     // Free other arrays
     free(syn_GSyn);
-    free(I);
+    free(nrn_ISyn);
+    free(syn_row);
+    free(syn_col);
     free(in);
-    free(nrn_N_reduce_epoch);
-    free(nrn_V_reduce_epoch);
-    free(syn_R_reduce_epoch);
-    free(syn_S_reduce_epoch);
 
     // Clear report files
     file_clear(1, f_time_c, f_time_r, f_time_n, f_time_s, f_time_d);
@@ -947,6 +929,7 @@ int main (int argc, char *argv[])
     /* free(f_syn_S_d); */
 
     arpra_ode_stepper_clear(&ode_stepper);
+    arpra_ode_clear_tableaus();
     arpra_clear_buffers();
     gmp_randclear(rng_uf);
     gmp_randclear(rng_nf);
@@ -0,0 +1,417 @@
+/*
+ * stiff_bench.c -- Compare Rosenbrock and explicit steppers on neuron models.
+ *
+ * Copyright 2016-2021 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <arpra_ode.h>
+
+/*
+ * A single Hodgkin-Huxley (hh) or Morris-Lecar (ml) neuron, with the
+ * parameters of extra/hodgkin_huxley.c and extra/morris_lecar.c, driven
+ * by a step current which is switched on at t_on.
+ *
+ * The Rosenbrock stepper is run first with the model's step p_h. The
+ * explicit stepper is then run with successively halved steps until its
+ * final enclosure is no wider than the Rosenbrock one, and the wall time
+ * of each is reported.
+ *
+ * Usage: stiff_bench <hh|ml>
+ */
+
+// General parameters
+#define p_prec 53
+#define p_prec_internal 256
+#define p_max_halvings 6
+#define p_max_terms 32
+#define p_V0_width 1.0E-6
+
+// Hodgkin-Huxley parameters
+#define p_hh_h 0.05
+#define p_hh_t_end 20.0
+#define p_hh_t_on 5.0
+#define p_hh_I 0.2
+#define p_hh_M0 0.0
+#define p_hh_H0 0.0
+#define p_hh_N0 0.0
+#define p_hh_V0 -60.0
+#define p_hh_GL 0.02672
+#define p_hh_GNa 7.15
+#define p_hh_GK 1.43
+#define p_hh_VL -63.563
+#define p_hh_VNa 50.0
+#define p_hh_VK -95.0
+#define p_hh_C 0.143
+
+// Morris-Lecar parameters (class 1)
+#define p_ml_h 0.5
+#define p_ml_t_end 100.0
+#define p_ml_t_on 20.0
+#define p_ml_I 60.0
+#define p_ml_N0 0.0
+#define p_ml_V0 -60.0
+#define p_ml_GL 2.0
+#define p_ml_GCa 4.0
+#define p_ml_GK 8.0
+#define p_ml_VL -60.0
+#define p_ml_VCa 120.0
+#define p_ml_VK -80.0
+#define p_ml_V1 -1.2
+#define p_ml_V2 18.0
+#define p_ml_V3 12.0
+#define p_ml_V4 17.4
+#define p_ml_phi 1.0 / 15.0
+#define p_ml_C 20.0
+
+// ===================== end of model parameters ======================
+
+
+struct model_params
+{
+    arpra_range *c;
+    arpra_range *a;
+    arpra_range *b;
+    arpra_range *temp1;
+    arpra_range *temp2;
+};
+
+// y = k u / (exp(u / s) - 1)
+void rate_lin (arpra_range *y, const arpra_range *u, double s, double k,
+               const struct model_params *p)
+{
+    arpra_set_d(p->c, s);
+    arpra_div(p->temp2, u, p->c);
+    arpra_exp(p->temp2, p->temp2);
+    arpra_set_d(p->c, 1.0);
+    arpra_sub(p->temp2, p->temp2, p->c);
+    arpra_div(y, u, p->temp2);
+    arpra_set_d(p->c, k);
+    arpra_mul(y, p->c, y);
+}
+
+// y = k exp(u / s)
+void rate_exp (arpra_range *y, const arpra_range *u, double s, double k,
+               const struct model_params *p)
+{
+    arpra_set_d(p->c, s);
+    arpra_div(y, u, p->c);
+    arpra_exp(y, y);
+    arpra_set_d(p->c, k);
+    arpra_mul(y, p->c, y);
+}
+
+// y = k / (exp(u / s) + 1)
+void rate_sig (arpra_range *y, const arpra_range *u, double s, double k,
+               const struct model_params *p)
+{
+    arpra_set_d(p->c, s);
+    arpra_div(y, u, p->c);
+    arpra_exp(y, y);
+    arpra_set_d(p->c, 1.0);
+    arpra_add(y, y, p->c);
+    arpra_set_d(p->c, k);
+    arpra_div(y, p->c, y);
+}
+
+// y = v - V
+void offset (arpra_range *y, double v, const arpra_range *V, const struct model_params *p)
+{
+    arpra_set_d(p->c, v);
+    arpra_sub(y, p->c, V);
+}
+
+// y = y + G (E - V) X
+void current (arpra_range *y, double G, double E, const arpra_range *V, const arpra_range *X,
+              const struct model_params *p)
+{
+    offset(p->temp2, E, V, p);
+    arpra_set_d(p->c, G);
+    arpra_mul(p->temp2, p->temp2, p->c);
+    if (X != NULL) {
+        arpra_mul(p->temp2, p->temp2, X);
+    }
+    arpra_add(y, y, p->temp2);
+}
+
+// y = a (1 - X) - b X
+void gate (arpra_range *y, const arpra_range *X, const struct model_params *p)
+{
+    arpra_set_d(p->c, 1.0);
+    arpra_sub(p->temp1, p->c, X);
+    arpra_mul(p->temp1, p->a, p->temp1);
+    arpra_mul(p->temp2, p->b, X);
+    arpra_sub(y, p->temp1, p->temp2);
+}
+
+void hh_f (arpra_range *y, const void *params,
+           const arpra_range *t, const arpra_range **x,
+           const arpra_uint x_grp, const arpra_uint x_dim)
+{
+    const struct model_params *p = (struct model_params *) params;
+    const arpra_range *M = &(x[0][x_dim]);
+    const arpra_range *H = &(x[1][x_dim]);
+    const arpra_range *N = &(x[2][x_dim]);
+    const arpra_range *V = &(x[3][x_dim]);
+
+    switch (x_grp) {
+    case 0:
+        // dM/dt = M_a (1 - M) - M_b M
+        // M_a = 0.32 (-52 - V) / (exp((-52 - V) / 4) - 1)
+        // M_b = 0.28 (V + 25) / (exp((V + 25) / 5) - 1)
+        offset(p->temp1, -52.0, V, p);
+        rate_lin(p->a, p->temp1, 4.0, 0.32, p);
+        offset(p->temp1, -25.0, V, p);
+        arpra_neg(p->temp1, p->temp1);
+        rate_lin(p->b, p->temp1, 5.0, 0.28, p);
+        gate(y, M, p);
+        break;
+    case 1:
+        // dH/dt = H_a (1 - H) - H_b H
+        // H_a = 0.128 exp((-48 - V) / 18)
+        // H_b = 4 / (exp((-25 - V) / 5) + 1)
+        offset(p->temp1, -48.0, V, p);
+        rate_exp(p->a, p->temp1, 18.0, 0.128, p);
+        offset(p->temp1, -25.0, V, p);
+        rate_sig(p->b, p->temp1, 5.0, 4.0, p);
+        gate(y, H, p);
+        break;
+    case 2:
+        // dN/dt = N_a (1 - N) - N_b N
+        // N_a = 0.032 (-50 - V) / (exp((-50 - V) / 5) - 1)
+        // N_b = 0.5 exp((-55 - V) / 40)
+        offset(p->temp1, -50.0, V, p);
+        rate_lin(p->a, p->temp1, 5.0, 0.032, p);
+        offset(p->temp1, -55.0, V, p);
+        rate_exp(p->b, p->temp1, 40.0, 0.5, p);
+        gate(y, N, p);
+        break;
+    default:
+        // dV/dt = (I + GL (VL - V) + GNa M^3 H (VNa - V) + GK N^4 (VK - V)) / C
+        arpra_set_d(y, (mpfr_cmp_d(&(t->centre), p_hh_t_on) >= 0) ? p_hh_I : 0.0);
+        current(y, p_hh_GL, p_hh_VL, V, NULL, p);
+        arpra_mul(p->a, M, M);
+        arpra_mul(p->a, p->a, M);
+        arpra_mul(p->a, p->a, H);
+        current(y, p_hh_GNa, p_hh_VNa, V, p->a, p);
+        arpra_mul(p->a, N, N);
+        arpra_mul(p->a, p->a, p->a);
+        current(y, p_hh_GK, p_hh_VK, V, p->a, p);
+        arpra_set_d(p->c, p_hh_C);
+        arpra_div(y, y, p->c);
+        break;
+    }
+}
+
+void ml_f (arpra_range *y, const void *params,
+           const arpra_range *t, const arpra_range **x,
+           const arpra_uint x_grp, const arpra_uint x_dim)
+{
+    const struct model_params *p = (struct model_params *) params;
+    const arpra_range *N = &(x[0][x_dim]);
+    const arpra_range *V = &(x[1][x_dim]);
+
+    switch (x_grp) {
+    case 0:
+        // dN/dt = phi cosh((V - V3) / (2 V4)) (N_ss - N)
+        // N_ss = 1 / (1 + exp(-2 (V - V3) / V4))
+        offset(p->temp1, p_ml_V3, V, p);
+        rate_sig(p->a, p->temp1, p_ml_V4 / 2.0, 1.0, p);
+        rate_exp(p->b, p->temp1, 2.0 * p_ml_V4, p_ml_phi / 2.0, p);
+        arpra_neg(p->temp1, p->temp1);
+        rate_exp(p->temp1, p->temp1, 2.0 * p_ml_V4, p_ml_phi / 2.0, p);
+        arpra_add(p->b, p->b, p->temp1);
+        arpra_sub(y, p->a, N);
+        arpra_mul(y, p->b, y);
+        break;
+    default:
+        // dV/dt = (I + GL (VL - V) + GCa M_ss (VCa - V) + GK N (VK - V)) / C
+        // M_ss = 1 / (1 + exp(-2 (V - V1) / V2))
+        arpra_set_d(y, (mpfr_cmp_d(&(t->centre), p_ml_t_on) >= 0) ? p_ml_I : 0.0);
+        current(y, p_ml_GL, p_ml_VL, V, NULL, p);
+        offset(p->temp1, p_ml_V1, V, p);
+        rate_sig(p->a, p->temp1, p_ml_V2 / 2.0, 1.0, p);
+        current(y, p_ml_GCa, p_ml_VCa, V, p->a, p);
+        current(y, p_ml_GK, p_ml_VK, V, N, p);
+        arpra_set_d(p->c, p_ml_C);
+        arpra_div(y, y, p->c);
+        break;
+    }
+}
+
+double run (arpra_ode_system *system, const double *x0, const arpra_ode_method *method,
+            const double h_d, const double t_end, mpfr_ptr radius)
+{
+    arpra_ode_stepper stepper;
+    arpra_ode_reduce reduce = {
+        .step_terms = 1,
+        .max_terms = p_max_terms,
+    };
+    arpra_range h;
+    mpfi_t V0;
+    arpra_uint i, x_grp, steps;
+    clock_t run_time;
+
+    arpra_init2(&h, p_prec);
+    arpra_set_d(&h, h_d);
+    mpfi_init2(V0, p_prec);
+
+    // Reset system state, with an uncertain membrane potential (the last group)
+    arpra_set_zero(system->t);
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        arpra_set_d(&(system->x[x_grp][0]), x0[x_grp]);
+    }
+    mpfi_interv_d(V0, x0[x_grp - 1] - p_V0_width, x0[x_grp - 1] + p_V0_width);
+    arpra_set_mpfi(&(system->x[x_grp - 1][0]), V0);
+
+    arpra_ode_stepper_init(&stepper, system, method);
+    arpra_ode_stepper_set_reduce(&stepper, &reduce);
+    steps = (arpra_uint) (t_end / h_d + 0.5);
+
+    run_time = clock();
+    for (i = 0; i < steps; i++) {
+        arpra_ode_stepper_step(&stepper, &h);
+    }
+    run_time = clock() - run_time;
+
+    // Widest final enclosure
+    mpfr_set_zero(radius, 1);
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        if (!arpra_bounded_p(&(system->x[x_grp][0]))) {
+            mpfr_set_inf(radius, 1);
+            break;
+        }
+        mpfr_max(radius, radius, &(system->x[x_grp][0].radius), MPFR_RNDU);
+    }
+
+    arpra_ode_stepper_clear(&stepper);
+    arpra_clear(&h);
+    mpfi_clear(V0);
+
+    return ((double) run_time) / CLOCKS_PER_SEC;
+}
+
+int main (int argc, char *argv[])
+{
+    arpra_range c, a, b, temp1, temp2, sys_t;
+    arpra_range X[4];
+    arpra_range *sys_x[4];
+    arpra_ode_f sys_f[4];
+    void *sys_params[4];
+    arpra_uint sys_dims[4] = {1, 1, 1, 1};
+    arpra_uint sys_grps, i;
+    mpfr_t radius_ros2, radius;
+    double h_d, time_ros2, time;
+
+    const double hh_x0[4] = {p_hh_M0, p_hh_H0, p_hh_N0, p_hh_V0};
+    const double ml_x0[2] = {p_ml_N0, p_ml_V0};
+    const double *x0;
+    double p_h, p_t_end;
+    arpra_ode_f model_f;
+
+    if ((argc == 2) && (strcmp(argv[1], "hh") == 0)) {
+        sys_grps = 4;
+        model_f = hh_f;
+        x0 = hh_x0;
+        p_h = p_hh_h;
+        p_t_end = p_hh_t_end;
+    }
+    else if ((argc == 2) && (strcmp(argv[1], "ml") == 0)) {
+        sys_grps = 2;
+        model_f = ml_f;
+        x0 = ml_x0;
+        p_h = p_ml_h;
+        p_t_end = p_ml_t_end;
+    }
+    else {
+        printf("Usage: stiff_bench <hh|ml>\n");
+        return 1;
+    }
+
+    arpra_set_internal_precision(p_prec_internal);
+
+    arpra_init2(&c, p_prec);
+    arpra_init2(&a, p_prec);
+    arpra_init2(&b, p_prec);
+    arpra_init2(&temp1, p_prec);
+    arpra_init2(&temp2, p_prec);
+    arpra_init2(&sys_t, p_prec);
+    mpfr_init2(radius_ros2, p_prec);
+    mpfr_init2(radius, p_prec);
+
+    struct model_params params = {
+        .c = &c,
+        .a = &a,
+        .b = &b,
+        .temp1 = &temp1,
+        .temp2 = &temp2,
+    };
+
+    // ODE system
+    for (i = 0; i < sys_grps; i++) {
+        arpra_init2(&(X[i]), p_prec);
+        sys_x[i] = &(X[i]);
+        sys_f[i] = model_f;
+        sys_params[i] = &params;
+    }
+    arpra_ode_system ode_system = {
+        .f = sys_f,
+        .params = sys_params,
+        .t = &sys_t,
+        .x = sys_x,
+        .grps = sys_grps,
+        .dims = sys_dims,
+    };
+
+    // Rosenbrock with finite-difference Jacobian
+    time_ros2 = run(&ode_system, x0, arpra_ode_ros2, p_h, p_t_end, radius_ros2);
+    mpfr_printf("ros2    h = %g: %f seconds, radius %.6Re\n", p_h, time_ros2, radius_ros2);
+
+    // Explicit stepper, halving h until the enclosure is as tight
+    for (i = 0, h_d = p_h; i <= p_max_halvings; i++, h_d /= 2) {
+        time = run(&ode_system, x0, arpra_ode_dopri54, h_d, p_t_end, radius);
+        mpfr_printf("dopri54 h = %g: %f seconds, radius %.6Re\n", h_d, time, radius);
+        if (mpfr_lessequal_p(radius, radius_ros2)) break;
+    }
+    if (i > p_max_halvings) {
+        printf("dopri54 did not reach the ros2 enclosure width.\n");
+    }
+    else {
+        printf("dopri54/ros2 wall time ratio: %f\n", time / time_ros2);
+    }
+
+    for (i = 0; i < sys_grps; i++) {
+        arpra_clear(&(X[i]));
+    }
+    arpra_clear(&c);
+    arpra_clear(&a);
+    arpra_clear(&b);
+    arpra_clear(&temp1);
+    arpra_clear(&temp2);
+    arpra_clear(&sys_t);
+    mpfr_clear(radius_ros2);
+    mpfr_clear(radius);
+    arpra_ode_clear_tableaus();
+    arpra_clear_buffers();
+    mpfr_free_cache();
+
+    return 0;
+}
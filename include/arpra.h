@@ -22,6 +22,7 @@
 #ifndef ARPRA_H
 #define ARPRA_H
 
+#include <stdio.h>
 #include <mpfr.h>
 #include <mpfi.h>
 
@@ -43,6 +44,21 @@ struct arpra_range_struct
     arpra_uint nTerms;
 };
 
+// The Arpra accumulator struct.
+typedef struct arpra_accumulator_struct arpra_accumulator;
+struct arpra_accumulator_struct
+{
+    arpra_prec precision;
+    __mpfr_struct centre;
+    __mpfr_struct error;
+    __mpfi_struct true_range;
+    struct arpra_accumulator_run_struct *runs;
+    arpra_uint nRuns;
+    arpra_uint nAlloc;
+    arpra_uint nInf;
+    int nan;
+};
+
 // Range analysis method enum.
 typedef enum arpra_range_method_enum arpra_range_method;
 enum arpra_range_method_enum
@@ -68,6 +84,7 @@ extern "C" {
 void arpra_init (arpra_range *y);
 void arpra_init2 (arpra_range *y, arpra_prec prec);
 void arpra_clear (arpra_range *y);
+void arpra_swap (arpra_range *x1, arpra_range *x2);
 
 // Get from an Arpra range.
 void arpra_get_bounds (mpfr_ptr y_lo, mpfr_ptr y_hi, const arpra_range *x);
@@ -81,6 +98,11 @@ void arpra_get_mpfi (mpfi_ptr y, const arpra_range *x);
 #define arpra_set_str(y, x1, base) arpra_mpfr_set_str(y, x1, base)
 void arpra_set_mpfi (arpra_range *y, mpfi_srcptr x1);
 
+// Binary import and export. Imported ranges keep their saved symbols, and the
+// symbol counter is advanced past them.
+int arpra_fpif_export (FILE *stream, const arpra_range *x);
+int arpra_fpif_import (arpra_range *y, FILE *stream);
+
 // Set special values.
 void arpra_set_nan (arpra_range *y);
 void arpra_set_inf (arpra_range *y);
@@ -104,11 +126,25 @@ void arpra_inv (arpra_range *y, const arpra_range *x1);
 // Summation operations.
 void arpra_sum (arpra_range *y, arpra_range *x, arpra_uint n);
 void arpra_sum_recursive (arpra_range *y, arpra_range *x, arpra_uint n);
+void arpra_lincomb (arpra_range *y, const arpra_range *x, const mpfr_ptr *alpha, arpra_uint n);
+
+// Streaming accumulation.
+void arpra_accumulator_init (arpra_accumulator *acc, arpra_prec prec);
+void arpra_accumulator_clear (arpra_accumulator *acc);
+void arpra_accumulator_add (arpra_accumulator *acc, const arpra_range *x1);
+void arpra_accumulator_add_scaled (arpra_accumulator *acc, const arpra_range *x1, mpfr_srcptr alpha);
+void arpra_accumulator_add_product (arpra_accumulator *acc, const arpra_range *x1, const arpra_range *x2);
+void arpra_accumulator_finalise (arpra_range *y, arpra_accumulator *acc);
 
 // Deviation term reduction.
 void arpra_reduce_last_n (arpra_range *y, const arpra_range *x1, arpra_uint n);
 void arpra_reduce_small_abs (arpra_range *y, const arpra_range *x1, mpfr_srcptr abs_threshold);
 void arpra_reduce_small_rel (arpra_range *y, const arpra_range *x1, mpfr_srcptr rel_threshold);
+void arpra_reduce_to_k (arpra_range *y, const arpra_range *x1, arpra_uint k);
+void arpra_reduce_vector (arpra_range *y, const arpra_range *x, arpra_uint n, arpra_uint k);
+
+// Deviation symbol renumbering.
+void arpra_renumber_symbols (arpra_range **x, arpra_uint n);
 
 // Predicates on Arpra ranges.
 int arpra_nan_p (const arpra_range *x1);
@@ -157,6 +193,8 @@ arpra_prec arpra_get_default_precision ();
 void arpra_set_default_precision (arpra_prec prec);
 arpra_prec arpra_get_internal_precision ();
 void arpra_set_internal_precision (arpra_prec prec);
+arpra_uint arpra_get_max_terms ();
+void arpra_set_max_terms (arpra_uint n);
 
 // Clear temporary data.
 void arpra_clear_buffers ();
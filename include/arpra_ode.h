@@ -28,19 +28,77 @@
 typedef struct arpra_ode_system_struct arpra_ode_system;
 typedef struct arpra_ode_stepper_struct arpra_ode_stepper;
 typedef struct arpra_ode_method_struct arpra_ode_method;
+typedef struct arpra_ode_reduce_struct arpra_ode_reduce;
+typedef struct arpra_ode_coupling_struct arpra_ode_coupling;
+typedef struct arpra_ode_event_struct arpra_ode_event;
+typedef struct arpra_ode_observer_struct arpra_ode_observer;
 typedef void (*arpra_ode_f) (arpra_range *dxdt, const void *params,
                              const arpra_range *t, const arpra_range **x,
                              const arpra_uint x_grp, const arpra_uint x_dim);
+typedef void (*arpra_ode_f_grp) (arpra_range *dxdt, const void *params, arpra_range *temp,
+                                 const arpra_range *t, const arpra_range **x,
+                                 const arpra_uint x_grp, const arpra_uint x_dims);
+typedef void (*arpra_ode_jac) (arpra_range *dfdx, const void *params,
+                               const arpra_range *t, const arpra_range **x,
+                               const arpra_uint x_grp, const arpra_uint x_dim,
+                               const arpra_uint y_grp, const arpra_uint y_dim);
+typedef void (*arpra_ode_progress) (void *data, const arpra_uint member,
+                                    const arpra_uint step, const arpra_uint n_steps);
+typedef void (*arpra_ode_event_g) (arpra_range *g, const void *params,
+                                   const arpra_range *t, const arpra_range **x);
+typedef void (*arpra_ode_event_apply) (arpra_range **x, const void *params,
+                                       const arpra_range *t);
 
 // System definition.
 struct arpra_ode_system_struct
 {
     arpra_ode_f *f;
+    arpra_ode_f_grp *f_grp;
+    arpra_uint *f_grp_temps;
+    arpra_ode_jac *jac;
     void **params;
     arpra_range *t;
     arpra_range **x;
     arpra_uint grps;
     arpra_uint *dims;
+    arpra_ode_coupling *coupling;
+    arpra_uint n_coupling;
+    // Groups read by each group, or NULL to evaluate groups in order. If
+    // given, the callbacks of different groups may run concurrently.
+    arpra_uint **deps;
+    arpra_uint *n_deps;
+    arpra_ode_event *events;
+    arpra_uint n_events;
+    // Incremented by arpra_ode_system_precision_changed.
+    arpra_uint precision_generation;
+};
+
+// Event definition.
+struct arpra_ode_event_struct
+{
+    // An event occurs when g crosses zero in the given direction (1 rising,
+    // -1 falling, 0 both), after which apply updates the state (or NULL).
+    arpra_ode_event_g g;
+    arpra_ode_event_apply apply;
+    void *params;
+    int direction;
+    // Side of zero on which the range of g lies, or 0 while it contains
+    // zero and the event is disarmed, maintained by the stepper (init 0).
+    int sign;
+};
+
+// Sparse coupling definition, in compressed sparse row form.
+struct arpra_ode_coupling_struct
+{
+    // Row r sums weight[k] x[x_grp][col[k]] for row[r] <= k < row[r + 1].
+    arpra_uint x_grp;
+    arpra_uint rows;
+    const arpra_uint *row;
+    const arpra_uint *col;
+    // Weights, or NULL for unit weights.
+    const arpra_range *weight;
+    // Coupled sums, one per row, updated before each evaluation of f.
+    arpra_range *sum;
 };
 
 // Stepper definition.
@@ -48,7 +106,10 @@ struct arpra_ode_stepper_struct
 {
     const arpra_ode_method *method;
     arpra_ode_system *system;
-    arpra_range *error;
+    arpra_range **error;
+    arpra_ode_reduce *reduce;
+    arpra_range **temp;
+    struct arpra_ode_record_struct *record;
     void *scratch;
 };
 
@@ -58,9 +119,44 @@ struct arpra_ode_method_struct
     void (* const init) (arpra_ode_stepper *stepper, arpra_ode_system *system);
     void (* const clear) (arpra_ode_stepper *stepper);
     void (* const step) (arpra_ode_stepper *stepper, const arpra_range *h);
+    void (* const reject) (arpra_ode_stepper *stepper);
+    void (* const invalidate) (arpra_ode_stepper *stepper);
+    void (* const interpolate) (arpra_ode_stepper *stepper, arpra_range **x, const arpra_range *t);
+    int (* const save) (arpra_ode_stepper *stepper, FILE *stream);
+    int (* const load) (arpra_ode_stepper *stepper, FILE *stream, arpra_uint symbol_offset);
     const unsigned char stages;
+    const unsigned char order;
+    const unsigned char error_order;
+};
+
+// Deviation term reduction policy.
+struct arpra_ode_reduce_struct
+{
+    // Condense the terms created by each step into one term.
+    int step_terms;
+    // Condense terms smaller than rel_threshold * radius every interval steps.
+    mpfr_srcptr rel_threshold;
+    arpra_uint interval;
+    // Condense the smallest terms of variables with more than max_terms terms.
+    arpra_uint max_terms;
+    // Number of accepted steps, and number of terms condensed so far.
+    arpra_uint step_count;
+    arpra_uint condensed;
 };
 
+// Observer of a multi-step run.
+struct arpra_ode_observer_struct
+{
+    // Called with the system state every interval steps, and after the last step.
+    void (*observe) (void *data, const arpra_ode_system *system, const arpra_uint step);
+    void *data;
+    arpra_uint interval;
+};
+
+// Returned by arpra_ode_stepper_step_adaptive if no step size met the tolerance,
+// and by arpra_ode_stepper_step_multirate if the step ratios are invalid.
+#define ARPRA_ODE_STEP_FAILED ((arpra_uint) -1)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -70,6 +166,53 @@ void arpra_ode_stepper_init (arpra_ode_stepper *stepper, arpra_ode_system *syste
                              const arpra_ode_method *method);
 void arpra_ode_stepper_clear (arpra_ode_stepper *stepper);
 void arpra_ode_stepper_step (arpra_ode_stepper *stepper, const arpra_range *h);
+// Data a method carries between steps (a reused first stage, or a history of
+// past steps) is reused only while t and x are exactly as the last step left
+// them, after its reduction. Any other change to t or x discards it. Changes
+// to params, or to inputs read by f, are not detected: call invalidate.
+void arpra_ode_stepper_invalidate (arpra_ode_stepper *stepper);
+// Renumber the symbols of t, x, the coupling weights and sums, and the extra
+// ranges, such as h and ranges in params, then restart the stepper. Any other
+// range still in use must be passed in extra.
+void arpra_ode_stepper_renumber (arpra_ode_stepper *stepper, arpra_range **extra,
+                                 arpra_uint n_extra);
+void arpra_ode_stepper_set_reduce (arpra_ode_stepper *stepper, arpra_ode_reduce *reduce);
+// Dense output within the last step. Dopri54 uses its own 4th order polynomial.
+// Other Runge-Kutta methods, dopri87 included, use cubic Hermite interpolation
+// of the end points, which is only 3rd order. Other methods return the state.
+void arpra_ode_stepper_interpolate (arpra_ode_stepper *stepper, arpra_range **x,
+                                   const arpra_range *t);
+arpra_uint arpra_ode_stepper_step_adaptive (arpra_ode_stepper *stepper, arpra_range *h,
+                                           mpfr_srcptr tol_centre, mpfr_srcptr tol_radius);
+// Multi-rate step. The slow groups see the fast groups held at their values at
+// t, so the fast-to-slow coupling is only first order accurate.
+arpra_uint arpra_ode_stepper_step_multirate (arpra_ode_stepper *stepper, const arpra_range *h,
+                                             const arpra_uint *ratio);
+arpra_uint arpra_ode_stepper_step_events (arpra_ode_stepper *stepper, const arpra_range *h);
+void arpra_ode_stepper_run (arpra_ode_stepper *stepper, const arpra_range *h, arpra_uint n_steps,
+                            const arpra_ode_observer *observer, arpra_ode_reduce *reduce);
+
+// System functions.
+void arpra_ode_system_init (arpra_ode_system *system, arpra_ode_f *f, void **params,
+                            arpra_range *t, arpra_range **x, arpra_uint grps, arpra_uint *dims);
+void arpra_ode_system_precision_changed (arpra_ode_system *system);
+
+// Ensemble functions.
+void arpra_ode_ensemble_run (arpra_ode_system *systems, arpra_uint n_systems,
+                             const arpra_ode_method *method, const arpra_range *h,
+                             arpra_uint n_steps, const arpra_ode_reduce *reduce,
+                             arpra_ode_progress progress, void *data);
+
+// Checkpoint functions. Loading changes the system only if the whole file is
+// read, and restores the saved Arpra configuration only if restore_config.
+int arpra_ode_checkpoint_save (const char *path, arpra_ode_stepper *stepper);
+int arpra_ode_checkpoint_load (const char *path, arpra_ode_stepper *stepper, int restore_config);
+
+// Clear cached step method constants.
+void arpra_ode_clear_tableaus ();
+
+// Sparse coupling functions.
+void arpra_ode_coupling_sum (arpra_ode_coupling *coupling, const arpra_range **x);
 
 // Arpra built-in step methods.
 extern const arpra_ode_method *arpra_ode_euler;
@@ -77,6 +220,15 @@ extern const arpra_ode_method *arpra_ode_trapezoidal;
 extern const arpra_ode_method *arpra_ode_bogsham32;
 extern const arpra_ode_method *arpra_ode_dopri54;
 extern const arpra_ode_method *arpra_ode_dopri87;
+extern const arpra_ode_method *arpra_ode_ab2;
+extern const arpra_ode_method *arpra_ode_ab3;
+extern const arpra_ode_method *arpra_ode_ab4;
+extern const arpra_ode_method *arpra_ode_ab5;
+extern const arpra_ode_method *arpra_ode_abm2;
+extern const arpra_ode_method *arpra_ode_abm3;
+extern const arpra_ode_method *arpra_ode_abm4;
+extern const arpra_ode_method *arpra_ode_abm5;
+extern const arpra_ode_method *arpra_ode_ros2;
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,355 @@
+/*
+ * accumulator.c -- Streaming accumulation of Arpra ranges.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * An accumulator buffers the deviation terms of each contribution as a
+ * sorted run, without creating a new error symbol. Runs are kept on a stack
+ * whose contribution counts decrease from bottom to top, and the top two
+ * runs are merged whenever the one below is no larger than the one on top.
+ * As with a binary counter, each term takes part in O(log n) merges, and
+ * the stack never holds more than O(log n) runs. All rounding error is
+ * collected in a single new deviation term when the accumulator is
+ * finalised.
+ */
+
+static void accumulator_merge (arpra_accumulator *acc)
+{
+    struct arpra_accumulator_run_struct *x1, *x2, yy;
+    arpra_uint i_y, i_x1, i_x2;
+
+    x1 = &(acc->runs[acc->nRuns - 2]);
+    x2 = &(acc->runs[acc->nRuns - 1]);
+    yy.symbols = malloc((x1->nTerms + x2->nTerms) * sizeof(arpra_uint));
+    yy.deviations = malloc((x1->nTerms + x2->nTerms) * sizeof(mpfr_t));
+
+    for (i_y = 0, i_x1 = 0, i_x2 = 0; (i_x1 < x1->nTerms) || (i_x2 < x2->nTerms); i_y++) {
+        if ((i_x2 == x2->nTerms) || ((i_x1 < x1->nTerms) && (x1->symbols[i_x1] < x2->symbols[i_x2]))) {
+            // y[i] = x1[i]
+            yy.symbols[i_y] = x1->symbols[i_x1];
+            yy.deviations[i_y] = x1->deviations[i_x1];
+            i_x1++;
+        }
+        else if ((i_x1 == x1->nTerms) || ((i_x2 < x2->nTerms) && (x2->symbols[i_x2] < x1->symbols[i_x1]))) {
+            // y[i] = x2[i]
+            yy.symbols[i_y] = x2->symbols[i_x2];
+            yy.deviations[i_y] = x2->deviations[i_x2];
+            i_x2++;
+        }
+        else {
+            // y[i] = x1[i] + x2[i]
+            yy.symbols[i_y] = x1->symbols[i_x1];
+            yy.deviations[i_y] = x1->deviations[i_x1];
+            ARPRA_MPFR_RNDERR_ADD(&(acc->error), MPFR_RNDN, &(yy.deviations[i_y]),
+                                  &(yy.deviations[i_y]), &(x2->deviations[i_x2]));
+            mpfr_clear(&(x2->deviations[i_x2]));
+            i_x1++;
+            i_x2++;
+        }
+    }
+    yy.nTerms = i_y;
+    yy.nAdds = x1->nAdds + x2->nAdds;
+
+    // Replace the top two runs with the merged run.
+    free(x1->symbols);
+    free(x1->deviations);
+    free(x2->symbols);
+    free(x2->deviations);
+    acc->nRuns--;
+    acc->runs[acc->nRuns - 1] = yy;
+}
+
+static struct arpra_accumulator_run_struct *accumulator_push (arpra_accumulator *acc, arpra_uint n)
+{
+    struct arpra_accumulator_run_struct *run;
+
+    // Make room for a new run.
+    if (acc->nRuns == acc->nAlloc) {
+        acc->nAlloc = (acc->nAlloc == 0) ? 8 : (acc->nAlloc * 2);
+        acc->runs = realloc(acc->runs, acc->nAlloc * sizeof(struct arpra_accumulator_run_struct));
+    }
+
+    run = &(acc->runs[acc->nRuns++]);
+    run->symbols = malloc(n * sizeof(arpra_uint));
+    run->deviations = malloc(n * sizeof(mpfr_t));
+    run->nTerms = n;
+    run->nAdds = 1;
+    return run;
+}
+
+static void accumulator_settle (arpra_accumulator *acc)
+{
+    while ((acc->nRuns >= 2) && (acc->runs[acc->nRuns - 2].nAdds <= acc->runs[acc->nRuns - 1].nAdds)) {
+        accumulator_merge(acc);
+    }
+}
+
+static void accumulator_reset (arpra_accumulator *acc)
+{
+    arpra_uint i, i_x;
+
+    for (i = 0; i < acc->nRuns; i++) {
+        for (i_x = 0; i_x < acc->runs[i].nTerms; i_x++) {
+            mpfr_clear(&(acc->runs[i].deviations[i_x]));
+        }
+        free(acc->runs[i].symbols);
+        free(acc->runs[i].deviations);
+    }
+    acc->nRuns = 0;
+    acc->nInf = 0;
+    acc->nan = 0;
+    mpfr_set_zero(&(acc->centre), 1);
+    mpfr_set_zero(&(acc->error), 1);
+    mpfi_set_si(&(acc->true_range), 0);
+}
+
+void arpra_accumulator_init (arpra_accumulator *acc, arpra_prec prec)
+{
+    arpra_prec prec_internal;
+
+    prec_internal = arpra_get_internal_precision();
+    acc->precision = prec;
+    mpfr_init2(&(acc->centre), prec_internal);
+    mpfr_init2(&(acc->error), prec_internal);
+    mpfi_init2(&(acc->true_range), prec);
+    acc->runs = NULL;
+    acc->nRuns = 0;
+    acc->nAlloc = 0;
+    accumulator_reset(acc);
+}
+
+void arpra_accumulator_clear (arpra_accumulator *acc)
+{
+    accumulator_reset(acc);
+    mpfr_clear(&(acc->centre));
+    mpfr_clear(&(acc->error));
+    mpfi_clear(&(acc->true_range));
+    free(acc->runs);
+}
+
+void arpra_accumulator_add (arpra_accumulator *acc, const arpra_range *x1)
+{
+    struct arpra_accumulator_run_struct *run;
+    arpra_prec prec_internal;
+    arpra_uint i_x1;
+
+    // Handle domain violations.
+    if (arpra_nan_p(x1)) {
+        acc->nan = 1;
+        return;
+    }
+    if (arpra_inf_p(x1)) {
+        acc->nInf++;
+        return;
+    }
+
+    // MPFI addition
+    mpfi_add(&(acc->true_range), &(acc->true_range), &(x1->true_range));
+
+    // y[0] = y[0] + x1[0]
+    ARPRA_MPFR_RNDERR_ADD(&(acc->error), MPFR_RNDN, &(acc->centre), &(acc->centre), &(x1->centre));
+
+    // y[i] = x1[i]
+    prec_internal = arpra_get_internal_precision();
+    run = accumulator_push(acc, x1->nTerms);
+    for (i_x1 = 0; i_x1 < x1->nTerms; i_x1++) {
+        mpfr_init2(&(run->deviations[i_x1]), prec_internal);
+        run->symbols[i_x1] = x1->symbols[i_x1];
+        ARPRA_MPFR_RNDERR_SET(&(acc->error), MPFR_RNDN, &(run->deviations[i_x1]), &(x1->deviations[i_x1]));
+    }
+
+    accumulator_settle(acc);
+}
+
+void arpra_accumulator_add_scaled (arpra_accumulator *acc, const arpra_range *x1, mpfr_srcptr alpha)
+{
+    struct arpra_accumulator_run_struct *run;
+    mpfi_t ia_temp;
+    arpra_prec prec_internal;
+    arpra_uint i_x1;
+
+    // Handle domain violations.
+    if (arpra_nan_p(x1) || mpfr_nan_p(alpha)) {
+        acc->nan = 1;
+        return;
+    }
+    if (arpra_inf_p(x1) || mpfr_inf_p(alpha)) {
+        acc->nInf++;
+        return;
+    }
+
+    // MPFI scaled addition
+    mpfi_init2(ia_temp, acc->precision);
+    mpfi_mul_fr(ia_temp, &(x1->true_range), alpha);
+    mpfi_add(&(acc->true_range), &(acc->true_range), ia_temp);
+    mpfi_clear(ia_temp);
+
+    // y[0] = y[0] + (alpha * x1[0])
+    ARPRA_MPFR_RNDERR_FMA(&(acc->error), MPFR_RNDN, &(acc->centre), &(x1->centre), alpha, &(acc->centre));
+
+    // y[i] = (alpha * x1[i])
+    prec_internal = arpra_get_internal_precision();
+    run = accumulator_push(acc, x1->nTerms);
+    for (i_x1 = 0; i_x1 < x1->nTerms; i_x1++) {
+        mpfr_init2(&(run->deviations[i_x1]), prec_internal);
+        run->symbols[i_x1] = x1->symbols[i_x1];
+        ARPRA_MPFR_RNDERR_MUL(&(acc->error), MPFR_RNDN, &(run->deviations[i_x1]), &(x1->deviations[i_x1]), alpha);
+    }
+
+    accumulator_settle(acc);
+}
+
+/*
+ * The product is linearised about the centres of x1 and x2, as in
+ * arpra_mul, and the nonlinear remainder is bounded using the current
+ * multiplication method.
+ */
+
+void arpra_accumulator_add_product (arpra_accumulator *acc, const arpra_range *x1, const arpra_range *x2)
+{
+    struct arpra_accumulator_run_struct *run;
+    mpfi_t ia_temp;
+    arpra_prec prec_internal;
+    arpra_uint i_y, i_x1, i_x2;
+
+    // Handle domain violations.
+    if (arpra_nan_p(x1) || arpra_nan_p(x2)) {
+        acc->nan = 1;
+        return;
+    }
+    if (arpra_inf_p(x1) || arpra_inf_p(x2)) {
+        acc->nInf++;
+        return;
+    }
+
+    // MPFI multiplication
+    mpfi_init2(ia_temp, acc->precision);
+    mpfi_mul(ia_temp, &(x1->true_range), &(x2->true_range));
+    mpfi_add(&(acc->true_range), &(acc->true_range), ia_temp);
+    mpfi_clear(ia_temp);
+
+    // y[0] = y[0] + (x1[0] * x2[0])
+    ARPRA_MPFR_RNDERR_FMA(&(acc->error), MPFR_RNDN, &(acc->centre), &(x1->centre), &(x2->centre), &(acc->centre));
+
+    prec_internal = arpra_get_internal_precision();
+    run = accumulator_push(acc, x1->nTerms + x2->nTerms);
+    for (i_y = 0, i_x1 = 0, i_x2 = 0; (i_x1 < x1->nTerms) || (i_x2 < x2->nTerms); i_y++) {
+        mpfr_init2(&(run->deviations[i_y]), prec_internal);
+
+        if ((i_x2 == x2->nTerms) || ((i_x1 < x1->nTerms) && (x1->symbols[i_x1] < x2->symbols[i_x2]))) {
+            // y[i] = (x2[0] * x1[i])
+            run->symbols[i_y] = x1->symbols[i_x1];
+            ARPRA_MPFR_RNDERR_MUL(&(acc->error), MPFR_RNDN, &(run->deviations[i_y]),
+                                  &(x2->centre), &(x1->deviations[i_x1]));
+            i_x1++;
+        }
+        else if ((i_x1 == x1->nTerms) || ((i_x2 < x2->nTerms) && (x2->symbols[i_x2] < x1->symbols[i_x1]))) {
+            // y[i] = (x1[0] * x2[i])
+            run->symbols[i_y] = x2->symbols[i_x2];
+            ARPRA_MPFR_RNDERR_MUL(&(acc->error), MPFR_RNDN, &(run->deviations[i_y]),
+                                  &(x1->centre), &(x2->deviations[i_x2]));
+            i_x2++;
+        }
+        else {
+            // y[i] = (x2[0] * x1[i]) + (x1[0] * x2[i])
+            run->symbols[i_y] = x1->symbols[i_x1];
+            ARPRA_MPFR_RNDERR_FMMA(&(acc->error), MPFR_RNDN, &(run->deviations[i_y]),
+                                   &(x2->centre), &(x1->deviations[i_x1]),
+                                   &(x1->centre), &(x2->deviations[i_x2]));
+            i_x1++;
+            i_x2++;
+        }
+    }
+    run->nTerms = i_y;
+
+    // Add the nonlinear remainder to error.
+    arpra_helper_mul_error(&(acc->error), x1, x2);
+
+    accumulator_settle(acc);
+}
+
+void arpra_accumulator_finalise (arpra_range *y, arpra_accumulator *acc)
+{
+    struct arpra_accumulator_run_struct *run;
+    arpra_range yy;
+    arpra_prec prec_internal;
+    arpra_uint i_y;
+
+    // Handle domain violations.
+    if (acc->nan || (acc->nInf > 1)) {
+        arpra_set_nan(y);
+        accumulator_reset(acc);
+        return;
+    }
+    if (acc->nInf == 1) {
+        arpra_set_inf(y);
+        accumulator_reset(acc);
+        return;
+    }
+
+    // Merge all remaining runs.
+    while (acc->nRuns >= 2) {
+        accumulator_merge(acc);
+    }
+
+    // Initialise vars.
+    prec_internal = arpra_get_internal_precision();
+    arpra_init2(&yy, y->precision);
+
+    // y[0] = y[0]
+    ARPRA_MPFR_RNDERR_SET(&(acc->error), MPFR_RNDN, &(yy.centre), &(acc->centre));
+
+    // Take deviation terms from the merged run.
+    if (acc->nRuns == 1) {
+        run = &(acc->runs[0]);
+        yy.symbols = realloc(run->symbols, (run->nTerms + 1) * sizeof(arpra_uint));
+        yy.deviations = realloc(run->deviations, (run->nTerms + 1) * sizeof(mpfr_t));
+        yy.nTerms = run->nTerms;
+        acc->nRuns = 0;
+    }
+    else {
+        yy.symbols = malloc(sizeof(arpra_uint));
+        yy.deviations = malloc(sizeof(mpfr_t));
+        yy.nTerms = 0;
+    }
+
+    // Store new deviation term.
+    i_y = yy.nTerms;
+    yy.symbols[i_y] = arpra_helper_next_symbol();
+    yy.deviations[i_y] = acc->error;
+    yy.nTerms = i_y + 1;
+    mpfr_init2(&(acc->error), prec_internal);
+
+    // Compute true_range.
+    arpra_helper_compute_range(&yy);
+
+    // Mix with IA range, and trim error term.
+    arpra_helper_mix_trim(&yy, &(acc->true_range));
+
+    // Check for NaN and Inf.
+    arpra_helper_check_result(&yy);
+
+    // Set y, and reset the accumulator.
+    arpra_clear(y);
+    *y = yy;
+    accumulator_reset(acc);
+}
@@ -28,6 +28,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include <math.h>
 
@@ -44,12 +45,77 @@
 #define ARPRA_DEFAULT_PRECISION 53
 #define ARPRA_DEFAULT_INTERNAL_PRECISION 256
 
+// Default maximum number of deviation terms (0 is unlimited).
+#define ARPRA_DEFAULT_MAX_TERMS 0
+
 // Min-Range approximation.
 //#define ARPRA_MIN_RANGE 1
 
+// Dense summation is used if the symbol span is below this many times the
+// number of summed deviation terms.
+#define ARPRA_DENSE_SPAN_FACTOR 4
+
 // Temp buffers.
 #define ARPRA_BUFFER_RESIZE_FACTOR 256
 
+// Adaptive step size control.
+#define ARPRA_ODE_SAFETY_FACTOR 0.9
+#define ARPRA_ODE_MIN_FACTOR 0.2
+#define ARPRA_ODE_MAX_FACTOR 5.0
+#define ARPRA_ODE_MAX_REJECT 64
+
+// Event localisation.
+#define ARPRA_ODE_EVENT_BISECTIONS 32
+
+// Steps for which a Rosenbrock stepper may reuse its factorised Jacobian.
+#define ARPRA_ODE_JACOBIAN_MAX_AGE 16
+
+// Sorted run of deviation terms, buffered by an accumulator.
+struct arpra_accumulator_run_struct
+{
+    arpra_uint *symbols;
+    __mpfr_struct *deviations;
+    arpra_uint nTerms;
+    arpra_uint nAdds;
+};
+
+// Explicit Runge-Kutta method, with each coefficient an exact fraction
+// {numerator, denominator}. The matrix a is stored as its strictly lower
+// triangle, row by row.
+typedef struct arpra_ode_erk_struct arpra_ode_erk;
+struct arpra_ode_erk_struct
+{
+    arpra_uint stages;
+    const double (*a)[2];
+    const double (*b)[2];
+    // Embedded weights for the error estimate, or NULL.
+    const double (*b_err)[2];
+    const double (*c)[2];
+    // Dense output polynomial, 4 coefficients per stage, or NULL for Hermite.
+    const double (*d)[2];
+    // Whether the last stage is f(t + h, x(t + h)). Methods of other tableaus
+    // carry nothing between steps, and leave invalidate NULL.
+    int fsal;
+};
+
+// Copy of the system state after the last accepted step.
+typedef struct arpra_ode_record_struct arpra_ode_record;
+struct arpra_ode_record_struct
+{
+    arpra_range t;
+    arpra_range *x;
+    arpra_uint size;
+    int valid;
+};
+
+// Precisions that a stepper's scratch memory was last synchronised with.
+typedef struct arpra_ode_sync_struct arpra_ode_sync;
+struct arpra_ode_sync_struct
+{
+    arpra_uint generation;
+    arpra_prec prec_internal;
+};
+
 // Internal auxiliary functions.
 
 
@@ -62,6 +128,8 @@ void arpra_helper_affine_2 (arpra_range *y, const arpra_range *x1, const arpra_r
 
 void arpra_helper_term_mul (mpfr_ptr error, mpfr_ptr y, mpfr_srcptr x1,
                             mpfi_srcptr alpha);
+void arpra_helper_term_mul_n (mpfr_ptr error, mpfr_ptr y, mpfr_srcptr x1, arpra_uint n,
+                              mpfi_srcptr alpha);
 void arpra_helper_term_fma (mpfr_ptr error, mpfr_ptr y, mpfr_srcptr x1,
                             mpfi_srcptr alpha, mpfi_srcptr gamma);
 void arpra_helper_term_fmma (mpfr_ptr error, mpfr_ptr y, mpfr_srcptr x1, mpfr_srcptr x2,
@@ -71,16 +139,59 @@ void arpra_helper_term_fmmaa (mpfr_ptr error, mpfr_ptr y, mpfr_srcptr x1, mpfr_s
 
 
 
+void arpra_helper_mul_error (mpfr_ptr error, const arpra_range *x1, const arpra_range *x2);
 void arpra_helper_mpfr_rnderr (mpfr_ptr err, mpfr_rnd_t rnd, mpfr_srcptr y);
 void arpra_helper_compute_range (arpra_range *y);
+void arpra_helper_condense (arpra_range *y, arpra_uint k);
+void arpra_helper_sum_terms (arpra_range *y, mpfr_ptr error, const arpra_range *x, arpra_uint n);
+void arpra_helper_select_abs (mpfr_ptr *x, arpra_uint n, arpra_uint k);
+arpra_uint arpra_helper_gallop (const arpra_uint *symbols, arpra_uint lo, arpra_uint hi, arpra_uint symbol);
 void arpra_helper_mix_trim (arpra_range *y, mpfi_srcptr ia_range);
 void arpra_helper_check_result (arpra_range *y);
 void arpra_helper_set_symbol_count (arpra_uint n);
 arpra_uint arpra_helper_get_symbol_count ();
 arpra_uint arpra_helper_next_symbol ();
+void arpra_helper_reserve_symbols ();
+arpra_uint arpra_helper_get_symbol_floor ();
+int arpra_helper_fpif_export_uint (FILE *stream, arpra_uint x);
+int arpra_helper_fpif_import_uint (arpra_uint *y, FILE *stream);
+int arpra_helper_fpif_import_shift (arpra_range *y, FILE *stream, arpra_uint symbol_offset);
 mpfr_ptr *arpra_helper_buffer_mpfr_ptr (arpra_uint n);
 mpfr_ptr arpra_helper_buffer_mpfr (arpra_uint n);
 void arpra_helper_clear_terms (arpra_range *y);
+void arpra_helper_ode_reduce (arpra_ode_stepper *stepper, arpra_uint symbol_start);
+void arpra_helper_ode_couple (arpra_ode_system *system, const arpra_range **x);
+void arpra_helper_ode_copy_exact (arpra_range *y, const arpra_range *x1);
+int arpra_helper_ode_equal_exact_p (const arpra_range *x1, const arpra_range *x2);
+arpra_ode_record *arpra_helper_ode_record_init (const arpra_ode_system *system);
+void arpra_helper_ode_record_clear (arpra_ode_record *record);
+void arpra_helper_ode_record_set (arpra_ode_record *record, const arpra_ode_system *system);
+int arpra_helper_ode_record_equal_p (const arpra_ode_record *record, const arpra_ode_system *system);
+void arpra_helper_ode_sync_init (arpra_ode_sync *sync);
+int arpra_helper_ode_sync_stale (arpra_ode_sync *sync, const arpra_ode_system *system);
+void arpra_helper_ode_eval (arpra_ode_stepper *stepper, arpra_range **dxdt,
+                            const arpra_range *t, const arpra_range **x);
+void arpra_helper_ode_eval_grp (arpra_ode_stepper *stepper, arpra_range *dxdt,
+                                const arpra_range *t, const arpra_range **x, arpra_uint x_grp);
+const void *arpra_helper_ode_tableau (const void *key, arpra_prec prec,
+                                      void *(*build) (const void *key, arpra_prec prec),
+                                      void (*clear) (void *tableau));
+void arpra_helper_ode_combine (arpra_range *y, const arpra_range *x, arpra_range ***k,
+                               const arpra_range *w, arpra_uint n,
+                               arpra_uint x_grp, arpra_uint x_dim);
+void arpra_helper_ode_stages (arpra_ode_stepper *stepper, arpra_range ***k, arpra_range **x_out,
+                              arpra_range **ah, const arpra_range *t_stage,
+                              arpra_uint stages, arpra_uint first);
+void arpra_helper_ode_erk_init (arpra_ode_stepper *stepper, arpra_ode_system *system,
+                                const arpra_ode_method *method, const arpra_ode_erk *erk);
+void arpra_helper_ode_erk_clear (arpra_ode_stepper *stepper);
+void arpra_helper_ode_erk_step (arpra_ode_stepper *stepper, const arpra_range *h);
+void arpra_helper_ode_erk_reject (arpra_ode_stepper *stepper);
+void arpra_helper_ode_erk_invalidate (arpra_ode_stepper *stepper);
+void arpra_helper_ode_erk_interpolate (arpra_ode_stepper *stepper, arpra_range **x,
+                                       const arpra_range *t);
+int arpra_helper_ode_erk_save (arpra_ode_stepper *stepper, FILE *stream);
+int arpra_helper_ode_erk_load (arpra_ode_stepper *stepper, FILE *stream, arpra_uint symbol_offset);
 
 // Arpra extensions to the MPFR library.
 int arpra_ext_mpfr_fmma (mpfr_ptr y, mpfr_srcptr x1, mpfr_srcptr x2,
@@ -0,0 +1,139 @@
+/*
+ * fpif.c -- Binary import and export of Arpra ranges.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * Ranges are written as their precision, the MPFR binary format of their
+ * centre, radius and true range bounds, and their deviation terms. Integers
+ * are written as 8 bytes, least significant first, so that files can be
+ * read on any platform supported by MPFR.
+ */
+
+int arpra_helper_fpif_export_uint (FILE *stream, arpra_uint x)
+{
+    unsigned char buf[8];
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        buf[i] = (unsigned char) (x & 0xFF);
+        x >>= 8;
+    }
+
+    return (fwrite(buf, 1, 8, stream) == 8) ? 0 : 1;
+}
+
+int arpra_helper_fpif_import_uint (arpra_uint *y, FILE *stream)
+{
+    unsigned char buf[8];
+    int i;
+
+    if (fread(buf, 1, 8, stream) != 8) return 1;
+    for (i = 7, *y = 0; i >= 0; i--) {
+        *y = (*y << 8) | buf[i];
+    }
+
+    return 0;
+}
+
+int arpra_fpif_export (FILE *stream, const arpra_range *x)
+{
+    arpra_uint i;
+
+    if (arpra_helper_fpif_export_uint(stream, x->precision)) return 1;
+    if (mpfr_fpif_export(stream, (mpfr_ptr) &(x->centre))) return 1;
+    if (mpfr_fpif_export(stream, (mpfr_ptr) &(x->radius))) return 1;
+    if (mpfr_fpif_export(stream, (mpfr_ptr) &(x->true_range.left))) return 1;
+    if (mpfr_fpif_export(stream, (mpfr_ptr) &(x->true_range.right))) return 1;
+    if (arpra_helper_fpif_export_uint(stream, x->nTerms)) return 1;
+    for (i = 0; i < x->nTerms; i++) {
+        if (arpra_helper_fpif_export_uint(stream, x->symbols[i])) return 1;
+        if (mpfr_fpif_export(stream, &(x->deviations[i]))) return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Ranges are read into a temporary, and y is only set if the whole range
+ * was read. Symbols are kept as they were saved, shifted by symbol_offset,
+ * so ranges exported together stay correlated when imported together. The
+ * symbol counter is advanced past them, so that later operations do not
+ * reuse their symbols.
+ */
+
+static int fpif_import (arpra_range *y, FILE *stream, arpra_uint symbol_offset)
+{
+    arpra_range yy;
+    arpra_uint prec, n, i;
+    int error;
+
+    // The precision of each MPFR number is read with it.
+    if (arpra_helper_fpif_import_uint(&prec, stream)) return 1;
+    arpra_init2(&yy, (arpra_prec) prec);
+    error = mpfr_fpif_import(&(yy.centre), stream)
+        || mpfr_fpif_import(&(yy.radius), stream)
+        || mpfr_fpif_import(&(yy.true_range.left), stream)
+        || mpfr_fpif_import(&(yy.true_range.right), stream)
+        || arpra_helper_fpif_import_uint(&n, stream);
+
+    if (!error && (n > 0)) {
+        yy.symbols = malloc(n * sizeof(arpra_uint));
+        yy.deviations = malloc(n * sizeof(mpfr_t));
+        for (i = 0; i < n; i++) {
+            mpfr_init2(&(yy.deviations[i]), arpra_get_internal_precision());
+        }
+        yy.nTerms = n;
+        for (i = 0; !error && (i < n); i++) {
+            error = arpra_helper_fpif_import_uint(&(yy.symbols[i]), stream)
+                || mpfr_fpif_import(&(yy.deviations[i]), stream);
+            yy.symbols[i] += symbol_offset;
+
+            // Terms must be sorted by symbol.
+            if ((i > 0) && (yy.symbols[i] <= yy.symbols[i - 1])) error = 1;
+        }
+    }
+
+    if (error) {
+        arpra_clear(&yy);
+        return 1;
+    }
+
+    // Advance the symbol counter past the imported symbols.
+    if ((yy.nTerms > 0) && (yy.symbols[yy.nTerms - 1] >= arpra_helper_get_symbol_count())) {
+        arpra_helper_set_symbol_count(yy.symbols[yy.nTerms - 1] + 1);
+    }
+
+    arpra_clear(y);
+    *y = yy;
+    return 0;
+}
+
+int arpra_fpif_import (arpra_range *y, FILE *stream)
+{
+    return fpif_import(y, stream, 0);
+}
+
+int arpra_helper_fpif_import_shift (arpra_range *y, FILE *stream, arpra_uint symbol_offset)
+{
+    // Shifting every symbol keeps the terms sorted.
+    return fpif_import(y, stream, symbol_offset);
+}
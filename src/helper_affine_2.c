@@ -27,7 +27,7 @@ void arpra_helper_affine_2 (arpra_range *y, const arpra_range *x1, const arpra_r
     mpfr_t temp, error;
     arpra_range yy;
     arpra_prec prec_internal;
-    arpra_uint i_y, i_x1, i_x2;
+    arpra_uint i, n, i_y, i_x1, i_x2;
 
     // Initialise vars.
     prec_internal = arpra_get_internal_precision();
@@ -43,25 +43,43 @@ void arpra_helper_affine_2 (arpra_range *y, const arpra_range *x1, const arpra_r
     yy.symbols = malloc((x1->nTerms + x2->nTerms + 1) * sizeof(arpra_uint));
     yy.deviations = malloc((x1->nTerms + x2->nTerms + 1) * sizeof(mpfr_t));
 
-    for (i_y = 0, i_x1 = 0, i_x2 = 0; (i_x1 < x1->nTerms) || (i_x2 < x2->nTerms); i_y++) {
-        mpfr_init2(&(yy.deviations[i_y]), prec_internal);
-
+    i_y = 0;
+    i_x1 = 0;
+    i_x2 = 0;
+    while ((i_x1 < x1->nTerms) || (i_x2 < x2->nTerms)) {
         if ((i_x2 == x2->nTerms) || ((i_x1 < x1->nTerms) && (x1->symbols[i_x1] < x2->symbols[i_x2]))) {
+            // Gallop over the run of symbols only in x1.
+            n = (i_x2 == x2->nTerms) ? x1->nTerms : arpra_helper_gallop(x1->symbols, i_x1, x1->nTerms, x2->symbols[i_x2]);
+            for (i = 0; i < (n - i_x1); i++) {
+                mpfr_init2(&(yy.deviations[i_y + i]), prec_internal);
+                yy.symbols[i_y + i] = x1->symbols[i_x1 + i];
+            }
+
             // y[i] = (alpha * x1[i])
-            yy.symbols[i_y] = x1->symbols[i_x1];
-            arpra_helper_term_mul(error, &(yy.deviations[i_y]), &(x1->deviations[i_x1]), alpha);
-            i_x1++;
+            arpra_helper_term_mul_n(error, &(yy.deviations[i_y]), &(x1->deviations[i_x1]), (n - i_x1), alpha);
+            i_y += n - i_x1;
+            i_x1 = n;
         }
         else if ((i_x1 == x1->nTerms) || ((i_x2 < x2->nTerms) && (x2->symbols[i_x2] < x1->symbols[i_x1]))) {
+            // Gallop over the run of symbols only in x2.
+            n = (i_x1 == x1->nTerms) ? x2->nTerms : arpra_helper_gallop(x2->symbols, i_x2, x2->nTerms, x1->symbols[i_x1]);
+            for (i = 0; i < (n - i_x2); i++) {
+                mpfr_init2(&(yy.deviations[i_y + i]), prec_internal);
+                yy.symbols[i_y + i] = x2->symbols[i_x2 + i];
+            }
+
             // y[i] = (beta * x2[i])
-            yy.symbols[i_y] = x2->symbols[i_x2];
-            arpra_helper_term_mul(error, &(yy.deviations[i_y]), &(x2->deviations[i_x2]), beta);
-            i_x2++;
+            arpra_helper_term_mul_n(error, &(yy.deviations[i_y]), &(x2->deviations[i_x2]), (n - i_x2), beta);
+            i_y += n - i_x2;
+            i_x2 = n;
         }
         else {
+            mpfr_init2(&(yy.deviations[i_y]), prec_internal);
+
             // y[i] = (alpha * x1[i]) + (beta * x2[i])
             yy.symbols[i_y] = x1->symbols[i_x1];
             arpra_helper_term_fmma(error, &(yy.deviations[i_y]), &(x1->deviations[i_x1]), &(x2->deviations[i_x2]), alpha, beta);
+            i_y++;
             i_x1++;
             i_x2++;
         }
@@ -24,6 +24,7 @@
 // MPFR pointer buffer.
 static mpfr_ptr *buffer_mpfr_ptr = NULL;
 static arpra_uint buffer_mpfr_ptr_size = 0;
+#pragma omp threadprivate(buffer_mpfr_ptr, buffer_mpfr_ptr_size)
 
 mpfr_ptr *arpra_helper_buffer_mpfr_ptr (arpra_uint n)
 {
@@ -40,6 +41,7 @@ mpfr_ptr *arpra_helper_buffer_mpfr_ptr (arpra_uint n)
 // MPFR buffer.
 static mpfr_ptr buffer_mpfr = NULL;
 static arpra_uint buffer_mpfr_size = 0;
+#pragma omp threadprivate(buffer_mpfr, buffer_mpfr_size)
 
 mpfr_ptr arpra_helper_buffer_mpfr (arpra_uint n)
 {
@@ -53,15 +55,27 @@ mpfr_ptr arpra_helper_buffer_mpfr (arpra_uint n)
     return buffer_mpfr;
 }
 
+/*
+ * The buffers are threadprivate, so each thread of a parallel region frees
+ * its own. The library's parallel regions all use the default team, whose
+ * threads keep their threadprivate data between regions, so clearing in a
+ * default team reaches every buffer that the library allocated. Threads of
+ * user parallel regions with other team sizes can free their own buffers by
+ * calling this from within the region, where the nested region is inactive.
+ */
+
 void arpra_clear_buffers ()
 {
-    // Free MPFR pointer buffer.
-    free(buffer_mpfr_ptr);
-    buffer_mpfr_ptr = NULL;
-    buffer_mpfr_ptr_size = 0;
+    #pragma omp parallel
+    {
+        // Free MPFR pointer buffer.
+        free(buffer_mpfr_ptr);
+        buffer_mpfr_ptr = NULL;
+        buffer_mpfr_ptr_size = 0;
 
-    // Free MPFR buffer.
-    free(buffer_mpfr);
-    buffer_mpfr = NULL;
-    buffer_mpfr_size = 0;
+        // Free MPFR buffer.
+        free(buffer_mpfr);
+        buffer_mpfr = NULL;
+        buffer_mpfr_size = 0;
+    }
 }
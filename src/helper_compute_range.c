@@ -23,7 +23,8 @@
 
 /*
  * Compute radius and true_range, adding rounding error to the new
- * numerical error deviation term.
+ * numerical error deviation term. If y has more terms than the global
+ * maximum, the smallest terms are first merged into the new term.
  */
 
 void arpra_helper_compute_range (arpra_range *y)
@@ -31,7 +32,13 @@ void arpra_helper_compute_range (arpra_range *y)
     mpfr_t temp1, temp2;
     mpfr_ptr sum_y, *sum_y_ptr;
     arpra_prec prec_internal;
-    arpra_uint i_y;
+    arpra_uint i_y, max_terms;
+
+    // Enforce the maximum number of terms.
+    max_terms = arpra_get_max_terms();
+    if ((max_terms > 0) && (y->nTerms > max_terms)) {
+        arpra_helper_condense(y, max_terms - 1);
+    }
 
     // Initialise vars.
     prec_internal = arpra_get_internal_precision();
@@ -0,0 +1,91 @@
+/*
+ * helper_condense.c -- Condense the smallest deviation terms of a range.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * Keep the k largest deviation terms of y, not counting the last term,
+ * and merge the others into the last (new numerical error) term. The
+ * order of the remaining symbols is preserved.
+ */
+
+void arpra_helper_condense (arpra_range *y, arpra_uint k)
+{
+    mpfr_t error;
+    mpfr_ptr sum_y, *sum_y_ptr, *dev_ptr;
+    arpra_uint i_y, i_x, n, n_merge;
+    char *merge;
+
+    // Handle trivial cases.
+    if (y->nTerms <= k + 1) return;
+
+    // Initialise vars.
+    n = y->nTerms - 1;
+    n_merge = n - k;
+    mpfr_init2(error, arpra_get_internal_precision());
+    sum_y = malloc((n_merge + 1) * sizeof(mpfr_t));
+    sum_y_ptr = malloc((n_merge + 1) * sizeof(mpfr_ptr));
+    dev_ptr = malloc(n * sizeof(mpfr_ptr));
+    merge = calloc(n, sizeof(char));
+
+    // Find the n - k smallest terms.
+    for (i_x = 0; i_x < n; i_x++) {
+        dev_ptr[i_x] = &(y->deviations[i_x]);
+    }
+    arpra_helper_select_abs(dev_ptr, n, n_merge);
+    for (i_x = 0; i_x < n_merge; i_x++) {
+        merge[dev_ptr[i_x] - y->deviations] = 1;
+    }
+
+    // Merge them with the last term.
+    for (i_x = 0; i_x < n_merge; i_x++) {
+        sum_y[i_x] = *(dev_ptr[i_x]);
+        sum_y[i_x]._mpfr_sign = 1;
+        sum_y_ptr[i_x] = &(sum_y[i_x]);
+    }
+    sum_y[n_merge] = y->deviations[n];
+    sum_y[n_merge]._mpfr_sign = 1;
+    sum_y_ptr[n_merge] = &(sum_y[n_merge]);
+    mpfr_sum(error, sum_y_ptr, (n_merge + 1), MPFR_RNDU);
+
+    // Remove merged terms, preserving symbol order.
+    for (i_y = 0, i_x = 0; i_x < n; i_x++) {
+        if (merge[i_x]) {
+            mpfr_clear(&(y->deviations[i_x]));
+        }
+        else {
+            y->symbols[i_y] = y->symbols[i_x];
+            y->deviations[i_y] = y->deviations[i_x];
+            i_y++;
+        }
+    }
+    y->symbols[i_y] = y->symbols[n];
+    y->deviations[i_y] = y->deviations[n];
+    mpfr_set(&(y->deviations[i_y]), error, MPFR_RNDU);
+    y->nTerms = i_y + 1;
+
+    // Clear vars.
+    mpfr_clear(error);
+    free(sum_y);
+    free(sum_y_ptr);
+    free(dev_ptr);
+    free(merge);
+}
@@ -0,0 +1,58 @@
+/*
+ * helper_gallop.c -- Galloping search in sorted symbol arrays.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * Return the first index in [lo, hi) whose symbol is not less than symbol,
+ * or hi if there is none. The search probes lo + 1, lo + 3, lo + 7, ...
+ * before bisecting, so it costs O(log r) comparisons for a run of length r.
+ * When merging a long form with a short one, this lets the unshared terms
+ * between two shared symbols be found, and copied, in bulk.
+ */
+
+arpra_uint arpra_helper_gallop (const arpra_uint *symbols, arpra_uint lo, arpra_uint hi, arpra_uint symbol)
+{
+    arpra_uint step, mid;
+
+    if ((lo >= hi) || (symbols[lo] >= symbol)) return lo;
+
+    // Gallop to bracket the first symbol not less than symbol.
+    for (step = 1; ((hi - lo) > step) && (symbols[lo + step] < symbol); step *= 2) {
+        lo += step;
+    }
+    if ((hi - lo) > step) {
+        hi = lo + step;
+    }
+
+    // Bisect, knowing that symbols[lo] < symbol.
+    for (lo++; lo < hi;) {
+        mid = lo + ((hi - lo) / 2);
+        if (symbols[mid] < symbol) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
@@ -105,6 +105,30 @@ void arpra_helper_term_mul (mpfr_ptr error, mpfr_ptr y, mpfr_srcptr x1,
 }
 
 
+/*
+ * Apply arpra_helper_term_mul to n consecutive terms. If alpha is a point,
+ * each term is a single correctly rounded product, and no interval
+ * temporaries are needed.
+ */
+
+void arpra_helper_term_mul_n (mpfr_ptr error, mpfr_ptr y, mpfr_srcptr x1, arpra_uint n,
+                              mpfi_srcptr alpha)
+{
+    arpra_uint i;
+
+    if (mpfr_equal_p(&(alpha->left), &(alpha->right))) {
+        for (i = 0; i < n; i++) {
+            ARPRA_MPFR_RNDERR_MUL(error, MPFR_RNDN, &(y[i]), &(alpha->left), &(x1[i]));
+        }
+    }
+    else {
+        for (i = 0; i < n; i++) {
+            arpra_helper_term_mul(error, &(y[i]), &(x1[i]), alpha);
+        }
+    }
+}
+
+
 void arpra_helper_term_fma (mpfr_ptr error, mpfr_ptr y, mpfr_srcptr x1,
                             mpfi_srcptr alpha, mpfi_srcptr gamma)
 {
@@ -0,0 +1,80 @@
+/*
+ * helper_select.c -- Select the k smallest MPFR numbers by magnitude.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * Reorder the n pointers in x so that x[0], ..., x[k - 1] point to the k
+ * numbers of smallest magnitude, in no particular order. This is a
+ * quickselect with median-of-three pivots and three-way partitioning,
+ * taking O(n) time on average.
+ */
+
+void arpra_helper_select_abs (mpfr_ptr *x, arpra_uint n, arpra_uint k)
+{
+    arpra_uint lo, hi, lt, gt, i;
+    mpfr_ptr pivot, temp;
+    int cmp;
+
+    lo = 0;
+    hi = n;
+    while ((k > lo) && (k < hi)) {
+        // Median of first, middle and last.
+        pivot = x[lo + ((hi - lo) / 2)];
+        if (mpfr_cmpabs(x[lo], pivot) > 0) {
+            if (mpfr_cmpabs(x[lo], x[hi - 1]) < 0) pivot = x[lo];
+            else if (mpfr_cmpabs(pivot, x[hi - 1]) < 0) pivot = x[hi - 1];
+        }
+        else {
+            if (mpfr_cmpabs(x[lo], x[hi - 1]) > 0) pivot = x[lo];
+            else if (mpfr_cmpabs(pivot, x[hi - 1]) > 0) pivot = x[hi - 1];
+        }
+
+        // Partition into [lo, lt) < pivot, [lt, gt) = pivot, [gt, hi) > pivot.
+        for (lt = lo, i = lo, gt = hi; i < gt;) {
+            cmp = mpfr_cmpabs(x[i], pivot);
+            if (cmp < 0) {
+                temp = x[lt];
+                x[lt++] = x[i];
+                x[i++] = temp;
+            }
+            else if (cmp > 0) {
+                temp = x[--gt];
+                x[gt] = x[i];
+                x[i] = temp;
+            }
+            else {
+                i++;
+            }
+        }
+
+        // Continue in the part containing the k boundary.
+        if (k < lt) {
+            hi = lt;
+        }
+        else if (k > gt) {
+            lo = gt;
+        }
+        else {
+            break;
+        }
+    }
+}
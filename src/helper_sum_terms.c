@@ -0,0 +1,167 @@
+/*
+ * helper_sum_terms.c -- Sum the deviation terms of n Arpra ranges.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * Sum the deviation terms of x[0], ..., x[n - 1] into y, accumulating the
+ * rounding error in error. Space for one more term is left at the end of
+ * y, for the caller to store the new error term.
+ *
+ * If the symbols of x are packed into a span that is small relative to the
+ * number of terms, as they are after renumbering, the terms are bucketed by
+ * symbol with a counting sort, and each bucket is then summed in one pass.
+ * Otherwise, the sorted symbol lists of x are merged in the usual way.
+ */
+
+static void sum_terms_dense (arpra_range *y, mpfr_ptr error, const arpra_range *x, arpra_uint n,
+                             arpra_uint symbol_min, arpra_uint span, arpra_uint n_terms)
+{
+    mpfr_ptr *summands;
+    arpra_prec prec_internal;
+    arpra_uint i, i_x, i_y, j, start, *offset;
+
+    prec_internal = arpra_get_internal_precision();
+    summands = malloc(n_terms * sizeof(mpfr_ptr));
+    offset = calloc(span + 1, sizeof(arpra_uint));
+
+    // Count the terms with each symbol, and find bucket offsets.
+    for (i = 0; i < n; i++) {
+        for (i_x = 0; i_x < x[i].nTerms; i_x++) {
+            offset[x[i].symbols[i_x] - symbol_min + 1]++;
+        }
+    }
+    for (j = 1; j <= span; j++) {
+        offset[j] += offset[j - 1];
+    }
+
+    // Scatter deviation pointers into their buckets.
+    for (i = 0; i < n; i++) {
+        for (i_x = 0; i_x < x[i].nTerms; i_x++) {
+            j = x[i].symbols[i_x] - symbol_min;
+            summands[offset[j]++] = &(x[i].deviations[i_x]);
+        }
+    }
+
+    // Gather each nonempty bucket, in symbol order.
+    for (i_y = 0, start = 0, j = 0; j < span; j++) {
+        if (offset[j] > start) {
+            mpfr_init2(&(y->deviations[i_y]), prec_internal);
+
+            // y[i] = x1[i] + ... + xn[i]
+            y->symbols[i_y] = symbol_min + j;
+            ARPRA_MPFR_RNDERR_SUM(error, MPFR_RNDN, &(y->deviations[i_y]), &(summands[start]), (offset[j] - start));
+
+            start = offset[j];
+            i_y++;
+        }
+    }
+    y->nTerms = i_y;
+
+    free(summands);
+    free(offset);
+}
+
+static void sum_terms_sparse (arpra_range *y, mpfr_ptr error, const arpra_range *x, arpra_uint n)
+{
+    mpfr_ptr *summands;
+    arpra_prec prec_internal;
+    arpra_uint i, i_y, n_sum, *i_x;
+    arpra_uint symbol;
+    arpra_int xHasNext;
+
+    prec_internal = arpra_get_internal_precision();
+    summands = malloc(n * sizeof(mpfr_ptr));
+    i_x = calloc(n, sizeof(arpra_uint));
+
+    // For all unique symbols in x.
+    for (xHasNext = 0, i = 0; i < n; i++) {
+        xHasNext += x[i].nTerms > 0;
+    }
+    for (i_y = 0; xHasNext; i_y++) {
+        mpfr_init2(&(y->deviations[i_y]), prec_internal);
+        xHasNext = 0;
+        symbol = -1;
+
+        // Find and set the next lowest symbol in y.
+        for (i = 0; i < n; i++) {
+            if (i_x[i] < x[i].nTerms) {
+                if (x[i].symbols[i_x[i]] < symbol) {
+                    symbol = x[i].symbols[i_x[i]];
+                }
+            }
+        }
+        y->symbols[i_y] = symbol;
+
+        // For all x with the next symbol:
+        for (n_sum = 0, i = 0; i < n; i++) {
+            if (i_x[i] < x[i].nTerms) {
+                if (x[i].symbols[i_x[i]] == symbol) {
+                    // Get next deviation pointer of x[i].
+                    summands[n_sum++] = &(x[i].deviations[i_x[i]]);
+                    i_x[i]++;
+                }
+                xHasNext += i_x[i] < x[i].nTerms;
+            }
+        }
+
+        // y[i] = x1[i] + ... + xn[i]
+        ARPRA_MPFR_RNDERR_SUM(error, MPFR_RNDN, &(y->deviations[i_y]), summands, n_sum);
+    }
+    y->nTerms = i_y;
+
+    free(summands);
+    free(i_x);
+}
+
+void arpra_helper_sum_terms (arpra_range *y, mpfr_ptr error, const arpra_range *x, arpra_uint n)
+{
+    arpra_uint i, n_terms, symbol_min, symbol_max;
+
+    // Find the total number of terms, and the span of their symbols.
+    symbol_min = -1;
+    symbol_max = 0;
+    for (i = 0, n_terms = 0; i < n; i++) {
+        if (x[i].nTerms > 0) {
+            n_terms += x[i].nTerms;
+            if (x[i].symbols[0] < symbol_min) {
+                symbol_min = x[i].symbols[0];
+            }
+            if (x[i].symbols[x[i].nTerms - 1] > symbol_max) {
+                symbol_max = x[i].symbols[x[i].nTerms - 1];
+            }
+        }
+    }
+
+    // Allocate memory for deviation terms.
+    y->symbols = malloc((n_terms + 1) * sizeof(arpra_uint));
+    y->deviations = malloc((n_terms + 1) * sizeof(mpfr_t));
+
+    if (n_terms == 0) {
+        y->nTerms = 0;
+    }
+    else if ((symbol_max - symbol_min) < (ARPRA_DENSE_SPAN_FACTOR * n_terms)) {
+        sum_terms_dense(y, error, x, n, symbol_min, (symbol_max - symbol_min + 1), n_terms);
+    }
+    else {
+        sum_terms_sparse(y, error, x, n);
+    }
+}
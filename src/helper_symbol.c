@@ -22,10 +22,16 @@
 #include "arpra-impl.h"
 
 static arpra_uint symbol_count = 0;
+static arpra_uint symbol_floor = 0;
 
 arpra_uint arpra_helper_next_symbol ()
 {
-    return symbol_count++;
+    arpra_uint symbol;
+
+    #pragma omp atomic capture
+    symbol = symbol_count++;
+
+    return symbol;
 }
 
 arpra_uint arpra_helper_get_symbol_count ()
@@ -37,3 +43,18 @@ void arpra_helper_set_symbol_count (arpra_uint n)
 {
     symbol_count = n;
 }
+
+/*
+ * Symbols below the floor belong to long-lived cached constants, which are
+ * never renumbered, so renumbering starts from the floor instead of zero.
+ */
+
+void arpra_helper_reserve_symbols ()
+{
+    symbol_floor = symbol_count;
+}
+
+arpra_uint arpra_helper_get_symbol_floor ()
+{
+    return symbol_floor;
+}
@@ -0,0 +1,135 @@
+/*
+ * lincomb.c -- Linear combination of n Arpra ranges.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * y = alpha[0] * x[0] + ... + alpha[n - 1] * x[n - 1]
+ *
+ * Each product is formed exactly, at the summed precision of its factors
+ * (whatever the internal precision), so that the only rounding is in the
+ * final n-ary sum of each term.
+ */
+
+void arpra_lincomb (arpra_range *y, const arpra_range *x, const mpfr_ptr *alpha, arpra_uint n)
+{
+    mpfi_t ia_range, ia_temp;
+    mpfr_t error;
+    mpfr_ptr centres, *summands;
+    arpra_range yy, *xx;
+    arpra_prec prec_internal;
+    arpra_uint i, i_x, n_inf;
+
+    // Domain violations:
+    // (NaN) * (R) + ... = (NaN)
+    // (R) * (NaN) + ... = (NaN)
+    // (Inf) * (R) + ... + (Inf) * (R) = (NaN)
+    // (Inf) * (R) + ... + (R) * (R)   = (Inf)
+
+    // Handle domain violations.
+    if (n == 0) {
+        arpra_set_nan(y);
+        return;
+    }
+    for (i = 0, n_inf = 0; i < n; i++) {
+        if (arpra_nan_p(&(x[i])) || mpfr_nan_p(alpha[i])) {
+            arpra_set_nan(y);
+            return;
+        }
+        n_inf += arpra_inf_p(&(x[i])) || mpfr_inf_p(alpha[i]);
+    }
+    if (n_inf > 0) {
+        if (n_inf > 1) {
+            arpra_set_nan(y);
+        }
+        else {
+            arpra_set_inf(y);
+        }
+        return;
+    }
+
+    // Initialise vars.
+    prec_internal = arpra_get_internal_precision();
+    mpfi_init2(ia_range, y->precision);
+    mpfi_init2(ia_temp, y->precision);
+    mpfr_init2(error, prec_internal);
+    arpra_init2(&yy, y->precision);
+    centres = malloc(n * sizeof(mpfr_t));
+    summands = malloc(n * sizeof(mpfr_ptr));
+    xx = malloc(n * sizeof(arpra_range));
+    mpfi_set_si(ia_range, 0);
+    mpfr_set_zero(error, 1);
+
+    for (i = 0; i < n; i++) {
+        // MPFI linear combination
+        mpfi_mul_fr(ia_temp, &(x[i].true_range), alpha[i]);
+        mpfi_add(ia_range, ia_range, ia_temp);
+
+        // Scale centre and deviations of x[i] by alpha[i].
+        mpfr_init2(&(centres[i]), mpfr_get_prec(&(x[i].centre)) + mpfr_get_prec(alpha[i]));
+        mpfr_mul(&(centres[i]), &(x[i].centre), alpha[i], MPFR_RNDN);
+        summands[i] = &(centres[i]);
+        xx[i].symbols = x[i].symbols;
+        xx[i].deviations = malloc(x[i].nTerms * sizeof(mpfr_t));
+        xx[i].nTerms = x[i].nTerms;
+        for (i_x = 0; i_x < x[i].nTerms; i_x++) {
+            mpfr_init2(&(xx[i].deviations[i_x]),
+                       mpfr_get_prec(&(x[i].deviations[i_x])) + mpfr_get_prec(alpha[i]));
+            mpfr_mul(&(xx[i].deviations[i_x]), &(x[i].deviations[i_x]), alpha[i], MPFR_RNDN);
+        }
+    }
+
+    // y[0] = alpha1 * x1[0] + ... + alphan * xn[0]
+    ARPRA_MPFR_RNDERR_SUM(error, MPFR_RNDN, &(yy.centre), summands, n);
+
+    // y[i] = alpha1 * x1[i] + ... + alphan * xn[i]
+    arpra_helper_sum_terms(&yy, error, xx, n);
+
+    // Store new deviation term.
+    yy.symbols[yy.nTerms] = arpra_helper_next_symbol();
+    yy.deviations[yy.nTerms] = *error;
+    yy.nTerms++;
+
+    // Compute true_range.
+    arpra_helper_compute_range(&yy);
+
+    // Mix with IA range, and trim error term.
+    arpra_helper_mix_trim(&yy, ia_range);
+
+    // Check for NaN and Inf.
+    arpra_helper_check_result(&yy);
+
+    // Clear vars, and set y.
+    mpfi_clear(ia_range);
+    mpfi_clear(ia_temp);
+    for (i = 0; i < n; i++) {
+        mpfr_clear(&(centres[i]));
+        for (i_x = 0; i_x < xx[i].nTerms; i_x++) {
+            mpfr_clear(&(xx[i].deviations[i_x]));
+        }
+        free(xx[i].deviations);
+    }
+    arpra_clear(y);
+    *y = yy;
+    free(centres);
+    free(summands);
+    free(xx);
+}
@@ -157,13 +157,30 @@ static void mul_err_rump_kashiwagi (mpfr_ptr error, const arpra_range *x1, const
     mpfr_clear(x1ix2i_neg_error);
 }
 
+/*
+ * Add the bound on the nonlinear remainder of x1 * x2 to error, using the
+ * current multiplication method.
+ */
+
+void arpra_helper_mul_error (mpfr_ptr error, const arpra_range *x1, const arpra_range *x2)
+{
+    switch (mul_method) {
+    case ARPRA_MUL_TRIVIAL:
+        mul_err_trivial(error, x1, x2);
+        break;
+    case ARPRA_MUL_RUMP_KASHIWAGI:
+        mul_err_rump_kashiwagi(error, x1, x2);
+        break;
+    }
+}
+
 void arpra_mul (arpra_range *y, const arpra_range *x1, const arpra_range *x2)
 {
     mpfi_t ia_range;
+    mpfi_t x1_centre, x2_centre;
     mpfr_t error;
     arpra_range yy;
-    arpra_uint i_y, i_x1, i_x2;
-    arpra_int x1HasNext, x2HasNext;
+    arpra_uint i, n, i_y, i_x1, i_x2;
     arpra_prec prec_internal;
 
     // Domain violations:
@@ -203,8 +220,12 @@ void arpra_mul (arpra_range *y, const arpra_range *x1, const arpra_range *x2)
     // Initialise vars.
     prec_internal = arpra_get_internal_precision();
     mpfi_init2(ia_range, y->precision);
+    mpfi_init2(x1_centre, mpfr_get_prec(&(x1->centre)));
+    mpfi_init2(x2_centre, mpfr_get_prec(&(x2->centre)));
     mpfr_init2(error, prec_internal);
     arpra_init2(&yy, y->precision);
+    mpfi_set_fr(x1_centre, &(x1->centre));
+    mpfi_set_fr(x2_centre, &(x2->centre));
     mpfr_set_zero(error, 1);
 
     // y[0] = x1[0] * x2[0]
@@ -217,42 +238,47 @@ void arpra_mul (arpra_range *y, const arpra_range *x1, const arpra_range *x2)
     i_y = 0;
     i_x1 = 0;
     i_x2 = 0;
-    x1HasNext = x1->nTerms > 0;
-    x2HasNext = x2->nTerms > 0;
-    while (x1HasNext || x2HasNext) {
-        mpfr_init2(&(yy.deviations[i_y]), prec_internal);
+    while ((i_x1 < x1->nTerms) || (i_x2 < x2->nTerms)) {
+        if ((i_x2 == x2->nTerms) || ((i_x1 < x1->nTerms) && (x1->symbols[i_x1] < x2->symbols[i_x2]))) {
+            // Gallop over the run of symbols only in x1.
+            n = (i_x2 == x2->nTerms) ? x1->nTerms : arpra_helper_gallop(x1->symbols, i_x1, x1->nTerms, x2->symbols[i_x2]);
+            for (i = 0; i < (n - i_x1); i++) {
+                mpfr_init2(&(yy.deviations[i_y + i]), prec_internal);
+                yy.symbols[i_y + i] = x1->symbols[i_x1 + i];
+            }
 
-        if ((!x2HasNext) || (x1HasNext && (x1->symbols[i_x1] < x2->symbols[i_x2]))) {
             // y[i] = (x2[0] * x1[i])
-            yy.symbols[i_y] = x1->symbols[i_x1];
-            ARPRA_MPFR_RNDERR_MUL(error, MPFR_RNDN, &(yy.deviations[i_y]), &(x2->centre), &(x1->deviations[i_x1]));
-            x1HasNext = ++i_x1 < x1->nTerms;
+            arpra_helper_term_mul_n(error, &(yy.deviations[i_y]), &(x1->deviations[i_x1]), (n - i_x1), x2_centre);
+            i_y += n - i_x1;
+            i_x1 = n;
         }
-        else if ((!x1HasNext) || (x2HasNext && (x2->symbols[i_x2] < x1->symbols[i_x1]))) {
+        else if ((i_x1 == x1->nTerms) || ((i_x2 < x2->nTerms) && (x2->symbols[i_x2] < x1->symbols[i_x1]))) {
+            // Gallop over the run of symbols only in x2.
+            n = (i_x1 == x1->nTerms) ? x2->nTerms : arpra_helper_gallop(x2->symbols, i_x2, x2->nTerms, x1->symbols[i_x1]);
+            for (i = 0; i < (n - i_x2); i++) {
+                mpfr_init2(&(yy.deviations[i_y + i]), prec_internal);
+                yy.symbols[i_y + i] = x2->symbols[i_x2 + i];
+            }
+
             // y[i] = (x1[0] * x2[i])
-            yy.symbols[i_y] = x2->symbols[i_x2];
-            ARPRA_MPFR_RNDERR_MUL(error, MPFR_RNDN, &(yy.deviations[i_y]), &(x1->centre), &(x2->deviations[i_x2]));
-            x2HasNext = ++i_x2 < x2->nTerms;
+            arpra_helper_term_mul_n(error, &(yy.deviations[i_y]), &(x2->deviations[i_x2]), (n - i_x2), x1_centre);
+            i_y += n - i_x2;
+            i_x2 = n;
         }
         else {
+            mpfr_init2(&(yy.deviations[i_y]), prec_internal);
+
             // y[i] = (x2[0] * x1[i]) + (x1[0] * x2[i])
             yy.symbols[i_y] = x1->symbols[i_x1];
             ARPRA_MPFR_RNDERR_FMMA(error, MPFR_RNDN, &(yy.deviations[i_y]), &(x2->centre), &(x1->deviations[i_x1]), &(x1->centre), &(x2->deviations[i_x2]));
-            x1HasNext = ++i_x1 < x1->nTerms;
-            x2HasNext = ++i_x2 < x2->nTerms;
+            i_y++;
+            i_x1++;
+            i_x2++;
         }
-        i_y++;
     }
 
     // Approximation error.
-    switch (mul_method) {
-    case ARPRA_MUL_TRIVIAL:
-        mul_err_trivial(error, x1, x2);
-        break;
-    case ARPRA_MUL_RUMP_KASHIWAGI:
-        mul_err_rump_kashiwagi(error, x1, x2);
-        break;
-    }
+    arpra_helper_mul_error(error, x1, x2);
 
     // Store new deviation term.
     yy.symbols[i_y] = arpra_helper_next_symbol();
@@ -273,6 +299,8 @@ void arpra_mul (arpra_range *y, const arpra_range *x1, const arpra_range *x2)
 
     // Clear vars, and set y.
     mpfi_clear(ia_range);
+    mpfi_clear(x1_centre);
+    mpfi_clear(x2_centre);
     arpra_clear(y);
     *y = yy;
 }
@@ -0,0 +1,438 @@
+/*
+ * ode_adams.c -- Adams-Bashforth and Adams-Bashforth-Moulton ODE steppers.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+#define adams_max_order 5
+
+typedef struct adams_scratch_struct
+{
+    arpra_range *_f[adams_max_order];
+    arpra_range **f[adams_max_order];
+    arpra_range *_x_new;
+    arpra_range **x_new;
+    arpra_range b_p[adams_max_order];
+    arpra_range b_c[adams_max_order];
+    arpra_range bh_p[adams_max_order];
+    arpra_range bh_c[adams_max_order];
+    arpra_range h;
+    __mpfr_struct h_centre;
+    __mpfr_struct h_radius;
+    arpra_prec h_prec;
+    arpra_range t_new;
+    arpra_uint order;
+    arpra_uint n_hist;
+    arpra_uint head;
+    int corrector;
+    arpra_ode_stepper starter;
+} adams_scratch;
+
+// Adams-Bashforth coefficients of f(t_n), ..., f(t_n-p+1), over a common denominator.
+static const double adams_bashforth_num[adams_max_order + 1][adams_max_order] =
+{
+    {0},
+    {1},
+    {3, -1},
+    {23, -16, 5},
+    {55, -59, 37, -9},
+    {1901, -2774, 2616, -1274, 251},
+};
+
+// Adams-Moulton coefficients of f(t_n+1), ..., f(t_n-p+2), over a common denominator.
+static const double adams_moulton_num[adams_max_order + 1][adams_max_order] =
+{
+    {0},
+    {1},
+    {1, 1},
+    {5, 8, -1},
+    {9, 19, -5, 1},
+    {251, 646, -264, 106, -19},
+};
+
+static const double adams_den[adams_max_order + 1] = {1, 1, 2, 12, 24, 720};
+
+static void adams_compute_constants (arpra_ode_stepper *stepper, const arpra_prec prec)
+{
+    arpra_uint k_j;
+    arpra_range numerator, denominator;
+    adams_scratch *scratch;
+
+    scratch = (adams_scratch *) stepper->scratch;
+
+    // Init temp vars.
+    arpra_init2(&numerator, prec);
+    arpra_init2(&denominator, prec);
+
+    // x_p(t + h) = x(t) + b_p0 h f(t) + ... + b_pq h f(t - q h)
+    // x_c(t + h) = x(t) + b_c0 h f(t + h, x_p(t + h)) + ... + b_cq h f(t - (q - 1) h)
+    arpra_set_d(&denominator, adams_den[scratch->order]);
+    for (k_j = 0; k_j < scratch->order; k_j++) {
+        arpra_set_precision(&(scratch->b_p[k_j]), prec);
+        arpra_set_d(&numerator, adams_bashforth_num[scratch->order][k_j]);
+        arpra_div(&(scratch->b_p[k_j]), &numerator, &denominator);
+        arpra_set_precision(&(scratch->b_c[k_j]), prec);
+        arpra_set_d(&numerator, adams_moulton_num[scratch->order][k_j]);
+        arpra_div(&(scratch->b_c[k_j]), &numerator, &denominator);
+    }
+
+    // Clear temp vars.
+    arpra_clear(&numerator);
+    arpra_clear(&denominator);
+}
+
+static int adams_history_valid (const arpra_ode_stepper *stepper)
+{
+    const adams_scratch *scratch;
+
+    scratch = (const adams_scratch *) stepper->scratch;
+
+    // History is only valid if the state is exactly the one recorded after the last step.
+    return (scratch->n_hist > 0) && arpra_helper_ode_record_equal_p(stepper->record, stepper->system);
+}
+
+static void adams_history_push (arpra_ode_stepper *stepper)
+{
+    arpra_ode_system *system;
+    adams_scratch *scratch;
+
+    system = stepper->system;
+    scratch = (adams_scratch *) stepper->scratch;
+
+    // f(t_n+1) = f(t_n+1, x(t_n+1))
+    scratch->head = (scratch->head + 1) % scratch->order;
+    arpra_helper_ode_eval(stepper, scratch->f[scratch->head], system->t, (const arpra_range **) system->x);
+    if (scratch->n_hist < scratch->order) scratch->n_hist++;
+}
+
+static void adams_init (arpra_ode_stepper *stepper, arpra_ode_system *system,
+                        const arpra_ode_method *method, arpra_uint order, int corrector)
+{
+    arpra_uint x_grp, x_dim, k_i, state_size;
+    arpra_prec prec_x, prec_internal;
+    adams_scratch *scratch;
+
+    // Allocate scratch memory.
+    scratch = malloc(sizeof(adams_scratch));
+    for (x_grp = 0, state_size = 0; x_grp < system->grps; x_grp++) {
+        state_size += system->dims[x_grp];
+    }
+    for (k_i = 0; k_i < order; k_i++) {
+        scratch->_f[k_i] = malloc(state_size * sizeof(arpra_range));
+        scratch->f[k_i] = malloc(system->grps * sizeof(arpra_range *));
+    }
+    scratch->_x_new = malloc(state_size * sizeof(arpra_range));
+    scratch->x_new = malloc(system->grps * sizeof(arpra_range *));
+
+    // Initialise scratch memory.
+    prec_internal = arpra_get_internal_precision();
+    for (k_i = 0; k_i < order; k_i++) {
+        scratch->f[k_i][0] = scratch->_f[k_i];
+    }
+    scratch->x_new[0] = scratch->_x_new;
+    for (x_grp = 1; x_grp < system->grps; x_grp++) {
+        for (k_i = 0; k_i < order; k_i++) {
+            scratch->f[k_i][x_grp] = scratch->f[k_i][x_grp - 1] + system->dims[x_grp - 1];
+        }
+        scratch->x_new[x_grp] = scratch->x_new[x_grp - 1] + system->dims[x_grp - 1];
+    }
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
+            for (k_i = 0; k_i < order; k_i++) {
+                arpra_init2(&(scratch->f[k_i][x_grp][x_dim]), prec_x);
+            }
+            arpra_init2(&(scratch->x_new[x_grp][x_dim]), prec_x);
+        }
+    }
+    for (k_i = 0; k_i < order; k_i++) {
+        arpra_init2(&(scratch->b_p[k_i]), prec_internal);
+        arpra_init2(&(scratch->b_c[k_i]), prec_internal);
+        arpra_init2(&(scratch->bh_p[k_i]), prec_internal);
+        arpra_init2(&(scratch->bh_c[k_i]), prec_internal);
+    }
+    mpfr_init2(&(scratch->h_centre), prec_internal);
+    mpfr_init2(&(scratch->h_radius), prec_internal);
+    arpra_init2(&(scratch->h), prec_internal);
+    scratch->h_prec = 0;
+    arpra_init2(&(scratch->t_new), prec_internal);
+    scratch->order = order;
+    scratch->n_hist = 0;
+    scratch->head = 0;
+    scratch->corrector = corrector;
+
+    // Start up with a one-step method of sufficient order.
+    arpra_ode_stepper_init(&(scratch->starter), system, arpra_ode_dopri54);
+
+    // Set stepper parameters.
+    stepper->method = method;
+    stepper->system = system;
+    stepper->error = NULL;
+    stepper->scratch = scratch;
+
+    // Precompute constants.
+    adams_compute_constants(stepper, prec_internal);
+}
+
+static void adams_clear (arpra_ode_stepper *stepper)
+{
+    arpra_uint x_grp, x_dim, k_i;
+    arpra_ode_system *system;
+    adams_scratch *scratch;
+
+    system = stepper->system;
+    scratch = (adams_scratch *) stepper->scratch;
+
+    // Clear scratch memory.
+    arpra_ode_stepper_clear(&(scratch->starter));
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            for (k_i = 0; k_i < scratch->order; k_i++) {
+                arpra_clear(&(scratch->f[k_i][x_grp][x_dim]));
+            }
+            arpra_clear(&(scratch->x_new[x_grp][x_dim]));
+        }
+    }
+    for (k_i = 0; k_i < scratch->order; k_i++) {
+        arpra_clear(&(scratch->b_p[k_i]));
+        arpra_clear(&(scratch->b_c[k_i]));
+        arpra_clear(&(scratch->bh_p[k_i]));
+        arpra_clear(&(scratch->bh_c[k_i]));
+    }
+    mpfr_clear(&(scratch->h_centre));
+    mpfr_clear(&(scratch->h_radius));
+    arpra_clear(&(scratch->h));
+    arpra_clear(&(scratch->t_new));
+
+    // Free scratch memory.
+    for (k_i = 0; k_i < scratch->order; k_i++) {
+        free(scratch->_f[k_i]);
+        free(scratch->f[k_i]);
+    }
+    free(scratch->_x_new);
+    free(scratch->x_new);
+    free(scratch);
+}
+
+static void adams_step (arpra_ode_stepper *stepper, const arpra_range *h)
+{
+    arpra_uint x_grp, x_dim, k_i, k_j;
+    arpra_prec prec_t, prec_x;
+    arpra_range **f[adams_max_order];
+    arpra_ode_system *system;
+    adams_scratch *scratch;
+    int h_changed;
+
+    system = stepper->system;
+    scratch = (adams_scratch *) stepper->scratch;
+    prec_t = arpra_get_precision(system->t);
+
+    // A new step size invalidates the history, since it assumes equal spacing.
+    // A new range with the same value (such as after a checkpoint is loaded,
+    // or h updated in place with new symbols) only needs the h-scaled
+    // coefficients to be recomputed.
+    h_changed = !mpfr_equal_p(&(h->centre), &(scratch->h_centre))
+        || !mpfr_equal_p(&(h->radius), &(scratch->h_radius));
+    if (h_changed) {
+        scratch->n_hist = 0;
+    }
+    if ((scratch->h_prec != prec_t) || !arpra_helper_ode_equal_exact_p(h, &(scratch->h))) {
+        for (k_j = 0; k_j < scratch->order; k_j++) {
+            arpra_set_precision(&(scratch->bh_p[k_j]), prec_t);
+            arpra_mul(&(scratch->bh_p[k_j]), &(scratch->b_p[k_j]), h);
+            arpra_set_precision(&(scratch->bh_c[k_j]), prec_t);
+            arpra_mul(&(scratch->bh_c[k_j]), &(scratch->b_c[k_j]), h);
+        }
+        arpra_helper_ode_copy_exact(&(scratch->h), h);
+        scratch->h_prec = prec_t;
+        mpfr_set_prec(&(scratch->h_centre), mpfr_get_prec(&(h->centre)));
+        mpfr_set(&(scratch->h_centre), &(h->centre), MPFR_RNDN);
+        mpfr_set_prec(&(scratch->h_radius), mpfr_get_prec(&(h->radius)));
+        mpfr_set(&(scratch->h_radius), &(h->radius), MPFR_RNDN);
+    }
+
+    // Restart from the current state if it was changed externally.
+    if (!adams_history_valid(stepper)) {
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+                prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
+                for (k_i = 0; k_i < scratch->order; k_i++) {
+                    arpra_set_precision(&(scratch->f[k_i][x_grp][x_dim]), prec_x);
+                }
+                arpra_set_precision(&(scratch->x_new[x_grp][x_dim]), prec_x);
+            }
+        }
+        arpra_set_precision(&(scratch->t_new), prec_t);
+        scratch->n_hist = 0;
+        adams_history_push(stepper);
+    }
+
+    // Fill the history with a one-step method.
+    if (scratch->n_hist < scratch->order) {
+        arpra_ode_stepper_step(&(scratch->starter), h);
+        adams_history_push(stepper);
+        return;
+    }
+
+    // x_p(t + h) = x(t) + b_p0 h f(t) + ... + b_pq h f(t - q h)
+    for (k_j = 0; k_j < scratch->order; k_j++) {
+        f[k_j] = scratch->f[(scratch->head + scratch->order - k_j) % scratch->order];
+    }
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            arpra_helper_ode_combine(&(scratch->x_new[x_grp][x_dim]), &(system->x[x_grp][x_dim]),
+                                     f, scratch->bh_p, scratch->order, x_grp, x_dim);
+        }
+    }
+    arpra_add(&(scratch->t_new), system->t, h);
+
+    if (scratch->corrector) {
+        // The oldest f is not used by the corrector, so its slot holds f(t + h, x_p(t + h)).
+        k_i = (scratch->head + 1) % scratch->order;
+        arpra_helper_ode_eval(stepper, scratch->f[k_i], &(scratch->t_new), (const arpra_range **) scratch->x_new);
+
+        // x_c(t + h) = x(t) + b_c0 h f(t + h, x_p(t + h)) + ... + b_cq h f(t - (q - 1) h)
+        for (k_j = 0; k_j < scratch->order; k_j++) {
+            f[k_j] = scratch->f[(scratch->head + 1 + scratch->order - k_j) % scratch->order];
+        }
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+                arpra_helper_ode_combine(&(scratch->x_new[x_grp][x_dim]), &(system->x[x_grp][x_dim]),
+                                         f, scratch->bh_c, scratch->order, x_grp, x_dim);
+            }
+        }
+    }
+
+    // Advance system, and evaluate f at the new state.
+    arpra_swap(system->t, &(scratch->t_new));
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            arpra_swap(&(system->x[x_grp][x_dim]), &(scratch->x_new[x_grp][x_dim]));
+        }
+    }
+    adams_history_push(stepper);
+}
+
+static void adams_invalidate (arpra_ode_stepper *stepper)
+{
+    adams_scratch *scratch;
+
+    scratch = (adams_scratch *) stepper->scratch;
+    scratch->n_hist = 0;
+    arpra_ode_stepper_invalidate(&(scratch->starter));
+}
+
+static int adams_save (arpra_ode_stepper *stepper, FILE *stream)
+{
+    arpra_uint x_grp, x_dim, k_i, k_j, n_hist;
+    arpra_ode_system *system;
+    adams_scratch *scratch;
+
+    system = stepper->system;
+    scratch = (adams_scratch *) stepper->scratch;
+
+    // The history of f, newest first, and the step size it was taken with.
+    n_hist = adams_history_valid(stepper) ? scratch->n_hist : 0;
+    if (arpra_helper_fpif_export_uint(stream, n_hist)) return 1;
+    if (n_hist == 0) return 0;
+    if (arpra_helper_fpif_export_uint(stream, scratch->head)) return 1;
+    if (mpfr_fpif_export(stream, &(scratch->h_centre))) return 1;
+    if (mpfr_fpif_export(stream, &(scratch->h_radius))) return 1;
+    for (k_j = 0; k_j < n_hist; k_j++) {
+        k_i = (scratch->head + scratch->order - k_j) % scratch->order;
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+                if (arpra_fpif_export(stream, &(scratch->f[k_i][x_grp][x_dim]))) return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int adams_load (arpra_ode_stepper *stepper, FILE *stream, arpra_uint symbol_offset)
+{
+    arpra_uint x_grp, x_dim, k_i, k_j, n_hist, head;
+    arpra_ode_system *system;
+    adams_scratch *scratch;
+
+    system = stepper->system;
+    scratch = (adams_scratch *) stepper->scratch;
+    scratch->n_hist = 0;
+
+    // The history is only used if all of it was read.
+    if (arpra_helper_fpif_import_uint(&n_hist, stream)) return 1;
+    if (n_hist > scratch->order) return 1;
+    if (n_hist == 0) return 0;
+    if (arpra_helper_fpif_import_uint(&head, stream)) return 1;
+    if (head >= scratch->order) return 1;
+    if (mpfr_fpif_import(&(scratch->h_centre), stream)) return 1;
+    if (mpfr_fpif_import(&(scratch->h_radius), stream)) return 1;
+    for (k_j = 0; k_j < n_hist; k_j++) {
+        k_i = (head + scratch->order - k_j) % scratch->order;
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+                if (arpra_helper_fpif_import_shift(&(scratch->f[k_i][x_grp][x_dim]), stream,
+                                                   symbol_offset)) return 1;
+            }
+        }
+    }
+
+    // Scale the coefficients by the caller's h on the next step.
+    scratch->h_prec = 0;
+    scratch->head = head;
+    scratch->n_hist = n_hist;
+
+    return 0;
+}
+
+#define ADAMS_METHOD(name, q, pc)                                       \
+    static void name##_init (arpra_ode_stepper *stepper, arpra_ode_system *system); \
+                                                                        \
+    static const arpra_ode_method name =                                \
+    {                                                                   \
+        .init = &name##_init,                                           \
+        .clear = &adams_clear,                                          \
+        .step = &adams_step,                                            \
+        .reject = NULL,                                                 \
+        .invalidate = &adams_invalidate,                                \
+        .interpolate = NULL,                                            \
+        .save = &adams_save,                                            \
+        .load = &adams_load,                                            \
+        .stages = (pc) ? 2 : 1,                                         \
+        .order = q,                                                     \
+        .error_order = 0,                                               \
+    };                                                                  \
+                                                                        \
+    static void name##_init (arpra_ode_stepper *stepper, arpra_ode_system *system) \
+    {                                                                   \
+        adams_init(stepper, system, &name, q, pc);                      \
+    }                                                                   \
+                                                                        \
+    const arpra_ode_method *arpra_ode_##name = &name;
+
+ADAMS_METHOD(ab2, 2, 0)
+ADAMS_METHOD(ab3, 3, 0)
+ADAMS_METHOD(ab4, 4, 0)
+ADAMS_METHOD(ab5, 5, 0)
+ADAMS_METHOD(abm2, 2, 1)
+ADAMS_METHOD(abm3, 3, 1)
+ADAMS_METHOD(abm4, 4, 1)
+ADAMS_METHOD(abm5, 5, 1)
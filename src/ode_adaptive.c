@@ -0,0 +1,130 @@
+/*
+ * ode_adaptive.c -- Adaptive step size control for ODE steppers.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+static void adaptive_error_norm (mpfr_ptr norm, const arpra_ode_stepper *stepper,
+                                 mpfr_srcptr tol_centre, mpfr_srcptr tol_radius)
+{
+    arpra_uint x_grp, x_dim;
+    const arpra_range *error;
+    const arpra_ode_system *system;
+    mpfr_t temp;
+
+    system = stepper->system;
+    mpfr_init2(temp, mpfr_get_prec(norm));
+    mpfr_set_zero(norm, 1);
+
+    // norm = max(|centre(error)| / tol_centre, radius(error) / tol_radius)
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            error = &(stepper->error[x_grp][x_dim]);
+            if (!arpra_bounded_p(error)) {
+                mpfr_set_inf(norm, 1);
+                mpfr_clear(temp);
+                return;
+            }
+            mpfr_abs(temp, &(error->centre), MPFR_RNDU);
+            mpfr_div(temp, temp, tol_centre, MPFR_RNDU);
+            mpfr_max(norm, norm, temp, MPFR_RNDU);
+            if (tol_radius != NULL) {
+                mpfr_div(temp, &(error->radius), tol_radius, MPFR_RNDU);
+                mpfr_max(norm, norm, temp, MPFR_RNDU);
+            }
+        }
+    }
+
+    mpfr_clear(temp);
+}
+
+/*
+ * Take one step, retrying with a smaller h until the error norm is at most
+ * one. On return, h holds the proposed size of the next step. Returns the
+ * number of rejected attempts, or ARPRA_ODE_STEP_FAILED if ARPRA_ODE_MAX_REJECT
+ * attempts were rejected, in which case t and x are left unchanged.
+ */
+
+arpra_uint arpra_ode_stepper_step_adaptive (arpra_ode_stepper *stepper, arpra_range *h,
+                                           mpfr_srcptr tol_centre, mpfr_srcptr tol_radius)
+{
+    arpra_uint n_reject, symbol_start;
+    const arpra_ode_method *method;
+    double norm_d, factor;
+    mpfr_t norm, h_new;
+
+    method = stepper->method;
+    symbol_start = arpra_helper_get_symbol_count();
+
+    // Methods without an embedded error estimate take a fixed step.
+    if ((stepper->error == NULL) || (method->reject == NULL) || (method->error_order == 0)) {
+        method->step(stepper, h);
+        arpra_helper_ode_reduce(stepper, symbol_start);
+        return 0;
+    }
+
+    // Initialise vars.
+    mpfr_init2(norm, arpra_get_internal_precision());
+    mpfr_init2(h_new, arpra_get_precision(h));
+
+    for (n_reject = 0; ; n_reject++) {
+        method->step(stepper, h);
+        adaptive_error_norm(norm, stepper, tol_centre, tol_radius);
+        norm_d = mpfr_get_d(norm, MPFR_RNDU);
+
+        // h_new = h * safety * (1 / norm)^(1 / (q + 1))
+        if (norm_d == 0) {
+            factor = ARPRA_ODE_MAX_FACTOR;
+        }
+        else {
+            factor = ARPRA_ODE_SAFETY_FACTOR * pow(norm_d, -1. / (method->error_order + 1));
+            if (factor > ARPRA_ODE_MAX_FACTOR) factor = ARPRA_ODE_MAX_FACTOR;
+            if (factor < ARPRA_ODE_MIN_FACTOR) factor = ARPRA_ODE_MIN_FACTOR;
+        }
+
+        // Accept the step, or reject it and retry with a smaller h.
+        if (norm_d <= 1) {
+            if ((n_reject > 0) && (factor > 1)) factor = 1;
+            mpfr_mul_d(h_new, &(h->centre), factor, MPFR_RNDN);
+            arpra_set_mpfr(h, h_new);
+            break;
+        }
+        method->reject(stepper);
+        mpfr_mul_d(h_new, &(h->centre), factor, MPFR_RNDN);
+        arpra_set_mpfr(h, h_new);
+
+        // Give up, leaving the system at the start of the step.
+        if (n_reject + 1 >= ARPRA_ODE_MAX_REJECT) {
+            n_reject = ARPRA_ODE_STEP_FAILED;
+            break;
+        }
+    }
+
+    // Reduce the accepted state.
+    if (n_reject != ARPRA_ODE_STEP_FAILED) {
+        arpra_helper_ode_reduce(stepper, symbol_start);
+    }
+
+    // Clear vars.
+    mpfr_clear(norm);
+    mpfr_clear(h_new);
+
+    return n_reject;
+}
@@ -0,0 +1,268 @@
+/*
+ * ode_checkpoint.c -- Save and restore the state of an ODE simulation.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * A checkpoint holds the Arpra configuration and symbol counter, the state
+ * of the system (t, x, event signs), the progress of the stepper's
+ * reduction policy, and the step method's own history, if it has any.
+ *
+ * To resume, initialise the system and stepper as for the original run,
+ * then load the checkpoint. Loaded symbols are shifted past those already
+ * in use, so ranges created before loading (step sizes, parameters, cached
+ * constants) stay independent of the loaded state. The method, and the
+ * group sizes of the system, must match those of the saved run.
+ *
+ * The checkpoint is read into temporaries, and the system is only changed
+ * if the whole checkpoint was read. The saved configuration (range and mul
+ * methods, precisions and max_terms) is only restored if asked for.
+ */
+
+typedef struct checkpoint_struct
+{
+    arpra_uint config[5];
+    arpra_range t;
+    arpra_range *x;
+    int *sign;
+    arpra_uint step_count;
+    arpra_uint condensed;
+} checkpoint;
+
+static const char checkpoint_magic[8] = {'A', 'R', 'P', 'R', 'A', 'C', 'P', '1'};
+
+static int checkpoint_write (FILE *stream, arpra_ode_stepper *stepper)
+{
+    arpra_uint x_grp, x_dim, i, n;
+    arpra_ode_system *system;
+    arpra_ode_reduce *reduce;
+    const arpra_ode_method *method;
+
+    system = stepper->system;
+    reduce = stepper->reduce;
+    method = stepper->method;
+
+    // Configuration.
+    n = sizeof(checkpoint_magic);
+    if (fwrite(checkpoint_magic, 1, n, stream) != n) return 1;
+    if (arpra_helper_fpif_export_uint(stream, arpra_get_range_method())) return 1;
+    if (arpra_helper_fpif_export_uint(stream, arpra_get_mul_method())) return 1;
+    if (arpra_helper_fpif_export_uint(stream, arpra_get_default_precision())) return 1;
+    if (arpra_helper_fpif_export_uint(stream, arpra_get_internal_precision())) return 1;
+    if (arpra_helper_fpif_export_uint(stream, arpra_get_max_terms())) return 1;
+    if (arpra_helper_fpif_export_uint(stream, arpra_helper_get_symbol_count())) return 1;
+
+    // System state.
+    if (arpra_helper_fpif_export_uint(stream, system->grps)) return 1;
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        if (arpra_helper_fpif_export_uint(stream, system->dims[x_grp])) return 1;
+    }
+    if (arpra_fpif_export(stream, system->t)) return 1;
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            if (arpra_fpif_export(stream, &(system->x[x_grp][x_dim]))) return 1;
+        }
+    }
+    if (arpra_helper_fpif_export_uint(stream, system->n_events)) return 1;
+    for (i = 0; i < system->n_events; i++) {
+        if (arpra_helper_fpif_export_uint(stream, system->events[i].sign + 1)) return 1;
+    }
+
+    // Reduction policy progress.
+    if (arpra_helper_fpif_export_uint(stream, (reduce != NULL) ? reduce->step_count : 0)) return 1;
+    if (arpra_helper_fpif_export_uint(stream, (reduce != NULL) ? reduce->condensed : 0)) return 1;
+
+    // Step method history.
+    if (arpra_helper_fpif_export_uint(stream, method->stages)) return 1;
+    if (arpra_helper_fpif_export_uint(stream, method->order)) return 1;
+    if (arpra_helper_fpif_export_uint(stream, method->error_order)) return 1;
+    if (method->save != NULL) {
+        if (method->save(stepper, stream)) return 1;
+    }
+
+    return 0;
+}
+
+static void checkpoint_init (checkpoint *cp, const arpra_ode_system *system)
+{
+    arpra_uint x_grp, state_size, i;
+
+    for (x_grp = 0, state_size = 0; x_grp < system->grps; x_grp++) {
+        state_size += system->dims[x_grp];
+    }
+    arpra_init(&(cp->t));
+    cp->x = malloc(state_size * sizeof(arpra_range));
+    for (i = 0; i < state_size; i++) {
+        arpra_init(&(cp->x[i]));
+    }
+    cp->sign = malloc(system->n_events * sizeof(int));
+}
+
+static void checkpoint_clear (checkpoint *cp, const arpra_ode_system *system)
+{
+    arpra_uint x_grp, state_size, i;
+
+    for (x_grp = 0, state_size = 0; x_grp < system->grps; x_grp++) {
+        state_size += system->dims[x_grp];
+    }
+    arpra_clear(&(cp->t));
+    for (i = 0; i < state_size; i++) {
+        arpra_clear(&(cp->x[i]));
+    }
+    free(cp->x);
+    free(cp->sign);
+}
+
+static int checkpoint_read (FILE *stream, arpra_ode_stepper *stepper, checkpoint *cp)
+{
+    arpra_uint x_grp, x_dim, i, n, symbol_offset, symbol_count;
+    arpra_ode_system *system;
+    const arpra_ode_method *method;
+    char magic[sizeof(checkpoint_magic)];
+
+    system = stepper->system;
+    method = stepper->method;
+
+    // Configuration.
+    if (fread(magic, 1, sizeof(magic), stream) != sizeof(magic)) return 1;
+    if (memcmp(magic, checkpoint_magic, sizeof(magic)) != 0) return 1;
+    for (i = 0; i < 5; i++) {
+        if (arpra_helper_fpif_import_uint(&(cp->config[i]), stream)) return 1;
+    }
+    if (arpra_helper_fpif_import_uint(&symbol_count, stream)) return 1;
+    symbol_offset = arpra_helper_get_symbol_count();
+    arpra_helper_set_symbol_count(symbol_offset + symbol_count);
+
+    // System state.
+    if (arpra_helper_fpif_import_uint(&n, stream)) return 1;
+    if (n != system->grps) return 1;
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        if (arpra_helper_fpif_import_uint(&n, stream)) return 1;
+        if (n != system->dims[x_grp]) return 1;
+    }
+    if (arpra_helper_fpif_import_shift(&(cp->t), stream, symbol_offset)) return 1;
+    for (x_grp = 0, i = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++, i++) {
+            if (arpra_helper_fpif_import_shift(&(cp->x[i]), stream, symbol_offset)) return 1;
+        }
+    }
+    if (arpra_helper_fpif_import_uint(&n, stream)) return 1;
+    if (n != system->n_events) return 1;
+    for (i = 0; i < system->n_events; i++) {
+        if (arpra_helper_fpif_import_uint(&n, stream)) return 1;
+        if (n > 2) return 1;
+        cp->sign[i] = (int) n - 1;
+    }
+
+    // Reduction policy progress.
+    if (arpra_helper_fpif_import_uint(&(cp->step_count), stream)) return 1;
+    if (arpra_helper_fpif_import_uint(&(cp->condensed), stream)) return 1;
+
+    // Step method history, which is only used once the load succeeds.
+    if (arpra_helper_fpif_import_uint(&n, stream)) return 1;
+    if (n != method->stages) return 1;
+    if (arpra_helper_fpif_import_uint(&n, stream)) return 1;
+    if (n != method->order) return 1;
+    if (arpra_helper_fpif_import_uint(&n, stream)) return 1;
+    if (n != method->error_order) return 1;
+    if (method->load != NULL) {
+        if (method->load(stepper, stream, symbol_offset)) return 1;
+    }
+
+    return 0;
+}
+
+static void checkpoint_commit (arpra_ode_stepper *stepper, checkpoint *cp, int restore_config)
+{
+    arpra_uint x_grp, x_dim, i;
+    arpra_ode_system *system;
+    arpra_ode_reduce *reduce;
+
+    system = stepper->system;
+    reduce = stepper->reduce;
+
+    // Configuration.
+    if (restore_config) {
+        arpra_set_range_method((arpra_range_method) cp->config[0]);
+        arpra_set_mul_method((arpra_mul_method) cp->config[1]);
+        arpra_set_default_precision((arpra_prec) cp->config[2]);
+        arpra_set_internal_precision((arpra_prec) cp->config[3]);
+        arpra_set_max_terms(cp->config[4]);
+    }
+
+    // System state.
+    arpra_swap(system->t, &(cp->t));
+    for (x_grp = 0, i = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++, i++) {
+            arpra_swap(&(system->x[x_grp][x_dim]), &(cp->x[i]));
+        }
+    }
+    arpra_ode_system_precision_changed(system);
+    for (i = 0; i < system->n_events; i++) {
+        system->events[i].sign = cp->sign[i];
+    }
+
+    // Reduction policy progress.
+    if (reduce != NULL) {
+        reduce->step_count = cp->step_count;
+        reduce->condensed = cp->condensed;
+    }
+
+    // Step method history.
+    if (stepper->record != NULL) {
+        arpra_helper_ode_record_set(stepper->record, system);
+    }
+}
+
+int arpra_ode_checkpoint_save (const char *path, arpra_ode_stepper *stepper)
+{
+    FILE *stream;
+    int error;
+
+    stream = fopen(path, "wb");
+    if (stream == NULL) return 1;
+    error = checkpoint_write(stream, stepper);
+    if (fclose(stream) != 0) error = 1;
+
+    return error;
+}
+
+int arpra_ode_checkpoint_load (const char *path, arpra_ode_stepper *stepper, int restore_config)
+{
+    FILE *stream;
+    checkpoint cp;
+    int error;
+
+    stream = fopen(path, "rb");
+    if (stream == NULL) return 1;
+
+    // The method history is discarded, and only used again if loaded in full.
+    arpra_ode_stepper_invalidate(stepper);
+    checkpoint_init(&cp, stepper->system);
+    error = checkpoint_read(stream, stepper, &cp);
+    if (!error) {
+        checkpoint_commit(stepper, &cp, restore_config);
+    }
+    checkpoint_clear(&cp, stepper->system);
+    fclose(stream);
+
+    return error;
+}
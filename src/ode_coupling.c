@@ -0,0 +1,67 @@
+/*
+ * ode_coupling.c -- Sparse coupled sums for ODE systems.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * Each row of a coupling is gathered into an accumulator, so that its sum
+ * gets a single new error symbol, however many sources it has. Rows are
+ * independent, so they are shared between threads.
+ */
+
+void arpra_ode_coupling_sum (arpra_ode_coupling *coupling, const arpra_range **x)
+{
+    arpra_accumulator acc;
+    const arpra_range *x_src;
+    arpra_uint r, k;
+
+    if (coupling->rows == 0) return;
+    x_src = x[coupling->x_grp];
+
+    #pragma omp parallel private(acc, r, k)
+    {
+        arpra_accumulator_init(&acc, arpra_get_precision(&(coupling->sum[0])));
+
+        #pragma omp for schedule(dynamic, 64)
+        for (r = 0; r < coupling->rows; r++) {
+            for (k = coupling->row[r]; k < coupling->row[r + 1]; k++) {
+                if (coupling->weight == NULL) {
+                    arpra_accumulator_add(&acc, &(x_src[coupling->col[k]]));
+                }
+                else {
+                    arpra_accumulator_add_product(&acc, &(coupling->weight[k]), &(x_src[coupling->col[k]]));
+                }
+            }
+            arpra_accumulator_finalise(&(coupling->sum[r]), &acc);
+        }
+
+        arpra_accumulator_clear(&acc);
+    }
+}
+
+void arpra_helper_ode_couple (arpra_ode_system *system, const arpra_range **x)
+{
+    arpra_uint i;
+
+    for (i = 0; i < system->n_coupling; i++) {
+        arpra_ode_coupling_sum(&(system->coupling[i]), x);
+    }
+}
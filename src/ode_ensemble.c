@@ -0,0 +1,66 @@
+/*
+ * ode_ensemble.c -- Step an ensemble of independent ODE systems in parallel.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * Each system of the ensemble is advanced n_steps steps of size h by its
+ * own stepper. Systems are handed out to threads one at a time, so that
+ * systems which take longer to step do not hold up the others. The step
+ * size and the reduction policy are read-only, and shared by all systems.
+ *
+ * If progress is not NULL, it is called after each step of each system.
+ * Calls are serialised, so progress need not be thread-safe.
+ */
+
+void arpra_ode_ensemble_run (arpra_ode_system *systems, arpra_uint n_systems,
+                             const arpra_ode_method *method, const arpra_range *h,
+                             arpra_uint n_steps, const arpra_ode_reduce *reduce,
+                             arpra_ode_progress progress, void *data)
+{
+    arpra_uint i, step;
+    arpra_ode_stepper stepper;
+    arpra_ode_reduce member_reduce;
+
+    #pragma omp parallel for schedule(dynamic, 1) private(step, stepper, member_reduce)
+    for (i = 0; i < n_systems; i++) {
+        arpra_ode_stepper_init(&stepper, &(systems[i]), method);
+
+        // Each system counts its own steps and condensed terms.
+        if (reduce != NULL) {
+            member_reduce = *reduce;
+            member_reduce.step_count = 0;
+            member_reduce.condensed = 0;
+            arpra_ode_stepper_set_reduce(&stepper, &member_reduce);
+        }
+
+        for (step = 0; step < n_steps; step++) {
+            arpra_ode_stepper_step(&stepper, h);
+
+            if (progress != NULL) {
+                #pragma omp critical (arpra_ode_ensemble_progress)
+                progress(data, i, step + 1, n_steps);
+            }
+        }
+
+        arpra_ode_stepper_clear(&stepper);
+    }
+}
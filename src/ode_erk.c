@@ -0,0 +1,728 @@
+/*
+ * ode_erk.c -- Tableau-driven explicit Runge-Kutta ODE stepper.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * A single stepper for every explicit Runge-Kutta method. The method is
+ * given by its Butcher tableau, whose constants are computed once per
+ * internal precision and shared by all steppers of that method.
+ *
+ * Stage states and solutions are fused sums, which skip zero coefficients.
+ * The error estimate is the sum of (b_i - b_err_i) h k[i], rather than the
+ * difference of two solutions. If the last stage is f(t + h, x(t + h)), it
+ * is carried over as the first stage of the next step. Dense output uses
+ * the tableau's interpolating polynomial, if given, or cubic Hermite
+ * interpolation otherwise. The latter is 3rd order whatever the order of
+ * the method, so the dense output of high order methods without their own
+ * polynomial, such as dopri87, is less accurate than their steps.
+ */
+
+typedef struct erk_constants_struct
+{
+    arpra_uint stages;
+    arpra_range *_a;
+    arpra_range **a;
+    arpra_range *b;
+    arpra_range *e;
+    arpra_range *c;
+    arpra_range *d;
+} erk_constants;
+
+typedef struct erk_scratch_struct
+{
+    const arpra_ode_erk *erk;
+    const erk_constants *constants;
+    arpra_range **_k;
+    arpra_range ***k;
+    arpra_range *_x_new;
+    arpra_range **x_new;
+    arpra_range *_error;
+    arpra_range **error;
+    arpra_range *_f_new;
+    arpra_range **f_new;
+    arpra_range *_ah;
+    arpra_range **ah;
+    arpra_range *bh;
+    arpra_range *eh;
+    arpra_range *ch;
+    arpra_range h;
+    arpra_prec h_prec;
+    arpra_range *temp_t;
+    arpra_range t_new;
+    arpra_ode_sync sync;
+    int fsal;
+    int dense;
+} erk_scratch;
+
+static void erk_fraction (arpra_range *y, const double *q, const arpra_prec prec)
+{
+    arpra_range numerator, denominator;
+
+    arpra_init2(y, prec);
+
+    // Zeros and integers are exact.
+    if (q[0] == 0.) {
+        arpra_set_zero(y);
+        return;
+    }
+    if (q[1] == 1.) {
+        arpra_set_d(y, q[0]);
+        return;
+    }
+
+    arpra_init2(&numerator, prec);
+    arpra_init2(&denominator, prec);
+    arpra_set_d(&numerator, q[0]);
+    arpra_set_d(&denominator, q[1]);
+    arpra_div(y, &numerator, &denominator);
+    arpra_clear(&numerator);
+    arpra_clear(&denominator);
+}
+
+static void *erk_constants_build (const void *key, const arpra_prec prec)
+{
+    arpra_uint k_i, n_a;
+    const arpra_ode_erk *erk;
+    erk_constants *constants;
+
+    erk = (const arpra_ode_erk *) key;
+    n_a = (erk->stages * (erk->stages - 1)) / 2;
+
+    // Allocate constant memory.
+    constants = malloc(sizeof(erk_constants));
+    constants->stages = erk->stages;
+    constants->_a = malloc(n_a * sizeof(arpra_range));
+    constants->a = malloc(erk->stages * sizeof(arpra_range *));
+    constants->b = malloc(erk->stages * sizeof(arpra_range));
+    constants->e = (erk->b_err != NULL) ? malloc(erk->stages * sizeof(arpra_range)) : NULL;
+    constants->c = malloc(erk->stages * sizeof(arpra_range));
+    constants->d = (erk->d != NULL) ? malloc(4 * erk->stages * sizeof(arpra_range)) : NULL;
+
+    // Compute constants.
+    for (k_i = 0; k_i < n_a; k_i++) {
+        erk_fraction(&(constants->_a[k_i]), erk->a[k_i], prec);
+    }
+    for (k_i = 0; k_i < erk->stages; k_i++) {
+        constants->a[k_i] = &(constants->_a[(k_i * (k_i - 1)) / 2]);
+        erk_fraction(&(constants->b[k_i]), erk->b[k_i], prec);
+        erk_fraction(&(constants->c[k_i]), erk->c[k_i], prec);
+    }
+    if (constants->e != NULL) {
+        for (k_i = 0; k_i < erk->stages; k_i++) {
+            // e_i = b_i - b_err_i, exactly zero if the weights are equal.
+            erk_fraction(&(constants->e[k_i]), erk->b_err[k_i], prec);
+            if ((erk->b[k_i][0] == erk->b_err[k_i][0]) && (erk->b[k_i][1] == erk->b_err[k_i][1])) {
+                arpra_set_zero(&(constants->e[k_i]));
+            }
+            else {
+                arpra_sub(&(constants->e[k_i]), &(constants->b[k_i]), &(constants->e[k_i]));
+            }
+        }
+    }
+    if (constants->d != NULL) {
+        for (k_i = 0; k_i < (4 * erk->stages); k_i++) {
+            erk_fraction(&(constants->d[k_i]), erk->d[k_i], prec);
+        }
+    }
+
+    return constants;
+}
+
+static void erk_constants_clear (void *data)
+{
+    arpra_uint k_i, n_a;
+    erk_constants *constants;
+
+    constants = (erk_constants *) data;
+    n_a = (constants->stages * (constants->stages - 1)) / 2;
+
+    // Clear constant memory.
+    for (k_i = 0; k_i < n_a; k_i++) {
+        arpra_clear(&(constants->_a[k_i]));
+    }
+    for (k_i = 0; k_i < constants->stages; k_i++) {
+        arpra_clear(&(constants->b[k_i]));
+        arpra_clear(&(constants->c[k_i]));
+        if (constants->e != NULL) {
+            arpra_clear(&(constants->e[k_i]));
+        }
+    }
+    if (constants->d != NULL) {
+        for (k_i = 0; k_i < (4 * constants->stages); k_i++) {
+            arpra_clear(&(constants->d[k_i]));
+        }
+    }
+
+    // Free constant memory.
+    free(constants->_a);
+    free(constants->a);
+    free(constants->b);
+    free(constants->e);
+    free(constants->c);
+    free(constants->d);
+    free(constants);
+}
+
+static arpra_range **erk_state_init (const arpra_ode_system *system, arpra_range **_x)
+{
+    arpra_uint x_grp, x_dim, state_size;
+    arpra_range **x;
+
+    // Allocate one range per state variable, at the precision of that variable.
+    for (x_grp = 0, state_size = 0; x_grp < system->grps; x_grp++) {
+        state_size += system->dims[x_grp];
+    }
+    *_x = malloc(state_size * sizeof(arpra_range));
+    x = malloc(system->grps * sizeof(arpra_range *));
+    x[0] = *_x;
+    for (x_grp = 1; x_grp < system->grps; x_grp++) {
+        x[x_grp] = x[x_grp - 1] + system->dims[x_grp - 1];
+    }
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            arpra_init2(&(x[x_grp][x_dim]), arpra_get_precision(&(system->x[x_grp][x_dim])));
+        }
+    }
+
+    return x;
+}
+
+static void erk_state_clear (const arpra_ode_system *system, arpra_range *_x, arpra_range **x)
+{
+    arpra_uint x_grp, x_dim;
+
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            arpra_clear(&(x[x_grp][x_dim]));
+        }
+    }
+    free(_x);
+    free(x);
+}
+
+static void erk_state_sync (const arpra_ode_system *system, arpra_range **x)
+{
+    arpra_uint x_grp, x_dim;
+
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            arpra_set_precision(&(x[x_grp][x_dim]), arpra_get_precision(&(system->x[x_grp][x_dim])));
+        }
+    }
+}
+
+static int erk_fsal_valid (const arpra_ode_stepper *stepper)
+{
+    const erk_scratch *scratch;
+
+    scratch = (const erk_scratch *) stepper->scratch;
+
+    // Reuse is only valid if the state is exactly the one recorded after the last step.
+    return scratch->fsal && arpra_helper_ode_record_equal_p(stepper->record, stepper->system);
+}
+
+static void erk_fsal_swap (erk_scratch *scratch)
+{
+    arpra_uint k_s;
+    arpra_range *_k, **k;
+
+    // Exchange the first and last stages.
+    k_s = scratch->erk->stages - 1;
+    _k = scratch->_k[0];
+    scratch->_k[0] = scratch->_k[k_s];
+    scratch->_k[k_s] = _k;
+    k = scratch->k[0];
+    scratch->k[0] = scratch->k[k_s];
+    scratch->k[k_s] = k;
+}
+
+static int erk_cache_valid (const erk_scratch *scratch, const arpra_range *h,
+                            const arpra_prec prec_t)
+{
+    // Scaled coefficients are reused while h, deviation terms included, and
+    // the precision of t are unchanged, so h may also be updated in place.
+    return (scratch->h_prec == prec_t)
+        && arpra_helper_ode_equal_exact_p(h, &(scratch->h));
+}
+
+static void erk_cache_record (erk_scratch *scratch, const arpra_range *h,
+                              const arpra_prec prec_t)
+{
+    scratch->h_prec = prec_t;
+    arpra_helper_ode_copy_exact(&(scratch->h), h);
+}
+
+void arpra_helper_ode_erk_init (arpra_ode_stepper *stepper, arpra_ode_system *system,
+                                const arpra_ode_method *method, const arpra_ode_erk *erk)
+{
+    arpra_uint k_i, n_a, i;
+    arpra_prec prec_internal;
+    erk_scratch *scratch;
+
+    // Allocate scratch memory.
+    scratch = malloc(sizeof(erk_scratch));
+    n_a = (erk->stages * (erk->stages - 1)) / 2;
+    scratch->_k = malloc(erk->stages * sizeof(arpra_range *));
+    scratch->k = malloc(erk->stages * sizeof(arpra_range **));
+    scratch->_ah = malloc(n_a * sizeof(arpra_range));
+    scratch->ah = malloc(erk->stages * sizeof(arpra_range *));
+    scratch->bh = malloc(erk->stages * sizeof(arpra_range));
+    scratch->eh = malloc(erk->stages * sizeof(arpra_range));
+    scratch->ch = malloc(erk->stages * sizeof(arpra_range));
+    scratch->temp_t = malloc(erk->stages * sizeof(arpra_range));
+
+    // Initialise scratch memory.
+    prec_internal = arpra_get_internal_precision();
+    for (k_i = 0; k_i < erk->stages; k_i++) {
+        scratch->k[k_i] = erk_state_init(system, &(scratch->_k[k_i]));
+    }
+    scratch->x_new = erk_state_init(system, &(scratch->_x_new));
+    scratch->error = (erk->b_err != NULL) ? erk_state_init(system, &(scratch->_error)) : NULL;
+    scratch->f_new = (!erk->fsal) ? erk_state_init(system, &(scratch->_f_new)) : NULL;
+    for (i = 0; i < n_a; i++) {
+        arpra_init2(&(scratch->_ah[i]), prec_internal);
+    }
+    for (k_i = 0; k_i < erk->stages; k_i++) {
+        scratch->ah[k_i] = &(scratch->_ah[(k_i * (k_i - 1)) / 2]);
+        arpra_init2(&(scratch->bh[k_i]), prec_internal);
+        arpra_init2(&(scratch->eh[k_i]), prec_internal);
+        arpra_init2(&(scratch->ch[k_i]), prec_internal);
+        arpra_init2(&(scratch->temp_t[k_i]), prec_internal);
+    }
+    arpra_init2(&(scratch->t_new), prec_internal);
+    arpra_init2(&(scratch->h), prec_internal);
+    scratch->h_prec = 0;
+    arpra_helper_ode_sync_init(&(scratch->sync));
+    scratch->fsal = 0;
+    scratch->dense = 0;
+
+    // Bind the shared constants.
+    scratch->erk = erk;
+    scratch->constants = arpra_helper_ode_tableau(erk, prec_internal,
+                                                  &erk_constants_build, &erk_constants_clear);
+
+    // Set stepper parameters.
+    stepper->method = method;
+    stepper->system = system;
+    stepper->error = scratch->error;
+    stepper->scratch = scratch;
+}
+
+void arpra_helper_ode_erk_clear (arpra_ode_stepper *stepper)
+{
+    arpra_uint k_i, n_a, i;
+    arpra_ode_system *system;
+    const arpra_ode_erk *erk;
+    erk_scratch *scratch;
+
+    system = stepper->system;
+    scratch = (erk_scratch *) stepper->scratch;
+    erk = scratch->erk;
+
+    // Clear scratch memory.
+    n_a = (erk->stages * (erk->stages - 1)) / 2;
+    for (k_i = 0; k_i < erk->stages; k_i++) {
+        erk_state_clear(system, scratch->_k[k_i], scratch->k[k_i]);
+    }
+    erk_state_clear(system, scratch->_x_new, scratch->x_new);
+    if (scratch->error != NULL) {
+        erk_state_clear(system, scratch->_error, scratch->error);
+    }
+    if (scratch->f_new != NULL) {
+        erk_state_clear(system, scratch->_f_new, scratch->f_new);
+    }
+    for (i = 0; i < n_a; i++) {
+        arpra_clear(&(scratch->_ah[i]));
+    }
+    for (k_i = 0; k_i < erk->stages; k_i++) {
+        arpra_clear(&(scratch->bh[k_i]));
+        arpra_clear(&(scratch->eh[k_i]));
+        arpra_clear(&(scratch->ch[k_i]));
+        arpra_clear(&(scratch->temp_t[k_i]));
+    }
+    arpra_clear(&(scratch->t_new));
+    arpra_clear(&(scratch->h));
+
+    // Free scratch memory.
+    free(scratch->_k);
+    free(scratch->k);
+    free(scratch->_ah);
+    free(scratch->ah);
+    free(scratch->bh);
+    free(scratch->eh);
+    free(scratch->ch);
+    free(scratch->temp_t);
+    free(scratch);
+}
+
+void arpra_helper_ode_erk_step (arpra_ode_stepper *stepper, const arpra_range *h)
+{
+    arpra_uint x_grp, x_dim, k_i, k_j;
+    arpra_prec prec_t;
+    arpra_ode_system *system;
+    const arpra_ode_erk *erk;
+    const erk_constants *constants;
+    erk_scratch *scratch;
+    int fsal;
+
+    system = stepper->system;
+    scratch = (erk_scratch *) stepper->scratch;
+    erk = scratch->erk;
+    constants = scratch->constants;
+
+    // Check if k[0] can be carried over from the last step.
+    fsal = erk->fsal && erk_fsal_valid(stepper);
+
+    // Synchronise scratch precision if it has changed, and prepare step parameters.
+    prec_t = arpra_get_precision(system->t);
+    if (arpra_helper_ode_sync_stale(&(scratch->sync), system)) {
+        for (k_i = (fsal ? 1 : 0); k_i < erk->stages; k_i++) {
+            erk_state_sync(system, scratch->k[k_i]);
+        }
+        erk_state_sync(system, scratch->x_new);
+        if (scratch->error != NULL) {
+            erk_state_sync(system, scratch->error);
+        }
+        arpra_set_precision(&(scratch->t_new), prec_t);
+        for (k_i = 0; k_i < erk->stages; k_i++) {
+            arpra_set_precision(&(scratch->temp_t[k_i]), prec_t);
+        }
+    }
+    if (!erk_cache_valid(scratch, h, prec_t)) {
+        for (k_i = 0; k_i < erk->stages; k_i++) {
+            for (k_j = 0; k_j < k_i; k_j++) {
+                arpra_set_precision(&(scratch->ah[k_i][k_j]), prec_t);
+                arpra_mul(&(scratch->ah[k_i][k_j]), &(constants->a[k_i][k_j]), h);
+            }
+            arpra_set_precision(&(scratch->bh[k_i]), prec_t);
+            arpra_mul(&(scratch->bh[k_i]), &(constants->b[k_i]), h);
+            if (constants->e != NULL) {
+                arpra_set_precision(&(scratch->eh[k_i]), prec_t);
+                arpra_mul(&(scratch->eh[k_i]), &(constants->e[k_i]), h);
+            }
+            arpra_set_precision(&(scratch->ch[k_i]), prec_t);
+            arpra_mul(&(scratch->ch[k_i]), &(constants->c[k_i]), h);
+        }
+        erk_cache_record(scratch, h, prec_t);
+    }
+    for (k_i = 0; k_i < erk->stages; k_i++) {
+        arpra_add(&(scratch->temp_t[k_i]), system->t, &(scratch->ch[k_i]));
+    }
+
+    // Compute k stages.
+    arpra_helper_ode_stages(stepper, scratch->k, scratch->x_new, scratch->ah, scratch->temp_t,
+                            erk->stages, (fsal ? 1 : 0));
+
+    // x(t + h) = x(t) + b_0 h k[0] + ... + b_s h k[s]
+    // If the last stage is first-same-as-last, its state is already x(t + h).
+    if (!erk->fsal) {
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+                arpra_helper_ode_combine(&(scratch->x_new[x_grp][x_dim]), &(system->x[x_grp][x_dim]),
+                                         scratch->k, scratch->bh, erk->stages, x_grp, x_dim);
+            }
+        }
+    }
+
+    // Estimate local truncation error.
+    // error = (b_0 - b_err_0) h k[0] + ... + (b_s - b_err_s) h k[s]
+    if (scratch->error != NULL) {
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+                arpra_helper_ode_combine(&(scratch->error[x_grp][x_dim]), NULL,
+                                         scratch->k, scratch->eh, erk->stages, x_grp, x_dim);
+            }
+        }
+    }
+
+    // Advance system, keeping the old state in scratch memory.
+    arpra_add(&(scratch->t_new), system->t, h);
+    arpra_swap(system->t, &(scratch->t_new));
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            arpra_swap(&(system->x[x_grp][x_dim]), &(scratch->x_new[x_grp][x_dim]));
+        }
+    }
+
+    // The last stage is f(t + h, x(t + h)), so it is the next step's first stage.
+    if (erk->fsal) {
+        erk_fsal_swap(scratch);
+        scratch->fsal = 1;
+    }
+    scratch->dense = 1;
+}
+
+void arpra_helper_ode_erk_reject (arpra_ode_stepper *stepper)
+{
+    arpra_uint x_grp, x_dim;
+    arpra_ode_system *system;
+    erk_scratch *scratch;
+
+    system = stepper->system;
+    scratch = (erk_scratch *) stepper->scratch;
+
+    // Restore the state from before the last step.
+    arpra_swap(system->t, &(scratch->t_new));
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            arpra_swap(&(system->x[x_grp][x_dim]), &(scratch->x_new[x_grp][x_dim]));
+        }
+    }
+
+    // The first stage of the rejected step is still valid.
+    if (scratch->erk->fsal) {
+        erk_fsal_swap(scratch);
+        scratch->fsal = 1;
+    }
+    scratch->dense = 0;
+}
+
+void arpra_helper_ode_erk_invalidate (arpra_ode_stepper *stepper)
+{
+    erk_scratch *scratch;
+
+    scratch = (erk_scratch *) stepper->scratch;
+    scratch->fsal = 0;
+}
+
+int arpra_helper_ode_erk_save (arpra_ode_stepper *stepper, FILE *stream)
+{
+    arpra_uint x_grp, x_dim, fsal;
+    arpra_ode_system *system;
+    erk_scratch *scratch;
+
+    system = stepper->system;
+    scratch = (erk_scratch *) stepper->scratch;
+
+    // Only a carried over first stage outlives the step.
+    fsal = scratch->erk->fsal && erk_fsal_valid(stepper);
+    if (arpra_helper_fpif_export_uint(stream, fsal)) return 1;
+    if (fsal) {
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+                if (arpra_fpif_export(stream, &(scratch->k[0][x_grp][x_dim]))) return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int arpra_helper_ode_erk_load (arpra_ode_stepper *stepper, FILE *stream, arpra_uint symbol_offset)
+{
+    arpra_uint x_grp, x_dim, fsal;
+    arpra_ode_system *system;
+    erk_scratch *scratch;
+
+    system = stepper->system;
+    scratch = (erk_scratch *) stepper->scratch;
+    scratch->fsal = 0;
+    scratch->dense = 0;
+
+    if (arpra_helper_fpif_import_uint(&fsal, stream)) return 1;
+    if (fsal) {
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+                if (arpra_helper_fpif_import_shift(&(scratch->k[0][x_grp][x_dim]), stream,
+                                                   symbol_offset)) return 1;
+            }
+        }
+        if (scratch->erk->fsal) {
+            scratch->fsal = 1;
+        }
+    }
+
+    return 0;
+}
+
+static void erk_interpolate_dense (arpra_ode_stepper *stepper, arpra_range **x,
+                                   const arpra_range *theta, const arpra_range *dt)
+{
+    arpra_uint x_grp, x_dim, k_i, k_j, k_s;
+    arpra_range *w, ***k_w;
+    arpra_ode_system *system;
+    const arpra_ode_erk *erk;
+    erk_scratch *scratch;
+
+    system = stepper->system;
+    scratch = (erk_scratch *) stepper->scratch;
+    erk = scratch->erk;
+
+    // Init temp vars.
+    w = malloc(erk->stages * sizeof(arpra_range));
+    k_w = malloc(erk->stages * sizeof(arpra_range **));
+    for (k_i = 0; k_i < erk->stages; k_i++) {
+        arpra_init2(&(w[k_i]), arpra_get_precision(theta));
+    }
+
+    // w_i = theta h (d_i0 + d_i1 theta + d_i2 theta^2 + d_i3 theta^3)
+    for (k_i = 0; k_i < erk->stages; k_i++) {
+        arpra_set(&(w[k_i]), &(scratch->constants->d[(4 * k_i) + 3]));
+        for (k_j = 3; k_j-- > 0;) {
+            arpra_mul(&(w[k_i]), &(w[k_i]), theta);
+            arpra_add(&(w[k_i]), &(w[k_i]), &(scratch->constants->d[(4 * k_i) + k_j]));
+        }
+        arpra_mul(&(w[k_i]), &(w[k_i]), dt);
+    }
+
+    // The first and last stages were exchanged at the end of a first-same-as-last step.
+    for (k_i = 0; k_i < erk->stages; k_i++) {
+        k_s = (!erk->fsal) ? k_i :
+            (k_i == 0) ? erk->stages - 1 : (k_i == erk->stages - 1) ? 0 : k_i;
+        k_w[k_i] = scratch->k[k_s];
+    }
+
+    // x(t_old + theta h) = x(t_old) + w_0 k[0] + ... + w_s k[s]
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            arpra_helper_ode_combine(&(x[x_grp][x_dim]), &(scratch->x_new[x_grp][x_dim]),
+                                     k_w, w, erk->stages, x_grp, x_dim);
+        }
+    }
+
+    // Clear temp vars.
+    for (k_i = 0; k_i < erk->stages; k_i++) {
+        arpra_clear(&(w[k_i]));
+    }
+    free(w);
+    free(k_w);
+}
+
+static void erk_interpolate_hermite (arpra_ode_stepper *stepper, arpra_range **x,
+                                     const arpra_range *theta, const arpra_range *dt)
+{
+    arpra_uint x_grp, x_dim;
+    arpra_prec prec_t, prec_x;
+    arpra_range alpha, beta, gamma, temp, **f_old, **f_new;
+    arpra_ode_system *system;
+    const arpra_ode_erk *erk;
+    erk_scratch *scratch;
+
+    system = stepper->system;
+    scratch = (erk_scratch *) stepper->scratch;
+    erk = scratch->erk;
+
+    // f_new = f(t + h, x(t + h)), which is either carried over, or computed once per step.
+    if (erk->fsal) {
+        f_old = scratch->k[erk->stages - 1];
+        f_new = scratch->k[0];
+    }
+    else {
+        f_old = scratch->k[0];
+        f_new = scratch->f_new;
+        if (scratch->dense == 1) {
+            erk_state_sync(system, scratch->f_new);
+            arpra_helper_ode_eval(stepper, scratch->f_new, system->t, (const arpra_range **) system->x);
+            scratch->dense = 2;
+        }
+    }
+
+    // Init temp vars.
+    prec_t = arpra_get_precision(theta);
+    arpra_init2(&alpha, prec_t);
+    arpra_init2(&beta, prec_t);
+    arpra_init2(&gamma, prec_t);
+    arpra_init2(&temp, prec_t);
+
+    // Cubic Hermite weights:
+    // alpha = theta^2 (3 - 2 theta)
+    // beta  = (t - t_old) (theta - 1)^2
+    // gamma = (t - t_old) theta (theta - 1)
+    arpra_set_d(&temp, 1.);
+    arpra_sub(&gamma, theta, &temp);
+    arpra_mul(&beta, &gamma, &gamma);
+    arpra_mul(&beta, &beta, dt);
+    arpra_mul(&gamma, &gamma, dt);
+    arpra_mul(&gamma, &gamma, theta);
+    arpra_set_d(&temp, 3.);
+    arpra_sub(&alpha, &temp, theta);
+    arpra_sub(&alpha, &alpha, theta);
+    arpra_mul(&alpha, &alpha, theta);
+    arpra_mul(&alpha, &alpha, theta);
+
+    // x(t_old + theta h) = x_old + alpha (x_new - x_old) + beta f_old + gamma f_new
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            prec_x = arpra_get_precision(&(x[x_grp][x_dim]));
+            arpra_set_precision(&temp, prec_x);
+            arpra_sub(&temp, &(system->x[x_grp][x_dim]), &(scratch->x_new[x_grp][x_dim]));
+            arpra_mul(&temp, &alpha, &temp);
+            arpra_add(&(x[x_grp][x_dim]), &(scratch->x_new[x_grp][x_dim]), &temp);
+            arpra_mul(&temp, &beta, &(f_old[x_grp][x_dim]));
+            arpra_add(&(x[x_grp][x_dim]), &(x[x_grp][x_dim]), &temp);
+            arpra_mul(&temp, &gamma, &(f_new[x_grp][x_dim]));
+            arpra_add(&(x[x_grp][x_dim]), &(x[x_grp][x_dim]), &temp);
+        }
+    }
+
+    // Clear temp vars.
+    arpra_clear(&alpha);
+    arpra_clear(&beta);
+    arpra_clear(&gamma);
+    arpra_clear(&temp);
+}
+
+void arpra_helper_ode_erk_interpolate (arpra_ode_stepper *stepper, arpra_range **x,
+                                       const arpra_range *t)
+{
+    arpra_uint x_grp, x_dim;
+    arpra_prec prec_t;
+    arpra_range theta, dt, temp;
+    arpra_ode_system *system;
+    erk_scratch *scratch;
+
+    system = stepper->system;
+    scratch = (erk_scratch *) stepper->scratch;
+
+    // Without a completed step, the current state is returned.
+    if (!scratch->dense) {
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+                arpra_set(&(x[x_grp][x_dim]), &(system->x[x_grp][x_dim]));
+            }
+        }
+        return;
+    }
+
+    // Init temp vars.
+    prec_t = arpra_get_precision(system->t);
+    arpra_init2(&theta, prec_t);
+    arpra_init2(&dt, prec_t);
+    arpra_init2(&temp, prec_t);
+
+    // theta = (t - t_old) / (t_new - t_old)
+    arpra_sub(&dt, t, &(scratch->t_new));
+    arpra_sub(&temp, system->t, &(scratch->t_new));
+    arpra_div(&theta, &dt, &temp);
+
+    if (scratch->erk->d != NULL) {
+        erk_interpolate_dense(stepper, x, &theta, &dt);
+    }
+    else {
+        erk_interpolate_hermite(stepper, x, &theta, &dt);
+    }
+
+    // Clear temp vars.
+    arpra_clear(&theta);
+    arpra_clear(&dt);
+    arpra_clear(&temp);
+}
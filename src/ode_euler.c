@@ -30,6 +30,7 @@ typedef struct euler_scratch_struct
     arpra_range *_x_new;
     arpra_range **x_new;
     arpra_range temp_x;
+    arpra_ode_sync sync;
 } euler_scratch;
 
 static void euler_init (arpra_ode_stepper *stepper, arpra_ode_system *system)
@@ -64,6 +65,7 @@ static void euler_init (arpra_ode_stepper *stepper, arpra_ode_system *system)
         }
     }
     arpra_init2(&(scratch->temp_x), prec_internal);
+    arpra_helper_ode_sync_init(&(scratch->sync));
 
     // Set stepper parameters.
     stepper->method = arpra_ode_euler;
@@ -108,22 +110,19 @@ static void euler_step (arpra_ode_stepper *stepper, const arpra_range *h)
     system = stepper->system;
     scratch = (euler_scratch *) stepper->scratch;
 
-    // Synchronise scratch precision and prepare step parameters.
-    for (x_grp = 0; x_grp < system->grps; x_grp++) {
-        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
-            prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
-            arpra_set_precision(&(scratch->k_0[x_grp][x_dim]), prec_x);
-            arpra_set_precision(&(scratch->x_new[x_grp][x_dim]), prec_x);
+    // Synchronise scratch precision if it has changed.
+    if (arpra_helper_ode_sync_stale(&(scratch->sync), system)) {
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+                prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
+                arpra_set_precision(&(scratch->k_0[x_grp][x_dim]), prec_x);
+                arpra_set_precision(&(scratch->x_new[x_grp][x_dim]), prec_x);
+            }
         }
     }
 
     // k[0] = f(t, x(t))
-    for (x_grp = 0; x_grp < system->grps; x_grp++) {
-        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
-            system->f[x_grp](&(scratch->k_0[x_grp][x_dim]), system->params[x_grp],
-                             system->t, (const arpra_range **) system->x, x_grp, x_dim);
-        }
-    }
+    arpra_helper_ode_eval(stepper, scratch->k_0, system->t, (const arpra_range **) system->x);
 
     // x(t + h) = x(t) + h k[0]
     for (x_grp = 0; x_grp < system->grps; x_grp++) {
@@ -149,7 +148,14 @@ static const arpra_ode_method euler =
     .init = &euler_init,
     .clear = &euler_clear,
     .step = &euler_step,
+    .reject = NULL,
+    .invalidate = NULL,
+    .interpolate = NULL,
+    .save = NULL,
+    .load = NULL,
     .stages = euler_stages,
+    .order = 1,
+    .error_order = 0,
 };
 
 const arpra_ode_method *arpra_ode_euler = &euler;
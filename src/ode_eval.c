@@ -0,0 +1,65 @@
+/*
+ * ode_eval.c -- Evaluate the right-hand side of an ODE system.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * dxdt = f(t, x)
+ *
+ * Coupled sums are gathered from x first. Then each group is evaluated
+ * either by its group callback, in one call with the stepper's scratch
+ * ranges for that group, or by one call of f per state variable.
+ */
+
+void arpra_helper_ode_eval_grp (arpra_ode_stepper *stepper, arpra_range *dxdt,
+                                const arpra_range *t, const arpra_range **x, arpra_uint x_grp)
+{
+    arpra_uint x_dim;
+    arpra_ode_system *system;
+
+    system = stepper->system;
+
+    if ((system->f_grp != NULL) && (system->f_grp[x_grp] != NULL)) {
+        system->f_grp[x_grp](dxdt, system->params[x_grp],
+                             ((stepper->temp != NULL) ? stepper->temp[x_grp] : NULL),
+                             t, x, x_grp, system->dims[x_grp]);
+    }
+    else {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            system->f[x_grp](&(dxdt[x_dim]), system->params[x_grp],
+                             t, x, x_grp, x_dim);
+        }
+    }
+}
+
+void arpra_helper_ode_eval (arpra_ode_stepper *stepper, arpra_range **dxdt,
+                            const arpra_range *t, const arpra_range **x)
+{
+    arpra_uint x_grp;
+    arpra_ode_system *system;
+
+    system = stepper->system;
+    arpra_helper_ode_couple(system, x);
+
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        arpra_helper_ode_eval_grp(stepper, dxdt[x_grp], t, x, x_grp);
+    }
+}
@@ -0,0 +1,303 @@
+/*
+ * ode_event.c -- Step an ODE system with event detection.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * Events are detected on ranges, so that crossings of the trajectories in
+ * the state's enclosure are not missed, up to the truncation error of the
+ * dense output. An event is armed on the side of zero on
+ * which the range of g lies, and disarmed while the range of g contains
+ * zero. After each step, an armed event whose direction leads away from its
+ * side occurs if the range of g on the dense output of the step does not
+ * exclude zero. Its crossing time is then enclosed by searching the step
+ * with time intervals, which are halved while g may be zero on them, and
+ * doubled again once g is not:
+ *
+ * - t_lo is the first point at which g may leave the old side of zero,
+ *   and
+ * - t_hi is the last point at which g may not yet be on the new side of
+ *   zero, or the end of the step if g does not end on a side.
+ *
+ * [t_lo, t_hi] is the hull of every time in the step at which g may be
+ * zero, so it may also cover spurious or double crossings. The step is then
+ * cut back to the earliest event, whose state is the dense output over
+ * [t_lo, t_hi], and its discrete update is applied. The event stays
+ * disarmed until the range of g excludes zero again, so it occurs at most
+ * once in each stretch where the range of g contains zero.
+ */
+
+static int event_side (const arpra_range *g)
+{
+    // 1 if g > 0 everywhere, -1 if g < 0 everywhere, and 0 otherwise.
+    if (arpra_has_zero_p(g) || arpra_nan_p(g)) return 0;
+    return arpra_has_pos_p(g) ? 1 : -1;
+}
+
+static void event_time (arpra_range *t, const arpra_range *t_step, mpfr_srcptr a, mpfr_srcptr b)
+{
+    mpfi_t dt;
+
+    // t = t_step + [a, b] - mid(t_step), so that t stays correlated with t_step.
+    mpfi_init2(dt, arpra_get_precision(t));
+    mpfi_interv_fr(dt, a, b);
+    mpfi_sub_fr(dt, dt, &(t_step->centre));
+    arpra_set_mpfi(t, dt);
+    arpra_add(t, t, t_step);
+    mpfi_clear(dt);
+}
+
+static int event_eval (arpra_ode_stepper *stepper, arpra_ode_event *event, arpra_range *g,
+                       arpra_range **x_mid, arpra_range *t_mid, mpfr_srcptr a, mpfr_srcptr b)
+{
+    // g(t, x(t)) for t in [a, b], using the dense output of the last step.
+    event_time(t_mid, stepper->system->t, a, b);
+    arpra_ode_stepper_interpolate(stepper, x_mid, t_mid);
+    event->g(g, event->params, t_mid, (const arpra_range **) x_mid);
+
+    return event_side(g);
+}
+
+static int event_search (arpra_ode_stepper *stepper, arpra_ode_event *event, int side, int forward,
+                         mpfr_ptr t_lo, mpfr_ptr t_hi, arpra_range **x_mid)
+{
+    arpra_uint depth;
+    arpra_prec prec_t;
+    arpra_range g, t_mid;
+    mpfr_t w, w_0, a, b;
+    int found;
+
+    // Init temp vars.
+    prec_t = mpfr_get_prec(t_lo);
+    arpra_init2(&g, arpra_get_precision(stepper->system->t));
+    arpra_init2(&t_mid, arpra_get_precision(stepper->system->t));
+    mpfr_init2(w, prec_t);
+    mpfr_init2(w_0, prec_t);
+    mpfr_init2(a, prec_t);
+    mpfr_init2(b, prec_t);
+
+    // Walk from one end of [t_lo, t_hi], doubling the interval after each one
+    // on which g is entirely on the given side, and halving it otherwise.
+    mpfr_sub(w_0, t_hi, t_lo, MPFR_RNDU);
+    mpfr_set(a, (forward ? t_lo : t_hi), MPFR_RNDN);
+    depth = 0;
+    found = 0;
+    while (forward ? mpfr_less_p(a, t_hi) : mpfr_greater_p(a, t_lo)) {
+        mpfr_div_2ui(w, w_0, depth, MPFR_RNDU);
+        if (forward) {
+            mpfr_add(b, a, w, MPFR_RNDU);
+            mpfr_min(b, b, t_hi, MPFR_RNDU);
+        }
+        else {
+            mpfr_sub(b, a, w, MPFR_RNDD);
+            mpfr_max(b, b, t_lo, MPFR_RNDD);
+        }
+        if (event_eval(stepper, event, &g, x_mid, &t_mid, (forward ? a : b), (forward ? b : a)) == side) {
+            mpfr_set(a, b, MPFR_RNDN);
+            if (depth > 0) depth--;
+        }
+        else if (depth == ARPRA_ODE_EVENT_BISECTIONS) {
+            // The first interval of the finest width on which g may be zero.
+            mpfr_set(t_lo, (forward ? a : b), MPFR_RNDD);
+            mpfr_set(t_hi, (forward ? b : a), MPFR_RNDU);
+            found = 1;
+            break;
+        }
+        else {
+            depth++;
+        }
+    }
+
+    // Clear temp vars.
+    arpra_clear(&g);
+    arpra_clear(&t_mid);
+    mpfr_clear(w);
+    mpfr_clear(w_0);
+    mpfr_clear(a);
+    mpfr_clear(b);
+
+    return found;
+}
+
+static int event_locate (arpra_ode_stepper *stepper, arpra_ode_event *event, int sign_old, int sign_new,
+                         mpfr_ptr t_lo, mpfr_ptr t_hi, arpra_range **x_mid)
+{
+    mpfr_t a, b;
+
+    // t_lo: the first point at which g may leave the old side, if any.
+    mpfr_init2(b, mpfr_get_prec(t_hi));
+    mpfr_set(b, t_hi, MPFR_RNDU);
+    if (!event_search(stepper, event, sign_old, 1, t_lo, t_hi, x_mid)) {
+        mpfr_clear(b);
+        return 0;
+    }
+
+    // t_hi: the last point at which g may not yet be on the new side.
+    if (sign_new == 0) {
+        mpfr_swap(t_hi, b);
+    }
+    else {
+        mpfr_init2(a, mpfr_get_prec(t_hi));
+        mpfr_set(a, t_hi, MPFR_RNDD);
+        if (event_search(stepper, event, sign_new, 0, a, b, x_mid)) {
+            mpfr_swap(t_hi, b);
+        }
+        mpfr_clear(a);
+    }
+    mpfr_clear(b);
+
+    return 1;
+}
+
+arpra_uint arpra_ode_stepper_step_events (arpra_ode_stepper *stepper, const arpra_range *h)
+{
+    arpra_uint x_grp, x_dim, i, i_event, state_size, symbol_start;
+    arpra_prec prec_t, prec_internal;
+    arpra_range g, *_x_mid, **x_mid;
+    arpra_ode_event *event;
+    arpra_ode_system *system;
+    mpfr_t t_0, t_1, t_lo, t_hi, t_event_lo, t_event_hi;
+    int *sign_old, *sign_new;
+
+    system = stepper->system;
+    symbol_start = arpra_helper_get_symbol_count();
+
+    // Without events, or dense output to locate them, take a plain step.
+    if ((system->n_events == 0) || (stepper->method->interpolate == NULL)) {
+        stepper->method->step(stepper, h);
+        arpra_helper_ode_reduce(stepper, symbol_start);
+        return 0;
+    }
+
+    // Init temp vars.
+    prec_t = arpra_get_precision(system->t);
+    prec_internal = arpra_get_internal_precision();
+    arpra_init2(&g, prec_t);
+    mpfr_init2(t_0, prec_internal);
+    mpfr_init2(t_1, prec_internal);
+    mpfr_init2(t_lo, prec_internal);
+    mpfr_init2(t_hi, prec_internal);
+    mpfr_init2(t_event_lo, prec_internal);
+    mpfr_init2(t_event_hi, prec_internal);
+    sign_old = malloc(system->n_events * sizeof(int));
+    sign_new = malloc(system->n_events * sizeof(int));
+
+    // Side of each g before the step, arming disarmed events if possible.
+    for (i = 0; i < system->n_events; i++) {
+        event = &(system->events[i]);
+        if (event->sign == 0) {
+            event->g(&g, event->params, system->t, (const arpra_range **) system->x);
+            event->sign = event_side(&g);
+        }
+        sign_old[i] = event->sign;
+    }
+
+    // Take the step, and find the side of each g after it.
+    mpfr_set(t_0, &(system->t->centre), MPFR_RNDD);
+    stepper->method->step(stepper, h);
+    mpfr_set(t_1, &(system->t->centre), MPFR_RNDU);
+    for (i = 0; i < system->n_events; i++) {
+        event = &(system->events[i]);
+        event->g(&g, event->params, system->t, (const arpra_range **) system->x);
+        sign_new[i] = event_side(&g);
+        event->sign = sign_new[i];
+    }
+
+    // Locate the earliest event in the step.
+    _x_mid = NULL;
+    x_mid = NULL;
+    i_event = system->n_events;
+    for (i = 0; i < system->n_events; i++) {
+        event = &(system->events[i]);
+        if (sign_old[i] == 0) continue;
+        if ((event->direction != 0) && (event->direction != -sign_old[i])) continue;
+
+        if (x_mid == NULL) {
+            for (x_grp = 0, state_size = 0; x_grp < system->grps; x_grp++) {
+                state_size += system->dims[x_grp];
+            }
+            _x_mid = malloc(state_size * sizeof(arpra_range));
+            x_mid = malloc(system->grps * sizeof(arpra_range *));
+            for (x_grp = 0, state_size = 0; x_grp < system->grps; x_grp++) {
+                x_mid[x_grp] = &(_x_mid[state_size]);
+                for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++, state_size++) {
+                    arpra_init2(&(x_mid[x_grp][x_dim]), arpra_get_precision(&(system->x[x_grp][x_dim])));
+                }
+            }
+        }
+
+        mpfr_set(t_event_lo, t_0, MPFR_RNDD);
+        mpfr_set(t_event_hi, t_1, MPFR_RNDU);
+        if (!event_locate(stepper, event, sign_old[i], sign_new[i], t_event_lo, t_event_hi, x_mid)) continue;
+        if ((i_event == system->n_events) || mpfr_less_p(t_event_lo, t_lo)) {
+            i_event = i;
+            mpfr_set(t_lo, t_event_lo, MPFR_RNDD);
+            mpfr_set(t_hi, t_event_hi, MPFR_RNDU);
+        }
+    }
+
+    // Cut the step back to the event, and apply its update.
+    if (i_event < system->n_events) {
+        event = &(system->events[i_event]);
+        event_time(&g, system->t, t_lo, t_hi);
+        arpra_ode_stepper_interpolate(stepper, x_mid, &g);
+        arpra_set(system->t, &g);
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+                arpra_swap(&(system->x[x_grp][x_dim]), &(x_mid[x_grp][x_dim]));
+            }
+        }
+        if (event->apply != NULL) {
+            event->apply(system->x, event->params, system->t);
+        }
+
+        // The event is disarmed, and the others keep their old side.
+        for (i = 0; i < system->n_events; i++) {
+            system->events[i].sign = (i == i_event) ? 0 : sign_old[i];
+        }
+        arpra_ode_stepper_invalidate(stepper);
+    }
+
+    // Reduce the accepted state.
+    arpra_helper_ode_reduce(stepper, symbol_start);
+
+    // Clear temp vars.
+    if (x_mid != NULL) {
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+                arpra_clear(&(x_mid[x_grp][x_dim]));
+            }
+        }
+        free(_x_mid);
+        free(x_mid);
+    }
+    arpra_clear(&g);
+    mpfr_clear(t_0);
+    mpfr_clear(t_1);
+    mpfr_clear(t_lo);
+    mpfr_clear(t_hi);
+    mpfr_clear(t_event_lo);
+    mpfr_clear(t_event_hi);
+    free(sign_old);
+    free(sign_new);
+
+    return (i_event < system->n_events) ? i_event + 1 : 0;
+}
@@ -0,0 +1,228 @@
+/*
+ * ode_multirate.c -- Multi-rate stepping of slow and fast state groups.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * This is a slowest-first multi-rate scheme. Groups with ratio 1 are slow,
+ * and groups with ratio m > 1 are fast. All fast groups must share the
+ * same ratio m.
+ *
+ * 1. One step of size h advances the slow groups, and gives x_s(t + h).
+ *    Meanwhile each fast group is evaluated as a zero slope, so that it is
+ *    held at x_f(t) instead of being advanced by the full step h.
+ * 2. The slow groups are restored to x_s(t), and the fast groups take m
+ *    steps of size h / m. Meanwhile each slow group is evaluated as the
+ *    constant slope (x_s(t + h) - x_s(t)) / h, so it follows the linear
+ *    interpolant between its two values.
+ * 3. The slow groups are set to x_s(t + h).
+ *
+ * The slow right-hand sides are thus evaluated once per step, and the fast
+ * ones once per substep.
+ *
+ * Since the slow stages see the fast groups held at x_f(t), the slow update
+ * is only first order accurate in the fast-to-slow coupling, whatever the
+ * order of the method: its error from the coupling is O(h) per unit time.
+ * The fast groups are not extrapolated instead, since a fast group's slope
+ * is typically only valid for a small fraction of h. Systems with a strong
+ * fast-to-slow coupling need h small enough for this error, or one rate. The Jacobian callbacks are hidden meanwhile, so
+ * that implicit methods differentiate the substituted slopes. Carried-over
+ * method state, such as FSAL stages and Adams history, is kept between the
+ * substeps, and invalidated around each phase.
+ */
+
+static void multirate_slope (arpra_range *dxdt, const void *params, arpra_range *temp,
+                             const arpra_range *t, const arpra_range **x,
+                             const arpra_uint x_grp, const arpra_uint x_dims)
+{
+    const arpra_range *slope = (const arpra_range *) params;
+    arpra_uint x_dim;
+
+    // The slope is constant, so t, x and temp are not needed.
+    (void) temp;
+    (void) t;
+    (void) x;
+    (void) x_grp;
+
+    for (x_dim = 0; x_dim < x_dims; x_dim++) {
+        arpra_set(&(dxdt[x_dim]), &(slope[x_dim]));
+    }
+}
+
+static void multirate_swap (arpra_ode_system *system, arpra_ode_f_grp *f_grp, void **params,
+                            arpra_range *slope, const arpra_uint *ratio, int fast)
+{
+    arpra_uint x_grp, i;
+
+    // Groups on the other rate are evaluated as their slopes.
+    for (x_grp = 0, i = 0; x_grp < system->grps; x_grp++) {
+        if ((ratio[x_grp] > 1) == fast) {
+            f_grp[x_grp] = (system->f_grp != NULL) ? system->f_grp[x_grp] : NULL;
+            params[x_grp] = system->params[x_grp];
+        }
+        else {
+            f_grp[x_grp] = multirate_slope;
+            params[x_grp] = &(slope[i]);
+        }
+        i += system->dims[x_grp];
+    }
+}
+
+/*
+ * Returns 0, or ARPRA_ODE_STEP_FAILED if the fast groups do not share the
+ * same ratio, in which case t and x are left unchanged.
+ */
+
+arpra_uint arpra_ode_stepper_step_multirate (arpra_ode_stepper *stepper, const arpra_range *h,
+                                             const arpra_uint *ratio)
+{
+    arpra_uint x_grp, x_dim, i, m, symbol_start, state_size;
+    arpra_range *x_0, *x_1, *slope, t_0, t_1, h_sub, m_r;
+    arpra_ode_f_grp *f_grp, *sys_f_grp;
+    arpra_ode_jac *sys_jac;
+    void **params, **sys_params;
+    arpra_ode_system *system;
+    const arpra_ode_method *method;
+    arpra_prec prec_x, prec_t;
+
+    method = stepper->method;
+    system = stepper->system;
+
+    // Find the fast step ratio.
+    for (x_grp = 0, m = 1; x_grp < system->grps; x_grp++) {
+        if (ratio[x_grp] > m) m = ratio[x_grp];
+    }
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        if ((ratio[x_grp] > 1) && (ratio[x_grp] != m)) return ARPRA_ODE_STEP_FAILED;
+    }
+
+    // A single rate system takes an ordinary step.
+    if (m == 1) {
+        arpra_ode_stepper_step(stepper, h);
+        return 0;
+    }
+
+    symbol_start = arpra_helper_get_symbol_count();
+
+    // Initialise vars.
+    for (x_grp = 0, state_size = 0; x_grp < system->grps; x_grp++) {
+        state_size += system->dims[x_grp];
+    }
+    prec_t = arpra_get_precision(system->t);
+    x_0 = malloc(state_size * sizeof(arpra_range));
+    x_1 = malloc(state_size * sizeof(arpra_range));
+    slope = malloc(state_size * sizeof(arpra_range));
+    f_grp = malloc(system->grps * sizeof(arpra_ode_f_grp));
+    params = malloc(system->grps * sizeof(void *));
+    arpra_init2(&t_0, prec_t);
+    arpra_init2(&t_1, prec_t);
+    arpra_init2(&h_sub, arpra_get_precision(h));
+    arpra_init2(&m_r, arpra_get_precision(h));
+    for (x_grp = 0, i = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++, i++) {
+            prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
+            arpra_init2(&(x_0[i]), prec_x);
+            arpra_init2(&(x_1[i]), prec_x);
+            arpra_init2(&(slope[i]), prec_x);
+            arpra_set(&(x_0[i]), &(system->x[x_grp][x_dim]));
+            arpra_set_zero(&(slope[i]));
+        }
+    }
+    arpra_set(&t_0, system->t);
+    sys_f_grp = system->f_grp;
+    sys_params = system->params;
+    sys_jac = system->jac;
+
+    // Step the slow groups by h, holding the fast groups.
+    multirate_swap(system, f_grp, params, slope, ratio, 0);
+    system->f_grp = f_grp;
+    system->params = params;
+    system->jac = NULL;
+    arpra_ode_stepper_invalidate(stepper);
+    method->step(stepper, h);
+    arpra_set(&t_1, system->t);
+
+    // Keep x_s(t + h), and restore x(t).
+    for (x_grp = 0, i = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++, i++) {
+            if (ratio[x_grp] <= 1) {
+                arpra_set(&(x_1[i]), &(system->x[x_grp][x_dim]));
+                arpra_sub(&(slope[i]), &(x_1[i]), &(x_0[i]));
+                arpra_div(&(slope[i]), &(slope[i]), h);
+            }
+            arpra_set(&(system->x[x_grp][x_dim]), &(x_0[i]));
+        }
+    }
+    arpra_set(system->t, &t_0);
+
+    // Step the fast groups m times by h / m, interpolating the slow groups.
+    system->f_grp = sys_f_grp;
+    system->params = sys_params;
+    multirate_swap(system, f_grp, params, slope, ratio, 1);
+    system->f_grp = f_grp;
+    system->params = params;
+    arpra_set_d(&m_r, m);
+    arpra_div(&h_sub, h, &m_r);
+    arpra_ode_stepper_invalidate(stepper);
+    for (i = 0; i < m; i++) {
+        method->step(stepper, &h_sub);
+
+        // Keep carried-over method state, such as FSAL stages, between substeps.
+        if (stepper->record != NULL) {
+            arpra_helper_ode_record_set(stepper->record, system);
+        }
+    }
+    arpra_ode_stepper_invalidate(stepper);
+
+    // Restore the system, and set x_s(t + h) and t + h.
+    system->f_grp = sys_f_grp;
+    system->params = sys_params;
+    system->jac = sys_jac;
+    for (x_grp = 0, i = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++, i++) {
+            if (ratio[x_grp] <= 1) {
+                arpra_set(&(system->x[x_grp][x_dim]), &(x_1[i]));
+            }
+        }
+    }
+    arpra_set(system->t, &t_1);
+
+    // Reduce the new state.
+    arpra_helper_ode_reduce(stepper, symbol_start);
+
+    // Clear vars.
+    for (i = 0; i < state_size; i++) {
+        arpra_clear(&(x_0[i]));
+        arpra_clear(&(x_1[i]));
+        arpra_clear(&(slope[i]));
+    }
+    arpra_clear(&t_0);
+    arpra_clear(&t_1);
+    arpra_clear(&h_sub);
+    arpra_clear(&m_r);
+    free(x_0);
+    free(x_1);
+    free(slope);
+    free(f_grp);
+    free(params);
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+/*
+ * ode_precision.c -- Track precision changes of an ODE system.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * Steppers keep scratch ranges at the precisions of t and the state
+ * variables. Since arpra_set_precision reallocates a range and discards its
+ * terms, steppers only resynchronise their scratch memory when the system's
+ * precision generation or the internal precision has changed since their
+ * last step. Call arpra_ode_system_precision_changed after changing the
+ * precision of t or of any state variable.
+ */
+
+void arpra_ode_system_precision_changed (arpra_ode_system *system)
+{
+    system->precision_generation++;
+}
+
+void arpra_helper_ode_sync_init (arpra_ode_sync *sync)
+{
+    // Scratch memory is synchronised on the first step.
+    sync->generation = 0;
+    sync->prec_internal = 0;
+}
+
+int arpra_helper_ode_sync_stale (arpra_ode_sync *sync, const arpra_ode_system *system)
+{
+    arpra_prec prec_internal;
+
+    prec_internal = arpra_get_internal_precision();
+    if ((sync->prec_internal == prec_internal)
+        && (sync->generation == system->precision_generation)) {
+        return 0;
+    }
+
+    sync->generation = system->precision_generation;
+    sync->prec_internal = prec_internal;
+    return 1;
+}
@@ -0,0 +1,135 @@
+/*
+ * ode_record.c -- Detect changes to an ODE system between steps.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * Steppers which carry data over from one step to the next (a first stage,
+ * or a history of past derivatives) keep a copy of the state that the data
+ * belongs to. The copy is taken after each accepted step, once the step's
+ * deviation terms have been reduced, and the carried data is only reused
+ * if t and x are still identical to it: the same precision, centre, radius
+ * and deviation terms. Any change made to the state between steps, such as
+ * widening it or applying an event, therefore forces a fresh start.
+ *
+ * Changes to the parameters of the system cannot be detected this way, so
+ * arpra_ode_stepper_invalidate must be called after changing them.
+ */
+
+void arpra_helper_ode_copy_exact (arpra_range *y, const arpra_range *x1)
+{
+    arpra_uint i;
+
+    // Exact copy of x1, keeping the precision of every component.
+    arpra_helper_clear_terms(y);
+    y->precision = x1->precision;
+    mpfr_set_prec(&(y->centre), mpfr_get_prec(&(x1->centre)));
+    mpfr_set(&(y->centre), &(x1->centre), MPFR_RNDN);
+    mpfr_set_prec(&(y->radius), mpfr_get_prec(&(x1->radius)));
+    mpfr_set(&(y->radius), &(x1->radius), MPFR_RNDN);
+    mpfi_set_prec(&(y->true_range), mpfi_get_prec(&(x1->true_range)));
+    mpfi_set(&(y->true_range), &(x1->true_range));
+    if (x1->nTerms > 0) {
+        y->symbols = malloc(x1->nTerms * sizeof(arpra_uint));
+        y->deviations = malloc(x1->nTerms * sizeof(mpfr_t));
+        for (i = 0; i < x1->nTerms; i++) {
+            y->symbols[i] = x1->symbols[i];
+            mpfr_init2(&(y->deviations[i]), mpfr_get_prec(&(x1->deviations[i])));
+            mpfr_set(&(y->deviations[i]), &(x1->deviations[i]), MPFR_RNDN);
+        }
+    }
+    y->nTerms = x1->nTerms;
+}
+
+int arpra_helper_ode_equal_exact_p (const arpra_range *x1, const arpra_range *x2)
+{
+    arpra_uint i;
+
+    if (x1->precision != x2->precision) return 0;
+    if (x1->nTerms != x2->nTerms) return 0;
+    if (!mpfr_equal_p(&(x1->centre), &(x2->centre))) return 0;
+    if (!mpfr_equal_p(&(x1->radius), &(x2->radius))) return 0;
+    for (i = 0; i < x1->nTerms; i++) {
+        if (x1->symbols[i] != x2->symbols[i]) return 0;
+        if (!mpfr_equal_p(&(x1->deviations[i]), &(x2->deviations[i]))) return 0;
+    }
+
+    return 1;
+}
+
+arpra_ode_record *arpra_helper_ode_record_init (const arpra_ode_system *system)
+{
+    arpra_uint x_grp, i;
+    arpra_ode_record *record;
+
+    record = malloc(sizeof(arpra_ode_record));
+    for (x_grp = 0, record->size = 0; x_grp < system->grps; x_grp++) {
+        record->size += system->dims[x_grp];
+    }
+    record->x = malloc(record->size * sizeof(arpra_range));
+    arpra_init2(&(record->t), arpra_get_precision(system->t));
+    for (i = 0; i < record->size; i++) {
+        arpra_init2(&(record->x[i]), arpra_get_default_precision());
+    }
+    record->valid = 0;
+
+    return record;
+}
+
+void arpra_helper_ode_record_clear (arpra_ode_record *record)
+{
+    arpra_uint i;
+
+    arpra_clear(&(record->t));
+    for (i = 0; i < record->size; i++) {
+        arpra_clear(&(record->x[i]));
+    }
+    free(record->x);
+    free(record);
+}
+
+void arpra_helper_ode_record_set (arpra_ode_record *record, const arpra_ode_system *system)
+{
+    arpra_uint x_grp, x_dim, i;
+
+    arpra_helper_ode_copy_exact(&(record->t), system->t);
+    for (x_grp = 0, i = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++, i++) {
+            arpra_helper_ode_copy_exact(&(record->x[i]), &(system->x[x_grp][x_dim]));
+        }
+    }
+    record->valid = 1;
+}
+
+int arpra_helper_ode_record_equal_p (const arpra_ode_record *record, const arpra_ode_system *system)
+{
+    arpra_uint x_grp, x_dim, i;
+
+    if ((record == NULL) || !record->valid) return 0;
+    if (!arpra_helper_ode_equal_exact_p(&(record->t), system->t)) return 0;
+    for (x_grp = 0, i = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++, i++) {
+            if (!arpra_helper_ode_equal_exact_p(&(record->x[i]), &(system->x[x_grp][x_dim]))) return 0;
+        }
+    }
+
+    return 1;
+}
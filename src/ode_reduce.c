@@ -0,0 +1,99 @@
+/*
+ * ode_reduce.c -- Deviation term reduction policy for ODE steppers.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+void arpra_ode_stepper_set_reduce (arpra_ode_stepper *stepper, arpra_ode_reduce *reduce)
+{
+    stepper->reduce = reduce;
+}
+
+/*
+ * Apply the stepper's reduction policy to the system state after an
+ * accepted step. Terms with symbols numbered symbol_start or higher were
+ * created by the step. Each state variable is reduced independently, so
+ * the variables of a group are processed in parallel.
+ */
+
+static void ode_reduce (arpra_ode_stepper *stepper, arpra_uint symbol_start)
+{
+    arpra_uint x_grp, x_dim, n, n_terms, condensed;
+    arpra_range *x;
+    arpra_ode_system *system;
+    arpra_ode_reduce *reduce;
+    int threshold;
+
+    system = stepper->system;
+    reduce = stepper->reduce;
+    if (reduce == NULL) return;
+
+    reduce->step_count++;
+    threshold = (reduce->rel_threshold != NULL) && (reduce->interval > 0)
+        && ((reduce->step_count % reduce->interval) == 0);
+    condensed = 0;
+
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        #pragma omp parallel for private(x, n, n_terms) reduction(+:condensed)
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            x = &(system->x[x_grp][x_dim]);
+            n_terms = x->nTerms;
+
+            // Condense new terms from this step.
+            if (reduce->step_terms) {
+                for (n = 0; (n < x->nTerms) && (x->symbols[x->nTerms - n - 1] >= symbol_start); n++);
+                if (n > 1) {
+                    arpra_reduce_last_n(x, x, n);
+                }
+            }
+
+            // Condense small terms.
+            if (threshold) {
+                arpra_reduce_small_rel(x, x, reduce->rel_threshold);
+            }
+
+            // Enforce the term budget.
+            if ((reduce->max_terms > 0) && (x->nTerms > reduce->max_terms)) {
+                arpra_reduce_to_k(x, x, reduce->max_terms - 1);
+            }
+
+            if (x->nTerms < n_terms) {
+                condensed += n_terms - x->nTerms;
+            }
+        }
+    }
+
+    reduce->condensed += condensed;
+}
+
+/*
+ * Finish an accepted step: reduce the new state, then record it. Data that
+ * the method carries over to the next step is reused only while the state
+ * still matches this record, so the reductions made here do not discard it.
+ */
+
+void arpra_helper_ode_reduce (arpra_ode_stepper *stepper, arpra_uint symbol_start)
+{
+    ode_reduce(stepper, symbol_start);
+
+    if (stepper->record != NULL) {
+        arpra_helper_ode_record_set(stepper->record, stepper->system);
+    }
+}
@@ -0,0 +1,718 @@
+/*
+ * ode_ros2.c -- Linearly implicit second-order Rosenbrock ODE stepper.
+ *
+ * Copyright 2018-2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * This is the L-stable ROS2 method of Verwer et al. (1999), with
+ * gamma = 1 + 1/sqrt(2):
+ *
+ * W = I - gamma h J
+ * W k[0] = f(t, x(t))
+ * W k[1] = f(t + h, x(t) + h k[0]) - 2 k[0]
+ * x(t + h) = x(t) + 3/2 h k[0] + 1/2 h k[1]
+ *
+ * ROS2 is a W-method, so it keeps order two for any matrix J. The
+ * Jacobian is therefore only needed approximately. It is evaluated at the
+ * centre of the state as a point matrix, either from the user-supplied
+ * callbacks or by forward differences, and W is factorised in floating
+ * point. The factors are reused while h and the precision are unchanged,
+ * for up to ARPRA_ODE_JACOBIAN_MAX_AGE steps.
+ *
+ * If the system declares which groups each group reads, blocks of J
+ * between groups that do not read each other are known to be zero. They
+ * are neither evaluated nor differenced, and the factorisation and the
+ * solves skip zero entries, so block structured systems cost much less
+ * than dense ones. Groups summed by a coupling may be read by any group.
+ *
+ * The stages are solved by substitution with the point factors in range
+ * arithmetic, so they enclose the exact solutions of P'LU k = r for the
+ * matrix P'LU that was actually factorised. Since P'LU = I - gamma h J'
+ * for J' = (I - P'LU) / (gamma h), the result encloses an exact ROS2 step
+ * with the matrix J', which is a valid choice for a W-method. As with the
+ * explicit methods, it is the step of the method that is enclosed, not
+ * the truncation error of the method.
+ */
+
+#define ros2_stages 2
+
+typedef struct ros2_scratch_struct
+{
+    arpra_range *_k[ros2_stages];
+    arpra_range **k[ros2_stages];
+    arpra_range *_x_new;
+    arpra_range **x_new;
+    arpra_range *_error;
+    arpra_range **error;
+    arpra_range *_x_jac;
+    arpra_range **x_jac;
+    arpra_range *y;
+    arpra_range b[ros2_stages];
+    arpra_range bh[ros2_stages];
+    arpra_range f_jac;
+    arpra_range temp_t;
+    arpra_range temp_x;
+    arpra_range t_new;
+    arpra_ode_sync sync;
+    __mpfr_struct *w;
+    __mpfr_struct *f_0;
+    __mpfr_struct gamma;
+    __mpfr_struct w_h;
+    arpra_uint w_age;
+    int w_valid;
+    arpra_uint *perm;
+    arpra_uint size;
+    char *reads;
+} ros2_scratch;
+
+static void ros2_fms (arpra_range *y, const arpra_range *x1, mpfr_srcptr c, const arpra_range *x2)
+{
+    mpfi_t ia_range, ia_temp;
+    mpfi_t alpha, beta, gamma;
+    mpfr_t delta;
+
+    // Handle domain violations.
+    if (arpra_nan_p(x1) || arpra_nan_p(x2)) {
+        arpra_set_nan(y);
+        return;
+    }
+    if (arpra_inf_p(x1) || arpra_inf_p(x2)) {
+        if (arpra_inf_p(x1) && arpra_inf_p(x2)) {
+            arpra_set_nan(y);
+        }
+        else {
+            arpra_set_inf(y);
+        }
+        return;
+    }
+
+    // Initialise vars.
+    mpfi_init2(ia_range, y->precision);
+    mpfi_init2(ia_temp, y->precision);
+    mpfi_init2(alpha, 2);
+    mpfi_init2(beta, mpfr_get_prec(c));
+    mpfi_init2(gamma, 2);
+    mpfr_init2(delta, 2);
+    mpfi_set_si(alpha, 1);
+    mpfi_set_fr(beta, c);
+    mpfi_neg(beta, beta);
+    mpfi_set_si(gamma, 0);
+    mpfr_set_zero(delta, 1);
+
+    // MPFI fused multiply-subtract
+    mpfi_mul_fr(ia_temp, &(x2->true_range), c);
+    mpfi_sub(ia_range, &(x1->true_range), ia_temp);
+
+    // y = x1 - c x2
+    arpra_helper_affine_2(y, x1, x2, alpha, beta, gamma, delta);
+
+    // Compute true_range.
+    arpra_helper_compute_range(y);
+
+    // Mix with IA range, and trim error term.
+    arpra_helper_mix_trim(y, ia_range);
+
+    // Check for NaN and Inf.
+    arpra_helper_check_result(y);
+
+    // Clear vars.
+    mpfi_clear(ia_range);
+    mpfi_clear(ia_temp);
+    mpfi_clear(alpha);
+    mpfi_clear(beta);
+    mpfi_clear(gamma);
+    mpfr_clear(delta);
+}
+
+static void ros2_div (arpra_range *y, const arpra_range *x1, mpfr_srcptr c)
+{
+    mpfi_t ia_range;
+    mpfi_t alpha, gamma;
+    mpfr_t delta;
+
+    // Handle domain violations.
+    if (arpra_nan_p(x1)) {
+        arpra_set_nan(y);
+        return;
+    }
+    if (arpra_inf_p(x1)) {
+        arpra_set_inf(y);
+        return;
+    }
+
+    // Initialise vars.
+    mpfi_init2(ia_range, y->precision);
+    mpfi_init2(alpha, arpra_get_internal_precision());
+    mpfi_init2(gamma, 2);
+    mpfr_init2(delta, 2);
+    mpfi_set_fr(alpha, c);
+    mpfi_inv(alpha, alpha);
+    mpfi_set_si(gamma, 0);
+    mpfr_set_zero(delta, 1);
+
+    // MPFI division
+    mpfi_div_fr(ia_range, &(x1->true_range), c);
+
+    // y = (1 / c) x1
+    arpra_helper_affine_1(y, x1, alpha, gamma, delta);
+
+    // Compute true_range.
+    arpra_helper_compute_range(y);
+
+    // Mix with IA range, and trim error term.
+    arpra_helper_mix_trim(y, ia_range);
+
+    // Check for NaN and Inf.
+    arpra_helper_check_result(y);
+
+    // Clear vars.
+    mpfi_clear(ia_range);
+    mpfi_clear(alpha);
+    mpfi_clear(gamma);
+    mpfr_clear(delta);
+}
+
+static int ros2_coupled (const arpra_ode_system *system, arpra_uint y_grp)
+{
+    arpra_uint c;
+
+    for (c = 0; c < system->n_coupling; c++) {
+        if (system->coupling[c].x_grp == y_grp) return 1;
+    }
+
+    return 0;
+}
+
+static int ros2_reads (const ros2_scratch *scratch, arpra_uint x_grp, arpra_uint y_grp,
+                       arpra_uint grps)
+{
+    // Without declared dependencies, every group may read every group.
+    return (scratch->reads == NULL) || scratch->reads[(x_grp * grps) + y_grp];
+}
+
+static void ros2_jacobian (arpra_ode_stepper *stepper)
+{
+    arpra_uint x_grp, x_dim, y_grp, y_dim, i, j, i_0, n;
+    arpra_prec prec_x, prec_internal;
+    mpfr_t x_j, x_p, delta;
+    int coupled;
+    arpra_ode_system *system;
+    ros2_scratch *scratch;
+
+    system = stepper->system;
+    scratch = (ros2_scratch *) stepper->scratch;
+    n = scratch->size;
+
+    // Use the user-supplied Jacobian if there is one, keeping only its centre.
+    if (system->jac != NULL) {
+        arpra_helper_ode_couple(system, (const arpra_range **) system->x);
+        for (x_grp = 0, i = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++, i++) {
+                prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
+                arpra_set_precision(&(scratch->f_jac), prec_x);
+                for (y_grp = 0, j = 0; y_grp < system->grps; y_grp++) {
+                    if (!ros2_reads(scratch, x_grp, y_grp, system->grps)) {
+                        for (y_dim = 0; y_dim < system->dims[y_grp]; y_dim++, j++) {
+                            mpfr_set_zero(&(scratch->w[(i * n) + j]), 1);
+                        }
+                        continue;
+                    }
+                    for (y_dim = 0; y_dim < system->dims[y_grp]; y_dim++, j++) {
+                        system->jac[x_grp](&(scratch->f_jac), system->params[x_grp],
+                                           system->t, (const arpra_range **) system->x,
+                                           x_grp, x_dim, y_grp, y_dim);
+                        mpfr_set(&(scratch->w[(i * n) + j]), &(scratch->f_jac.centre), MPFR_RNDN);
+                    }
+                }
+            }
+        }
+        return;
+    }
+
+    // Otherwise approximate it by forward differences at the centre of the state.
+    prec_internal = arpra_get_internal_precision();
+    mpfr_init2(x_j, prec_internal);
+    mpfr_init2(x_p, prec_internal);
+    mpfr_init2(delta, prec_internal);
+
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
+            arpra_set_precision(&(scratch->x_jac[x_grp][x_dim]), prec_x);
+            arpra_set_mpfr(&(scratch->x_jac[x_grp][x_dim]), &(system->x[x_grp][x_dim].centre));
+        }
+    }
+    // The stage slot k[1] is free until the step, so it holds f.
+    arpra_helper_ode_eval(stepper, scratch->k[1], system->t, (const arpra_range **) scratch->x_jac);
+    for (x_grp = 0, i = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++, i++) {
+            mpfr_set(&(scratch->f_0[i]), &(scratch->k[1][x_grp][x_dim].centre), MPFR_RNDN);
+        }
+    }
+
+    for (y_grp = 0, j = 0; y_grp < system->grps; y_grp++) {
+        for (y_dim = 0; y_dim < system->dims[y_grp]; y_dim++, j++) {
+            // delta = sqrt(eps) max(|x_j|, 1)
+            prec_x = arpra_get_precision(&(system->x[y_grp][y_dim]));
+            mpfr_set(x_j, &(scratch->x_jac[y_grp][y_dim].centre), MPFR_RNDN);
+            mpfr_abs(delta, x_j, MPFR_RNDN);
+            if (mpfr_cmp_ui(delta, 1) < 0) {
+                mpfr_set_ui(delta, 1, MPFR_RNDN);
+            }
+            mpfr_mul_2si(delta, delta, -((long) prec_x / 2), MPFR_RNDN);
+
+            // Perturb x_j, and use the rounded perturbation in the quotient.
+            mpfr_add(x_p, x_j, delta, MPFR_RNDN);
+            arpra_set_mpfr(&(scratch->x_jac[y_grp][y_dim]), x_p);
+            mpfr_sub(delta, &(scratch->x_jac[y_grp][y_dim].centre), x_j, MPFR_RNDN);
+
+            // Only the groups which read x_j are evaluated again.
+            coupled = (scratch->reads != NULL) && ros2_coupled(system, y_grp);
+            if (coupled) {
+                arpra_helper_ode_couple(system, (const arpra_range **) scratch->x_jac);
+            }
+            for (x_grp = 0, i_0 = 0; x_grp < system->grps; i_0 += system->dims[x_grp++]) {
+                if (!ros2_reads(scratch, x_grp, y_grp, system->grps)) {
+                    for (x_dim = 0, i = i_0; x_dim < system->dims[x_grp]; x_dim++, i++) {
+                        mpfr_set_zero(&(scratch->w[(i * n) + j]), 1);
+                    }
+                    continue;
+                }
+                if (scratch->reads == NULL) {
+                    if (x_grp == 0) {
+                        arpra_helper_ode_eval(stepper, scratch->k[1], system->t,
+                                              (const arpra_range **) scratch->x_jac);
+                    }
+                }
+                else {
+                    arpra_helper_ode_eval_grp(stepper, scratch->k[1][x_grp], system->t,
+                                              (const arpra_range **) scratch->x_jac, x_grp);
+                }
+                for (x_dim = 0, i = i_0; x_dim < system->dims[x_grp]; x_dim++, i++) {
+                    mpfr_sub(&(scratch->w[(i * n) + j]), &(scratch->k[1][x_grp][x_dim].centre), &(scratch->f_0[i]), MPFR_RNDN);
+                    mpfr_div(&(scratch->w[(i * n) + j]), &(scratch->w[(i * n) + j]), delta, MPFR_RNDN);
+                }
+            }
+
+            // Restore x_j, and the coupled sums that depend on it.
+            arpra_set_mpfr(&(scratch->x_jac[y_grp][y_dim]), x_j);
+            if (coupled) {
+                arpra_helper_ode_couple(system, (const arpra_range **) scratch->x_jac);
+            }
+        }
+    }
+
+    mpfr_clear(x_j);
+    mpfr_clear(x_p);
+    mpfr_clear(delta);
+}
+
+static void ros2_factor (arpra_ode_stepper *stepper, const arpra_range *h)
+{
+    arpra_uint i, j, r, n, p;
+    mpfr_t gh, temp;
+    ros2_scratch *scratch;
+
+    scratch = (ros2_scratch *) stepper->scratch;
+    n = scratch->size;
+    mpfr_init2(gh, arpra_get_internal_precision());
+    mpfr_init2(temp, arpra_get_internal_precision());
+
+    // W = I - gamma h J
+    mpfr_mul(gh, &(scratch->gamma), &(h->centre), MPFR_RNDN);
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) {
+            mpfr_mul(&(scratch->w[(i * n) + j]), &(scratch->w[(i * n) + j]), gh, MPFR_RNDN);
+            mpfr_neg(&(scratch->w[(i * n) + j]), &(scratch->w[(i * n) + j]), MPFR_RNDN);
+        }
+        mpfr_add_ui(&(scratch->w[(i * n) + i]), &(scratch->w[(i * n) + i]), 1, MPFR_RNDN);
+        scratch->perm[i] = i;
+    }
+
+    // LU decomposition of W with partial pivoting, in place.
+    for (j = 0; j < n; j++) {
+        for (i = j + 1, p = j; i < n; i++) {
+            if (mpfr_cmpabs(&(scratch->w[(i * n) + j]), &(scratch->w[(p * n) + j])) > 0) p = i;
+        }
+        if (mpfr_zero_p(&(scratch->w[(p * n) + j])) || !mpfr_number_p(&(scratch->w[(p * n) + j]))) break;
+        if (p != j) {
+            for (r = 0; r < n; r++) {
+                mpfr_swap(&(scratch->w[(p * n) + r]), &(scratch->w[(j * n) + r]));
+            }
+            r = scratch->perm[p];
+            scratch->perm[p] = scratch->perm[j];
+            scratch->perm[j] = r;
+        }
+        // Zero entries below the pivot, and in the pivot row, need no update.
+        for (i = j + 1; i < n; i++) {
+            if (mpfr_zero_p(&(scratch->w[(i * n) + j]))) continue;
+            mpfr_div(&(scratch->w[(i * n) + j]), &(scratch->w[(i * n) + j]), &(scratch->w[(j * n) + j]), MPFR_RNDN);
+            for (r = j + 1; r < n; r++) {
+                if (mpfr_zero_p(&(scratch->w[(j * n) + r]))) continue;
+                mpfr_mul(temp, &(scratch->w[(i * n) + j]), &(scratch->w[(j * n) + r]), MPFR_RNDN);
+                mpfr_sub(&(scratch->w[(i * n) + r]), &(scratch->w[(i * n) + r]), temp, MPFR_RNDN);
+            }
+        }
+    }
+
+    // If W is singular, fall back to J = 0, which is still a valid W-method.
+    if (j < n) {
+        for (i = 0; i < n; i++) {
+            for (r = 0; r < n; r++) {
+                mpfr_set_ui(&(scratch->w[(i * n) + r]), (i == r), MPFR_RNDN);
+            }
+            scratch->perm[i] = i;
+        }
+    }
+
+    mpfr_clear(gh);
+    mpfr_clear(temp);
+}
+
+static void ros2_solve (arpra_ode_stepper *stepper, arpra_range *k)
+{
+    arpra_uint i, j, n;
+    mpfr_ptr w_ij;
+    ros2_scratch *scratch;
+
+    scratch = (ros2_scratch *) stepper->scratch;
+    n = scratch->size;
+
+    // Forward substitution: L y = P k
+    for (i = 0; i < n; i++) {
+        arpra_swap(&(scratch->y[i]), &(k[scratch->perm[i]]));
+        for (j = 0; j < i; j++) {
+            w_ij = &(scratch->w[(i * n) + j]);
+            if (mpfr_zero_p(w_ij)) continue;
+            ros2_fms(&(scratch->y[i]), &(scratch->y[i]), w_ij, &(scratch->y[j]));
+        }
+    }
+
+    // Backward substitution: U k = y
+    for (i = n; i-- > 0;) {
+        for (j = i + 1; j < n; j++) {
+            w_ij = &(scratch->w[(i * n) + j]);
+            if (mpfr_zero_p(w_ij)) continue;
+            ros2_fms(&(scratch->y[i]), &(scratch->y[i]), w_ij, &(scratch->y[j]));
+        }
+        w_ij = &(scratch->w[(i * n) + i]);
+        if (mpfr_cmp_ui(w_ij, 1) != 0) {
+            ros2_div(&(scratch->y[i]), &(scratch->y[i]), w_ij);
+        }
+    }
+
+    for (i = 0; i < n; i++) {
+        arpra_swap(&(k[i]), &(scratch->y[i]));
+    }
+}
+
+static void ros2_init (arpra_ode_stepper *stepper, arpra_ode_system *system)
+{
+    arpra_uint x_grp, x_dim, y_grp, k_i, i, state_size;
+    arpra_prec prec_x, prec_internal;
+    ros2_scratch *scratch;
+
+    // Allocate scratch memory.
+    scratch = malloc(sizeof(ros2_scratch));
+    for (x_grp = 0, state_size = 0; x_grp < system->grps; x_grp++) {
+        state_size += system->dims[x_grp];
+    }
+    for (k_i = 0; k_i < ros2_stages; k_i++) {
+        scratch->_k[k_i] = malloc(state_size * sizeof(arpra_range));
+        scratch->k[k_i] = malloc(system->grps * sizeof(arpra_range *));
+    }
+    scratch->_x_new = malloc(state_size * sizeof(arpra_range));
+    scratch->x_new = malloc(system->grps * sizeof(arpra_range *));
+    scratch->_error = malloc(state_size * sizeof(arpra_range));
+    scratch->error = malloc(system->grps * sizeof(arpra_range *));
+    scratch->_x_jac = malloc(state_size * sizeof(arpra_range));
+    scratch->x_jac = malloc(system->grps * sizeof(arpra_range *));
+    scratch->y = malloc(state_size * sizeof(arpra_range));
+    scratch->w = malloc(state_size * state_size * sizeof(__mpfr_struct));
+    scratch->f_0 = malloc(state_size * sizeof(__mpfr_struct));
+    scratch->perm = malloc(state_size * sizeof(arpra_uint));
+    scratch->size = state_size;
+    scratch->reads = NULL;
+
+    // Blocks of J between groups that do not read each other are zero.
+    if (system->deps != NULL) {
+        scratch->reads = calloc(system->grps * system->grps, sizeof(char));
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            scratch->reads[(x_grp * system->grps) + x_grp] = 1;
+            for (i = 0; i < system->n_deps[x_grp]; i++) {
+                scratch->reads[(x_grp * system->grps) + system->deps[x_grp][i]] = 1;
+            }
+            for (y_grp = 0; y_grp < system->grps; y_grp++) {
+                if (ros2_coupled(system, y_grp)) {
+                    scratch->reads[(x_grp * system->grps) + y_grp] = 1;
+                }
+            }
+        }
+    }
+
+    // Initialise scratch memory.
+    prec_internal = arpra_get_internal_precision();
+    for (k_i = 0; k_i < ros2_stages; k_i++) {
+        scratch->k[k_i][0] = scratch->_k[k_i];
+    }
+    scratch->x_new[0] = scratch->_x_new;
+    scratch->error[0] = scratch->_error;
+    scratch->x_jac[0] = scratch->_x_jac;
+    for (x_grp = 1; x_grp < system->grps; x_grp++) {
+        for (k_i = 0; k_i < ros2_stages; k_i++) {
+            scratch->k[k_i][x_grp] = scratch->k[k_i][x_grp - 1] + system->dims[x_grp - 1];
+        }
+        scratch->x_new[x_grp] = scratch->x_new[x_grp - 1] + system->dims[x_grp - 1];
+        scratch->error[x_grp] = scratch->error[x_grp - 1] + system->dims[x_grp - 1];
+        scratch->x_jac[x_grp] = scratch->x_jac[x_grp - 1] + system->dims[x_grp - 1];
+    }
+    for (x_grp = 0, i = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++, i++) {
+            prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
+            for (k_i = 0; k_i < ros2_stages; k_i++) {
+                arpra_init2(&(scratch->k[k_i][x_grp][x_dim]), prec_x);
+            }
+            arpra_init2(&(scratch->x_new[x_grp][x_dim]), prec_x);
+            arpra_init2(&(scratch->error[x_grp][x_dim]), prec_x);
+            arpra_init2(&(scratch->x_jac[x_grp][x_dim]), prec_x);
+            arpra_init2(&(scratch->y[i]), prec_x);
+            mpfr_init2(&(scratch->f_0[i]), prec_internal);
+        }
+    }
+    for (i = 0; i < (state_size * state_size); i++) {
+        mpfr_init2(&(scratch->w[i]), prec_internal);
+    }
+    for (k_i = 0; k_i < ros2_stages; k_i++) {
+        arpra_init2(&(scratch->b[k_i]), prec_internal);
+        arpra_init2(&(scratch->bh[k_i]), prec_internal);
+    }
+    arpra_init2(&(scratch->f_jac), prec_internal);
+    arpra_init2(&(scratch->temp_t), prec_internal);
+    arpra_init2(&(scratch->temp_x), prec_internal);
+    arpra_init2(&(scratch->t_new), prec_internal);
+    mpfr_init2(&(scratch->gamma), prec_internal);
+    mpfr_init2(&(scratch->w_h), prec_internal);
+    scratch->w_age = 0;
+    scratch->w_valid = 0;
+    arpra_helper_ode_sync_init(&(scratch->sync));
+
+    // x(t + h) = x(t) + 3/2 h k[0]
+    //                 + 1/2 h k[1]
+    arpra_set_d(&(scratch->b[0]), 1.5);
+    arpra_set_d(&(scratch->b[1]), 0.5);
+
+    // gamma = 1 + 1/sqrt(2)
+    mpfr_sqrt_ui(&(scratch->gamma), 2, MPFR_RNDN);
+    mpfr_ui_div(&(scratch->gamma), 1, &(scratch->gamma), MPFR_RNDN);
+    mpfr_add_ui(&(scratch->gamma), &(scratch->gamma), 1, MPFR_RNDN);
+
+    // Set stepper parameters.
+    stepper->method = arpra_ode_ros2;
+    stepper->system = system;
+    stepper->error = scratch->error;
+    stepper->scratch = scratch;
+}
+
+static void ros2_clear (arpra_ode_stepper *stepper)
+{
+    arpra_uint x_grp, x_dim, k_i, i;
+    arpra_ode_system *system;
+    ros2_scratch *scratch;
+
+    system = stepper->system;
+    scratch = (ros2_scratch *) stepper->scratch;
+
+    // Clear scratch memory.
+    for (x_grp = 0, i = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++, i++) {
+            for (k_i = 0; k_i < ros2_stages; k_i++) {
+                arpra_clear(&(scratch->k[k_i][x_grp][x_dim]));
+            }
+            arpra_clear(&(scratch->x_new[x_grp][x_dim]));
+            arpra_clear(&(scratch->error[x_grp][x_dim]));
+            arpra_clear(&(scratch->x_jac[x_grp][x_dim]));
+            arpra_clear(&(scratch->y[i]));
+            mpfr_clear(&(scratch->f_0[i]));
+        }
+    }
+    for (i = 0; i < (scratch->size * scratch->size); i++) {
+        mpfr_clear(&(scratch->w[i]));
+    }
+    for (k_i = 0; k_i < ros2_stages; k_i++) {
+        arpra_clear(&(scratch->b[k_i]));
+        arpra_clear(&(scratch->bh[k_i]));
+    }
+    arpra_clear(&(scratch->f_jac));
+    arpra_clear(&(scratch->temp_t));
+    arpra_clear(&(scratch->temp_x));
+    arpra_clear(&(scratch->t_new));
+    mpfr_clear(&(scratch->gamma));
+    mpfr_clear(&(scratch->w_h));
+
+    // Free scratch memory.
+    for (k_i = 0; k_i < ros2_stages; k_i++) {
+        free(scratch->_k[k_i]);
+        free(scratch->k[k_i]);
+    }
+    free(scratch->_x_new);
+    free(scratch->x_new);
+    free(scratch->_error);
+    free(scratch->error);
+    free(scratch->_x_jac);
+    free(scratch->x_jac);
+    free(scratch->y);
+    free(scratch->w);
+    free(scratch->f_0);
+    free(scratch->perm);
+    free(scratch->reads);
+    free(scratch);
+}
+
+static void ros2_step (arpra_ode_stepper *stepper, const arpra_range *h)
+{
+    arpra_uint x_grp, x_dim, k_i;
+    arpra_prec prec_t, prec_x;
+    arpra_ode_system *system;
+    ros2_scratch *scratch;
+
+    system = stepper->system;
+    scratch = (ros2_scratch *) stepper->scratch;
+
+    // Synchronise scratch precision if it has changed, and prepare step parameters.
+    prec_t = arpra_get_precision(system->t);
+    if (arpra_helper_ode_sync_stale(&(scratch->sync), system)) {
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+                prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
+                for (k_i = 0; k_i < ros2_stages; k_i++) {
+                    arpra_set_precision(&(scratch->k[k_i][x_grp][x_dim]), prec_x);
+                }
+                arpra_set_precision(&(scratch->x_new[x_grp][x_dim]), prec_x);
+                arpra_set_precision(&(scratch->error[x_grp][x_dim]), prec_x);
+            }
+        }
+        for (k_i = 0; k_i < ros2_stages; k_i++) {
+            arpra_set_precision(&(scratch->bh[k_i]), prec_t);
+        }
+        arpra_set_precision(&(scratch->temp_t), prec_t);
+        arpra_set_precision(&(scratch->t_new), prec_t);
+        scratch->w_valid = 0;
+    }
+    for (k_i = 0; k_i < ros2_stages; k_i++) {
+        arpra_mul(&(scratch->bh[k_i]), &(scratch->b[k_i]), h);
+    }
+    arpra_add(&(scratch->temp_t), system->t, h);
+
+    // Factorise W = I - gamma h J at the current state, unless the factors are reusable.
+    if (!scratch->w_valid || (scratch->w_age >= ARPRA_ODE_JACOBIAN_MAX_AGE)
+        || !mpfr_equal_p(&(h->centre), &(scratch->w_h))) {
+        ros2_jacobian(stepper);
+        ros2_factor(stepper, h);
+        mpfr_set_prec(&(scratch->w_h), mpfr_get_prec(&(h->centre)));
+        mpfr_set(&(scratch->w_h), &(h->centre), MPFR_RNDN);
+        scratch->w_age = 0;
+        scratch->w_valid = 1;
+    }
+    scratch->w_age++;
+
+    // W k[0] = f(t, x(t))
+    arpra_helper_ode_eval(stepper, scratch->k[0], system->t, (const arpra_range **) system->x);
+    ros2_solve(stepper, scratch->_k[0]);
+
+    // W k[1] = f(t + h, x(t) + h k[0]) - 2 k[0]
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
+            arpra_set_precision(&(scratch->temp_x), prec_x);
+            arpra_mul(&(scratch->temp_x), h, &(scratch->k[0][x_grp][x_dim]));
+            arpra_add(&(scratch->x_new[x_grp][x_dim]), &(system->x[x_grp][x_dim]), &(scratch->temp_x));
+        }
+    }
+    arpra_helper_ode_eval(stepper, scratch->k[1], &(scratch->temp_t), (const arpra_range **) scratch->x_new);
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
+            arpra_set_precision(&(scratch->temp_x), prec_x);
+            arpra_add(&(scratch->temp_x), &(scratch->k[0][x_grp][x_dim]), &(scratch->k[0][x_grp][x_dim]));
+            arpra_sub(&(scratch->k[1][x_grp][x_dim]), &(scratch->k[1][x_grp][x_dim]), &(scratch->temp_x));
+        }
+    }
+    ros2_solve(stepper, scratch->_k[1]);
+
+    // x(t + h) = x(t) + 3/2 h k[0] + 1/2 h k[1]
+    // error = 1/2 h k[0] + 1/2 h k[1]
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
+            arpra_set_precision(&(scratch->temp_x), prec_x);
+            arpra_mul(&(scratch->temp_x), &(scratch->bh[0]), &(scratch->k[0][x_grp][x_dim]));
+            arpra_add(&(scratch->x_new[x_grp][x_dim]), &(system->x[x_grp][x_dim]), &(scratch->temp_x));
+            arpra_mul(&(scratch->temp_x), &(scratch->bh[1]), &(scratch->k[1][x_grp][x_dim]));
+            arpra_add(&(scratch->x_new[x_grp][x_dim]), &(scratch->x_new[x_grp][x_dim]), &(scratch->temp_x));
+            arpra_add(&(scratch->temp_x), &(scratch->k[0][x_grp][x_dim]), &(scratch->k[1][x_grp][x_dim]));
+            arpra_mul(&(scratch->error[x_grp][x_dim]), &(scratch->bh[1]), &(scratch->temp_x));
+        }
+    }
+
+    // Advance system, keeping the old state in scratch memory.
+    arpra_swap(system->t, &(scratch->temp_t));
+    arpra_swap(&(scratch->t_new), &(scratch->temp_t));
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            arpra_swap(&(system->x[x_grp][x_dim]), &(scratch->x_new[x_grp][x_dim]));
+        }
+    }
+}
+
+static void ros2_reject (arpra_ode_stepper *stepper)
+{
+    arpra_uint x_grp, x_dim;
+    arpra_ode_system *system;
+    ros2_scratch *scratch;
+
+    system = stepper->system;
+    scratch = (ros2_scratch *) stepper->scratch;
+
+    // Restore the state from before the last step.
+    arpra_swap(system->t, &(scratch->t_new));
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            arpra_swap(&(system->x[x_grp][x_dim]), &(scratch->x_new[x_grp][x_dim]));
+        }
+    }
+}
+
+static const arpra_ode_method ros2 =
+{
+    .init = &ros2_init,
+    .clear = &ros2_clear,
+    .step = &ros2_step,
+    .reject = &ros2_reject,
+    .invalidate = NULL,
+    .interpolate = NULL,
+    .save = NULL,
+    .load = NULL,
+    .stages = ros2_stages,
+    .order = 2,
+    .error_order = 1,
+};
+
+const arpra_ode_method *arpra_ode_ros2 = &ros2;
@@ -0,0 +1,69 @@
+/*
+ * ode_run.c -- Step an ODE system over many steps.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * Advance the system n_steps steps of size h. The scratch memory of the
+ * stepper, and the step-scaled constants of the method, are kept between
+ * steps, so only the first step pays for their setup.
+ *
+ * If reduce is not NULL, it replaces the stepper's reduction policy for
+ * the run. If observer is not NULL, its observe function is called every
+ * interval steps (or only after the last step, if interval is zero).
+ */
+
+void arpra_ode_stepper_run (arpra_ode_stepper *stepper, const arpra_range *h, arpra_uint n_steps,
+                            const arpra_ode_observer *observer, arpra_ode_reduce *reduce)
+{
+    arpra_uint step, next_report, symbol_start;
+    arpra_ode_reduce *reduce_old;
+    const arpra_ode_method *method;
+
+    method = stepper->method;
+    reduce_old = stepper->reduce;
+    if (reduce != NULL) {
+        stepper->reduce = reduce;
+    }
+
+    next_report = n_steps;
+    if ((observer != NULL) && (observer->interval > 0) && (observer->interval < n_steps)) {
+        next_report = observer->interval;
+    }
+
+    for (step = 1; step <= n_steps; step++) {
+        symbol_start = arpra_helper_get_symbol_count();
+        method->step(stepper, h);
+        arpra_helper_ode_reduce(stepper, symbol_start);
+
+        if ((observer != NULL) && (step == next_report)) {
+            observer->observe(observer->data, stepper->system, step);
+            if ((observer->interval > 0) && (n_steps - step > observer->interval)) {
+                next_report += observer->interval;
+            }
+            else {
+                next_report = n_steps;
+            }
+        }
+    }
+
+    stepper->reduce = reduce_old;
+}
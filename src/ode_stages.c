@@ -0,0 +1,325 @@
+/*
+ * ode_stages.c -- Explicit Runge-Kutta stage evaluation and scheduling.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * Compute the stages of an explicit Runge-Kutta step:
+ *
+ * x_i = x(t) + ah[i][0] k[0] + ... + ah[i][i - 1] k[i - 1]
+ * k[i] = f(t_stage[i], x_i)
+ *
+ * Stages before first are already in k. On return, x_out holds the state
+ * of the last stage. Each stage state is one fused sum, in which the zero
+ * coefficients of sparse tableaus are skipped.
+ *
+ * If the system declares which groups each group reads, the stages of
+ * different groups are run as a task graph. The state of stage i of group
+ * g waits for the earlier stages of group g only, and stage i of group g
+ * waits for the states of stage i of the groups it reads, and for the
+ * coupled sums of stage i. Independent groups can then run ahead into
+ * later stages while slower groups finish earlier ones.
+ */
+
+typedef struct stages_graph_struct
+{
+    arpra_ode_stepper *stepper;
+    arpra_range ***k;
+    arpra_range ***x_stage;
+    arpra_range **ah;
+    const arpra_range *t_stage;
+    arpra_uint stages;
+    arpra_uint first;
+    arpra_uint grps;
+    arpra_uint n_coupling;
+    char *reads;
+    arpra_int *count;
+} stages_graph;
+
+// Task ids: state S(i, g), stage K(i, g), and coupled sums C(i, c).
+#define STAGES_S(G, i, g) (((i) * (G)->grps) + (g))
+#define STAGES_K(G, i, g) ((((G)->stages + (i)) * (G)->grps) + (g))
+#define STAGES_C(G, i, c) ((2 * (G)->stages * (G)->grps) + ((i) * (G)->n_coupling) + (c))
+
+/*
+ * y = x + w[0] k[0] + ... + w[n - 1] k[n - 1], for one state variable, as a
+ * single fused sum with one new error term. The term x may be NULL, and
+ * terms with zero weight are skipped. Products with weights that carry
+ * deviation terms are bounded using the current multiplication method.
+ */
+
+void arpra_helper_ode_combine (arpra_range *y, const arpra_range *x, arpra_range ***k,
+                               const arpra_range *w, arpra_uint n,
+                               arpra_uint x_grp, arpra_uint x_dim)
+{
+    arpra_uint k_j;
+    arpra_accumulator acc;
+
+    arpra_accumulator_init(&acc, arpra_get_precision(y));
+    if (x != NULL) {
+        arpra_accumulator_add(&acc, x);
+    }
+    for (k_j = 0; k_j < n; k_j++) {
+        if (arpra_zero_p(&(w[k_j]))) continue;
+        arpra_accumulator_add_product(&acc, &(w[k_j]), &(k[k_j][x_grp][x_dim]));
+    }
+    arpra_accumulator_finalise(y, &acc);
+    arpra_accumulator_clear(&acc);
+}
+
+static void stages_state (arpra_ode_stepper *stepper, arpra_range **x_new, arpra_range ***k,
+                          arpra_range **ah, arpra_uint k_i, arpra_uint x_grp)
+{
+    arpra_uint x_dim;
+    arpra_ode_system *system;
+
+    system = stepper->system;
+
+    // x(t + c_i h) = x(t) + a_i0 h k[0] + ... + a_is h k[s]
+    for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+        arpra_helper_ode_combine(&(x_new[x_grp][x_dim]), &(system->x[x_grp][x_dim]),
+                                 k, ah[k_i], k_i, x_grp, x_dim);
+    }
+}
+
+static void stages_release (stages_graph *graph, arpra_uint id);
+
+static void stages_run (stages_graph *graph, arpra_uint id)
+{
+    arpra_uint k_i, x_grp, c, n_s, n_k;
+    arpra_ode_system *system;
+
+    system = graph->stepper->system;
+    n_s = graph->stages * graph->grps;
+    n_k = 2 * n_s;
+
+    if (id < n_s) {
+        k_i = id / graph->grps;
+        x_grp = id % graph->grps;
+        stages_state(graph->stepper, graph->x_stage[k_i], graph->k, graph->ah, k_i, x_grp);
+    }
+    else if (id < n_k) {
+        k_i = (id - n_s) / graph->grps;
+        x_grp = (id - n_s) % graph->grps;
+        arpra_helper_ode_eval_grp(graph->stepper, graph->k[k_i][x_grp], &(graph->t_stage[k_i]),
+                                  (const arpra_range **) graph->x_stage[k_i], x_grp);
+    }
+    else {
+        k_i = (id - n_k) / graph->n_coupling;
+        c = (id - n_k) % graph->n_coupling;
+        arpra_ode_coupling_sum(&(system->coupling[c]), (const arpra_range **) graph->x_stage[k_i]);
+    }
+
+    stages_release(graph, id);
+}
+
+static void stages_notify (stages_graph *graph, arpra_uint id)
+{
+    arpra_int count;
+
+    #pragma omp atomic capture
+    count = --(graph->count[id]);
+
+    if (count == 0) {
+        #pragma omp task firstprivate(graph, id)
+        stages_run(graph, id);
+    }
+}
+
+static void stages_release (stages_graph *graph, arpra_uint id)
+{
+    arpra_uint k_i, k_j, x_grp, y_grp, c, n_s, n_k;
+    arpra_ode_system *system;
+
+    system = graph->stepper->system;
+    n_s = graph->stages * graph->grps;
+    n_k = 2 * n_s;
+
+    if (id < n_s) {
+        // S(i, g) releases K(i, h) for every h that reads g, and C(i, c) from g.
+        k_i = id / graph->grps;
+        x_grp = id % graph->grps;
+        for (y_grp = 0; y_grp < graph->grps; y_grp++) {
+            if (graph->reads[(y_grp * graph->grps) + x_grp] && (k_i >= graph->first)) {
+                stages_notify(graph, STAGES_K(graph, k_i, y_grp));
+            }
+        }
+        for (c = 0; c < graph->n_coupling; c++) {
+            if ((system->coupling[c].x_grp == x_grp) && (k_i >= graph->first)) {
+                stages_notify(graph, STAGES_C(graph, k_i, c));
+            }
+        }
+    }
+    else if (id < n_k) {
+        // K(i, g) releases S(j, g) for j > i, and C(i + 1, c), which reuses the sums.
+        k_i = (id - n_s) / graph->grps;
+        x_grp = (id - n_s) % graph->grps;
+        for (k_j = k_i + 1; k_j < graph->stages; k_j++) {
+            stages_notify(graph, STAGES_S(graph, k_j, x_grp));
+        }
+        if ((k_i + 1) < graph->stages) {
+            for (c = 0; c < graph->n_coupling; c++) {
+                stages_notify(graph, STAGES_C(graph, k_i + 1, c));
+            }
+        }
+    }
+    else {
+        // C(i, c) releases K(i, h) for every h.
+        k_i = (id - n_k) / graph->n_coupling;
+        if (k_i >= graph->first) {
+            for (y_grp = 0; y_grp < graph->grps; y_grp++) {
+                stages_notify(graph, STAGES_K(graph, k_i, y_grp));
+            }
+        }
+    }
+}
+
+static void stages_scheduled (arpra_ode_stepper *stepper, arpra_range ***k, arpra_range **x_out,
+                              arpra_range **ah, const arpra_range *t_stage,
+                              arpra_uint stages, arpra_uint first)
+{
+    arpra_uint k_i, x_grp, x_dim, y_grp, c, i, n_tasks, n_reads, state_size;
+    arpra_range *_x_stage;
+    arpra_ode_system *system;
+    stages_graph graph;
+    arpra_prec prec_x;
+
+    system = stepper->system;
+
+    // Initialise the graph.
+    graph.stepper = stepper;
+    graph.k = k;
+    graph.ah = ah;
+    graph.t_stage = t_stage;
+    graph.stages = stages;
+    graph.first = first;
+    graph.grps = system->grps;
+    graph.n_coupling = system->n_coupling;
+    n_tasks = (2 * stages * system->grps) + (stages * system->n_coupling);
+    graph.reads = calloc(system->grps * system->grps, sizeof(char));
+    graph.count = malloc(n_tasks * sizeof(arpra_int));
+    for (y_grp = 0; y_grp < system->grps; y_grp++) {
+        graph.reads[(y_grp * system->grps) + y_grp] = 1;
+        for (i = 0; i < system->n_deps[y_grp]; i++) {
+            graph.reads[(y_grp * system->grps) + system->deps[y_grp][i]] = 1;
+        }
+    }
+
+    // Allocate stage states. The first stage is x(t), and the last is x_out.
+    for (x_grp = 0, state_size = 0; x_grp < system->grps; x_grp++) {
+        state_size += system->dims[x_grp];
+    }
+    _x_stage = malloc(((stages > 2) ? (stages - 2) : 0) * state_size * sizeof(arpra_range));
+    graph.x_stage = malloc(stages * sizeof(arpra_range **));
+    graph.x_stage[0] = system->x;
+    for (k_i = 1; k_i < stages; k_i++) {
+        if ((k_i + 1) == stages) {
+            graph.x_stage[k_i] = x_out;
+            continue;
+        }
+        graph.x_stage[k_i] = malloc(system->grps * sizeof(arpra_range *));
+        for (x_grp = 0, i = (k_i - 1) * state_size; x_grp < system->grps; x_grp++) {
+            graph.x_stage[k_i][x_grp] = &(_x_stage[i]);
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++, i++) {
+                prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
+                arpra_init2(&(_x_stage[i]), prec_x);
+            }
+        }
+    }
+
+    // Count the predecessors of each task. Tasks that do not run get -1.
+    for (k_i = 0; k_i < stages; k_i++) {
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (n_reads = 0, y_grp = 0; y_grp < system->grps; y_grp++) {
+                n_reads += graph.reads[(x_grp * system->grps) + y_grp];
+            }
+            graph.count[STAGES_S(&graph, k_i, x_grp)] =
+                (k_i == 0) ? -1 : (arpra_int) (k_i - ((first < k_i) ? first : k_i));
+            graph.count[STAGES_K(&graph, k_i, x_grp)] =
+                (k_i < first) ? -1 : (arpra_int) (((k_i > 0) ? n_reads : 0) + system->n_coupling);
+        }
+        // The sums of known stages are not needed, and writing them could
+        // race with the sums of stage first, which wait for no stage task.
+        for (c = 0; c < system->n_coupling; c++) {
+            graph.count[STAGES_C(&graph, k_i, c)] = (k_i < first) ? -1 :
+                (arpra_int) (((k_i > 0) ? 1 : 0) + (((k_i > 0) && ((k_i - 1) >= first)) ? system->grps : 0));
+        }
+    }
+
+    // Run the graph from the tasks with no predecessors.
+    #pragma omp parallel
+    #pragma omp single
+    {
+        for (i = 0; i < n_tasks; i++) {
+            if (graph.count[i] == 0) {
+                #pragma omp task firstprivate(i)
+                stages_run(&graph, i);
+            }
+        }
+    }
+
+    // Clear the stage states.
+    for (k_i = 1; (k_i + 1) < stages; k_i++) {
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+                arpra_clear(&(graph.x_stage[k_i][x_grp][x_dim]));
+            }
+        }
+        free(graph.x_stage[k_i]);
+    }
+    free(_x_stage);
+    free(graph.x_stage);
+    free(graph.reads);
+    free(graph.count);
+}
+
+void arpra_helper_ode_stages (arpra_ode_stepper *stepper, arpra_range ***k, arpra_range **x_out,
+                              arpra_range **ah, const arpra_range *t_stage,
+                              arpra_uint stages, arpra_uint first)
+{
+    arpra_uint k_i, x_grp;
+    arpra_range **x_old;
+    arpra_ode_system *system;
+
+    system = stepper->system;
+
+    if (system->deps != NULL) {
+        stages_scheduled(stepper, k, x_out, ah, t_stage, stages, first);
+        return;
+    }
+
+    for (k_i = 0; k_i < stages; k_i++) {
+        x_old = (k_i == 0) ? system->x : x_out;
+
+        // x(t + c_i h) = x(t) + a_i0 h k[0] + ... + a_is h k[s]
+        if (k_i > 0) {
+            for (x_grp = 0; x_grp < system->grps; x_grp++) {
+                stages_state(stepper, x_out, k, ah, k_i, x_grp);
+            }
+        }
+
+        // Skip stages that are already known.
+        if (k_i < first) continue;
+
+        // k[i] = f(t + c_i h, x(t) + a_i0 h k[0] + ... + a_is h k[s])
+        arpra_helper_ode_eval(stepper, k[k_i], &(t_stage[k_i]), (const arpra_range **) x_old);
+    }
+}
@@ -24,15 +24,146 @@
 void arpra_ode_stepper_init (arpra_ode_stepper *stepper, arpra_ode_system *system,
                              const arpra_ode_method *method)
 {
+    arpra_uint x_grp, i;
+    arpra_prec prec_x;
+
     method->init(stepper, system);
+    stepper->reduce = NULL;
+    stepper->temp = NULL;
+    stepper->record = NULL;
+
+    // Methods carrying data between steps (those which can invalidate it)
+    // check it against the last state. Other methods keep no record.
+    if (method->invalidate != NULL) {
+        stepper->record = arpra_helper_ode_record_init(system);
+    }
+
+    // Allocate scratch ranges for group callbacks, at the group's precision.
+    if ((system->f_grp != NULL) && (system->f_grp_temps != NULL)) {
+        stepper->temp = malloc(system->grps * sizeof(arpra_range *));
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            prec_x = (system->dims[x_grp] > 0) ?
+                arpra_get_precision(&(system->x[x_grp][0])) : arpra_get_default_precision();
+            stepper->temp[x_grp] = malloc(system->f_grp_temps[x_grp] * sizeof(arpra_range));
+            for (i = 0; i < system->f_grp_temps[x_grp]; i++) {
+                arpra_init2(&(stepper->temp[x_grp][i]), prec_x);
+            }
+        }
+    }
 }
 
 void arpra_ode_stepper_clear (arpra_ode_stepper *stepper)
 {
+    arpra_uint x_grp, i;
+    arpra_ode_system *system;
+
+    system = stepper->system;
     stepper->method->clear(stepper);
+
+    if (stepper->temp != NULL) {
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (i = 0; i < system->f_grp_temps[x_grp]; i++) {
+                arpra_clear(&(stepper->temp[x_grp][i]));
+            }
+            free(stepper->temp[x_grp]);
+        }
+        free(stepper->temp);
+    }
+
+    if (stepper->record != NULL) {
+        arpra_helper_ode_record_clear(stepper->record);
+    }
 }
 
 void arpra_ode_stepper_step (arpra_ode_stepper *stepper, const arpra_range *h)
 {
+    arpra_uint symbol_start;
+
+    symbol_start = arpra_helper_get_symbol_count();
     stepper->method->step(stepper, h);
+    arpra_helper_ode_reduce(stepper, symbol_start);
+}
+
+void arpra_ode_stepper_renumber (arpra_ode_stepper *stepper, arpra_range **extra,
+                                 arpra_uint n_extra)
+{
+    arpra_uint x_grp, x_dim, c, k, i, n;
+    arpra_range **live;
+    arpra_ode_system *system;
+    arpra_ode_coupling *coupling;
+    arpra_ode_reduce *reduce;
+    const arpra_ode_method *method;
+
+    method = stepper->method;
+    system = stepper->system;
+    reduce = stepper->reduce;
+
+    // Scratch ranges, including step size dependent coefficients, are not
+    // renumbered, so the stepper is restarted.
+    method->clear(stepper);
+
+    // Renumber the system state, the coupling weights and sums, and the extra ranges.
+    for (x_grp = 0, n = n_extra + 1; x_grp < system->grps; x_grp++) {
+        n += system->dims[x_grp];
+    }
+    for (c = 0; c < system->n_coupling; c++) {
+        coupling = &(system->coupling[c]);
+        n += coupling->rows;
+        if (coupling->weight != NULL) {
+            n += coupling->row[coupling->rows];
+        }
+    }
+    live = malloc(n * sizeof(arpra_range *));
+    for (i = 0; i < n_extra; i++) {
+        live[i] = extra[i];
+    }
+    live[i++] = system->t;
+    for (x_grp = 0; x_grp < system->grps; x_grp++) {
+        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+            live[i++] = &(system->x[x_grp][x_dim]);
+        }
+    }
+    for (c = 0; c < system->n_coupling; c++) {
+        coupling = &(system->coupling[c]);
+        for (k = 0; k < coupling->rows; k++) {
+            live[i++] = &(coupling->sum[k]);
+        }
+        if (coupling->weight != NULL) {
+            for (k = 0; k < coupling->row[coupling->rows]; k++) {
+                live[i++] = (arpra_range *) &(coupling->weight[k]);
+            }
+        }
+    }
+    arpra_renumber_symbols(live, n);
+    free(live);
+
+    method->init(stepper, system);
+    stepper->reduce = reduce;
+}
+
+void arpra_ode_stepper_invalidate (arpra_ode_stepper *stepper)
+{
+    if (stepper->method->invalidate != NULL) {
+        stepper->method->invalidate(stepper);
+    }
+}
+
+void arpra_ode_stepper_interpolate (arpra_ode_stepper *stepper, arpra_range **x,
+                                   const arpra_range *t)
+{
+    arpra_uint x_grp, x_dim;
+    arpra_ode_system *system;
+
+    // Methods without dense output return the current state.
+    if (stepper->method->interpolate != NULL) {
+        stepper->method->interpolate(stepper, x, t);
+    }
+    else {
+        system = stepper->system;
+        for (x_grp = 0; x_grp < system->grps; x_grp++) {
+            for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
+                arpra_set(&(x[x_grp][x_dim]), &(system->x[x_grp][x_dim]));
+            }
+        }
+    }
 }
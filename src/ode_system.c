@@ -0,0 +1,51 @@
+/*
+ * ode_system.c -- Initialise an ODE system definition.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * Set the required fields of an ODE system, and set the optional fields
+ * (group callbacks, Jacobians, coupling, dependencies and events) to NULL or
+ * zero, so that they can then be set individually. Systems which are not
+ * zero-initialised should be initialised this way, since new optional fields
+ * may be added to the system definition.
+ */
+
+void arpra_ode_system_init (arpra_ode_system *system, arpra_ode_f *f, void **params,
+                            arpra_range *t, arpra_range **x, arpra_uint grps, arpra_uint *dims)
+{
+    system->f = f;
+    system->f_grp = NULL;
+    system->f_grp_temps = NULL;
+    system->jac = NULL;
+    system->params = params;
+    system->t = t;
+    system->x = x;
+    system->grps = grps;
+    system->dims = dims;
+    system->coupling = NULL;
+    system->n_coupling = 0;
+    system->deps = NULL;
+    system->n_deps = NULL;
+    system->events = NULL;
+    system->n_events = 0;
+    system->precision_generation = 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * ode_tableau.c -- Shared cache of step method constants.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * Step methods compute their constants once per method and precision, and
+ * every stepper of that method and precision shares them read-only. Each
+ * method is identified by a key, such as the address of its definition. The
+ * cache is built lazily, and lives until arpra_ode_clear_tableaus is
+ * called, which must not happen while any stepper is still in use. The
+ * symbols of the constants are reserved, so that renumbering never reuses
+ * them.
+ */
+
+typedef struct tableau_entry_struct tableau_entry;
+struct tableau_entry_struct
+{
+    const void *key;
+    arpra_prec prec;
+    void *tableau;
+    void (*clear) (void *tableau);
+    tableau_entry *next;
+};
+
+static tableau_entry *tableau_cache = NULL;
+
+const void *arpra_helper_ode_tableau (const void *key, arpra_prec prec,
+                                      void *(*build) (const void *key, arpra_prec prec),
+                                      void (*clear) (void *tableau))
+{
+    tableau_entry *entry;
+    const void *tableau;
+
+    #pragma omp critical (arpra_ode_tableau)
+    {
+        for (entry = tableau_cache; entry != NULL; entry = entry->next) {
+            if ((entry->key == key) && (entry->prec == prec)) break;
+        }
+
+        // Build the constants on first use.
+        if (entry == NULL) {
+            entry = malloc(sizeof(tableau_entry));
+            entry->key = key;
+            entry->prec = prec;
+            entry->tableau = build(key, prec);
+            arpra_helper_reserve_symbols();
+            entry->clear = clear;
+            entry->next = tableau_cache;
+            tableau_cache = entry;
+        }
+
+        tableau = entry->tableau;
+    }
+
+    return tableau;
+}
+
+void arpra_ode_clear_tableaus ()
+{
+    tableau_entry *entry;
+
+    #pragma omp critical (arpra_ode_tableau)
+    {
+        while (tableau_cache != NULL) {
+            entry = tableau_cache;
+            tableau_cache = entry->next;
+            entry->clear(entry->tableau);
+            free(entry);
+        }
+    }
+}
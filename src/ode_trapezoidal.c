@@ -23,181 +23,52 @@
 
 #define trapezoidal_stages 2
 
-typedef struct trapezoidal_scratch_struct
+// Butcher tableau, with each coefficient a fraction {numerator, denominator}.
+// Row i of a holds a_i0, ..., a_i(i-1).
+static const double trapezoidal_a[(trapezoidal_stages * (trapezoidal_stages - 1)) / 2][2] =
 {
-    arpra_range *_k_0;
-    arpra_range **k_0;
-    arpra_range *_k_1;
-    arpra_range **k_1;
-    arpra_range *_x_new;
-    arpra_range **x_new;
-    arpra_range half;
-    arpra_range half_h;
-    arpra_range temp_t;
-    arpra_range temp_x;
-} trapezoidal_scratch;
+    {1., 1.},
+};
 
-static void trapezoidal_init (arpra_ode_stepper *stepper, arpra_ode_system *system)
+static const double trapezoidal_b[trapezoidal_stages][2] =
 {
-    arpra_uint x_grp, x_dim, state_size;
-    arpra_prec prec_x, prec_internal;
-    trapezoidal_scratch *scratch;
-
-    // Allocate scratch memory.
-    scratch = malloc(sizeof(trapezoidal_scratch));
-    for (x_grp = 0, state_size = 0; x_grp < system->grps; x_grp++) {
-        state_size += system->dims[x_grp];
-    }
-    scratch->_k_0 = malloc(state_size * sizeof(arpra_range));
-    scratch->k_0 = malloc(system->grps * sizeof(arpra_range *));
-    scratch->_k_1 = malloc(state_size * sizeof(arpra_range));
-    scratch->k_1 = malloc(system->grps * sizeof(arpra_range *));
-    scratch->_x_new = malloc(state_size * sizeof(arpra_range));
-    scratch->x_new = malloc(system->grps * sizeof(arpra_range *));
-
-    // Initialise scratch memory.
-    prec_internal = arpra_get_internal_precision();
-    scratch->k_0[0] = scratch->_k_0;
-    scratch->k_1[0] = scratch->_k_1;
-    scratch->x_new[0] = scratch->_x_new;
-    for (x_grp = 1; x_grp < system->grps; x_grp++) {
-        scratch->k_0[x_grp] = scratch->k_0[x_grp - 1] + system->dims[x_grp - 1];
-        scratch->k_1[x_grp] = scratch->k_1[x_grp - 1] + system->dims[x_grp - 1];
-        scratch->x_new[x_grp] = scratch->x_new[x_grp - 1] + system->dims[x_grp - 1];
-    }
-    for (x_grp = 0; x_grp < system->grps; x_grp++) {
-        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
-            prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
-            arpra_init2(&(scratch->k_0[x_grp][x_dim]), prec_x);
-            arpra_init2(&(scratch->k_1[x_grp][x_dim]), prec_x);
-            arpra_init2(&(scratch->x_new[x_grp][x_dim]), prec_x);
-        }
-    }
-    arpra_init2(&(scratch->half), 2);
-    arpra_init2(&(scratch->half_h), prec_internal);
-    arpra_init2(&(scratch->temp_t), prec_internal);
-    arpra_init2(&(scratch->temp_x), prec_internal);
-
-    // Set stepper parameters.
-    stepper->method = arpra_ode_trapezoidal;
-    stepper->system = system;
-    stepper->error = NULL;
-    stepper->scratch = scratch;
-
-    // Precompute constants.
-    arpra_set_d(&(scratch->half), 0.5);
-}
+    {1., 2.}, {1., 2.},
+};
 
-static void trapezoidal_clear (arpra_ode_stepper *stepper)
+static const double trapezoidal_c[trapezoidal_stages][2] =
 {
-    arpra_uint x_grp, x_dim;
-    arpra_ode_system *system;
-    trapezoidal_scratch *scratch;
-
-    system = stepper->system;
-    scratch = (trapezoidal_scratch *) stepper->scratch;
-
-    // Clear scratch memory.
-    for (x_grp = 0; x_grp < system->grps; x_grp++) {
-        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
-            arpra_clear(&(scratch->k_0[x_grp][x_dim]));
-            arpra_clear(&(scratch->k_1[x_grp][x_dim]));
-            arpra_clear(&(scratch->x_new[x_grp][x_dim]));
-        }
-    }
-    arpra_clear(&(scratch->half));
-    arpra_clear(&(scratch->half_h));
-    arpra_clear(&(scratch->temp_t));
-    arpra_clear(&(scratch->temp_x));
-
-    // Free scratch memory.
-    free(scratch->_k_0);
-    free(scratch->k_0);
-    free(scratch->_k_1);
-    free(scratch->k_1);
-    free(scratch->_x_new);
-    free(scratch->x_new);
-    free(scratch);
-}
+    {0., 1.}, {1., 1.},
+};
 
-static void trapezoidal_step (arpra_ode_stepper *stepper, const arpra_range *h)
+static const arpra_ode_erk trapezoidal_erk =
 {
-    arpra_uint x_grp, x_dim;
-    arpra_prec prec_t, prec_x;
-    arpra_ode_system *system;
-    trapezoidal_scratch *scratch;
-
-    system = stepper->system;
-    scratch = (trapezoidal_scratch *) stepper->scratch;
-
-    // Synchronise scratch precision and prepare step parameters.
-    prec_t = arpra_get_precision(system->t);
-    for (x_grp = 0; x_grp < system->grps; x_grp++) {
-        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
-            prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
-            arpra_set_precision(&(scratch->k_0[x_grp][x_dim]), prec_x);
-            arpra_set_precision(&(scratch->k_1[x_grp][x_dim]), prec_x);
-            arpra_set_precision(&(scratch->x_new[x_grp][x_dim]), prec_x);
-        }
-    }
-    arpra_set_precision(&(scratch->half_h), prec_t);
-    arpra_mul(&(scratch->half_h), &(scratch->half), h);
-    arpra_set_precision(&(scratch->temp_t), prec_t);
-    arpra_add(&(scratch->temp_t), system->t, h);
-
-    // k[0] = f(t, x(t))
-    for (x_grp = 0; x_grp < system->grps; x_grp++) {
-        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
-            system->f[x_grp](&(scratch->k_0[x_grp][x_dim]), system->params[x_grp],
-                             system->t, (const arpra_range **) system->x, x_grp, x_dim);
-        }
-    }
-
-    // x(t + h) = x(t) + h k[0]
-    for (x_grp = 0; x_grp < system->grps; x_grp++) {
-        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
-            prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
-            arpra_set_precision(&(scratch->temp_x), prec_x);
-            arpra_mul(&(scratch->temp_x), h, &(scratch->k_0[x_grp][x_dim]));
-            arpra_add(&(scratch->x_new[x_grp][x_dim]), &(system->x[x_grp][x_dim]), &(scratch->temp_x));
-        }
-    }
-
-    // k[1] = f(t + h, x(t) + h k[0])
-    for (x_grp = 0; x_grp < system->grps; x_grp++) {
-        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
-            system->f[x_grp](&(scratch->k_1[x_grp][x_dim]), system->params[x_grp],
-                             &(scratch->temp_t), (const arpra_range **) scratch->x_new, x_grp, x_dim);
-        }
-    }
-
-    // x(t + h) = x(t) + 1/2 h k[0] + 1/2 h k[1]
-    for (x_grp = 0; x_grp < system->grps; x_grp++) {
-        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
-            prec_x = arpra_get_precision(&(system->x[x_grp][x_dim]));
-            arpra_set_precision(&(scratch->temp_x), prec_x);
-            arpra_mul(&(scratch->temp_x), &(scratch->half_h), &(scratch->k_0[x_grp][x_dim]));
-            arpra_add(&(scratch->x_new[x_grp][x_dim]), &(system->x[x_grp][x_dim]), &(scratch->temp_x));
-            arpra_mul(&(scratch->temp_x), &(scratch->half_h), &(scratch->k_1[x_grp][x_dim]));
-            arpra_add(&(scratch->x_new[x_grp][x_dim]), &(scratch->x_new[x_grp][x_dim]), &(scratch->temp_x));
-        }
-    }
+    .stages = trapezoidal_stages,
+    .a = trapezoidal_a,
+    .b = trapezoidal_b,
+    .b_err = NULL,
+    .c = trapezoidal_c,
+    .d = NULL,
+    .fsal = 0,
+};
 
-    // Advance system.
-    arpra_add(system->t, system->t, h);
-    for (x_grp = 0; x_grp < system->grps; x_grp++) {
-        for (x_dim = 0; x_dim < system->dims[x_grp]; x_dim++) {
-            arpra_set(&(system->x[x_grp][x_dim]), &(scratch->x_new[x_grp][x_dim]));
-        }
-    }
+static void trapezoidal_init (arpra_ode_stepper *stepper, arpra_ode_system *system)
+{
+    arpra_helper_ode_erk_init(stepper, system, arpra_ode_trapezoidal, &trapezoidal_erk);
 }
 
 static const arpra_ode_method trapezoidal =
 {
     .init = &trapezoidal_init,
-    .clear = &trapezoidal_clear,
-    .step = &trapezoidal_step,
+    .clear = &arpra_helper_ode_erk_clear,
+    .step = &arpra_helper_ode_erk_step,
+    .reject = &arpra_helper_ode_erk_reject,
+    .invalidate = NULL,
+    .interpolate = &arpra_helper_ode_erk_interpolate,
+    .save = &arpra_helper_ode_erk_save,
+    .load = &arpra_helper_ode_erk_load,
     .stages = trapezoidal_stages,
+    .order = 2,
+    .error_order = 0,
 };
 
 const arpra_ode_method *arpra_ode_trapezoidal = &trapezoidal;
@@ -0,0 +1,208 @@
+/*
+ * reduce_vector.c -- Jointly reduce the deviation terms of a vector of ranges.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * The n ranges x[i] form a zonotope whose generators are the symbols, with
+ * one coordinate per range. Following Girard's and Kuhn's zonotope order
+ * reduction, each generator g is scored by |g|_1 - |g|_inf, which is small
+ * when g is short or nearly parallel to an axis. The k generators with the
+ * largest scores are kept in every range, preserving their correlations.
+ * The rest are enclosed by their interval hull, which adds one new symbol
+ * per range.
+ */
+
+static int reduce_vector_cmp (const void *a, const void *b)
+{
+    arpra_uint sa = *((const arpra_uint *) a);
+    arpra_uint sb = *((const arpra_uint *) b);
+
+    return (sa > sb) - (sa < sb);
+}
+
+static arpra_uint reduce_vector_index (const arpra_uint *symbols, arpra_uint m, arpra_uint symbol)
+{
+    const arpra_uint *found;
+
+    found = bsearch(&symbol, symbols, m, sizeof(arpra_uint), &reduce_vector_cmp);
+    return found - symbols;
+}
+
+void arpra_reduce_vector (arpra_range *y, const arpra_range *x, arpra_uint n, arpra_uint k)
+{
+    mpfr_t error, temp;
+    mpfr_ptr score, *score_ptr, norm_inf, sum_x, *sum_x_ptr;
+    arpra_range *yy;
+    arpra_prec prec_internal;
+    arpra_uint i, j, m, n_sym, i_y, i_x, n_merge, *symbols;
+    char *merge;
+
+    // Collect the symbols of all bounded ranges.
+    for (i = 0, n_sym = 0; i < n; i++) {
+        if (arpra_bounded_p(&(x[i]))) n_sym += x[i].nTerms;
+    }
+    symbols = malloc((n_sym + 1) * sizeof(arpra_uint));
+    for (i = 0, n_sym = 0; i < n; i++) {
+        if (!arpra_bounded_p(&(x[i]))) continue;
+        for (i_x = 0; i_x < x[i].nTerms; i_x++) {
+            symbols[n_sym++] = x[i].symbols[i_x];
+        }
+    }
+    qsort(symbols, n_sym, sizeof(arpra_uint), &reduce_vector_cmp);
+    for (j = 0, m = 0; j < n_sym; j++) {
+        if ((m == 0) || (symbols[j] != symbols[m - 1])) symbols[m++] = symbols[j];
+    }
+
+    // Handle trivial cases.
+    if (m <= k) {
+        for (i = 0; i < n; i++) {
+            arpra_set(&(y[i]), &(x[i]));
+        }
+        free(symbols);
+        return;
+    }
+
+    // Initialise vars.
+    prec_internal = arpra_get_internal_precision();
+    mpfr_init2(error, prec_internal);
+    mpfr_init2(temp, prec_internal);
+    score = malloc(m * sizeof(mpfr_t));
+    score_ptr = malloc(m * sizeof(mpfr_ptr));
+    norm_inf = malloc(m * sizeof(mpfr_t));
+    merge = calloc(m, sizeof(char));
+    yy = malloc(n * sizeof(arpra_range));
+    for (j = 0; j < m; j++) {
+        mpfr_init2(&(score[j]), prec_internal);
+        mpfr_init2(&(norm_inf[j]), prec_internal);
+        mpfr_set_zero(&(score[j]), 1);
+        mpfr_set_zero(&(norm_inf[j]), 1);
+        score_ptr[j] = &(score[j]);
+    }
+
+    // score = |g|_1 - |g|_inf
+    for (i = 0; i < n; i++) {
+        if (!arpra_bounded_p(&(x[i]))) continue;
+        for (i_x = 0; i_x < x[i].nTerms; i_x++) {
+            j = reduce_vector_index(symbols, m, x[i].symbols[i_x]);
+            mpfr_abs(temp, &(x[i].deviations[i_x]), MPFR_RNDN);
+            mpfr_add(&(score[j]), &(score[j]), temp, MPFR_RNDN);
+            mpfr_max(&(norm_inf[j]), &(norm_inf[j]), temp, MPFR_RNDN);
+        }
+    }
+    for (j = 0; j < m; j++) {
+        mpfr_sub(&(score[j]), &(score[j]), &(norm_inf[j]), MPFR_RNDN);
+    }
+
+    // Select the generators to merge.
+    n_merge = m - k;
+    arpra_helper_select_abs(score_ptr, m, n_merge);
+    for (j = 0; j < n_merge; j++) {
+        merge[score_ptr[j] - score] = 1;
+    }
+
+    // Reduce each range with the common set of merged symbols.
+    for (i = 0; i < n; i++) {
+        arpra_init2(&(yy[i]), y[i].precision);
+
+        // Handle domain violations.
+        if (arpra_nan_p(&(x[i]))) {
+            arpra_set_nan(&(yy[i]));
+            continue;
+        }
+        if (arpra_inf_p(&(x[i]))) {
+            arpra_set_inf(&(yy[i]));
+            continue;
+        }
+
+        sum_x = malloc((x[i].nTerms + 1) * sizeof(mpfr_t));
+        sum_x_ptr = malloc((x[i].nTerms + 1) * sizeof(mpfr_ptr));
+        mpfr_set_zero(error, 1);
+
+        // y[0] = x[0]
+        ARPRA_MPFR_RNDERR_SET(error, MPFR_RNDN, &(yy[i].centre), &(x[i].centre));
+
+        // Allocate memory for deviation terms.
+        yy[i].symbols = malloc((x[i].nTerms + 1) * sizeof(arpra_uint));
+        yy[i].deviations = malloc((x[i].nTerms + 1) * sizeof(mpfr_t));
+
+        for (i_y = 0, i_x = 0; i_x < x[i].nTerms; i_x++) {
+            j = reduce_vector_index(symbols, m, x[i].symbols[i_x]);
+            if (!merge[j]) {
+                mpfr_init2(&(yy[i].deviations[i_y]), prec_internal);
+
+                // y[i] = x[i]
+                yy[i].symbols[i_y] = x[i].symbols[i_x];
+                ARPRA_MPFR_RNDERR_SET(error, MPFR_RNDN, &(yy[i].deviations[i_y]), &(x[i].deviations[i_x]));
+
+                i_y++;
+            }
+            else {
+                // This term will be merged.
+                sum_x[i_x - i_y] = x[i].deviations[i_x];
+                sum_x[i_x - i_y]._mpfr_sign = 1;
+                sum_x_ptr[i_x - i_y] = &(sum_x[i_x - i_y]);
+            }
+        }
+
+        // Merge deviation terms.
+        sum_x_ptr[i_x - i_y] = error;
+        mpfr_sum(error, sum_x_ptr, (i_x - i_y + 1), MPFR_RNDU);
+
+        // Store new deviation term.
+        yy[i].symbols[i_y] = arpra_helper_next_symbol();
+        mpfr_init2(&(yy[i].deviations[i_y]), prec_internal);
+        mpfr_set(&(yy[i].deviations[i_y]), error, MPFR_RNDU);
+        yy[i].nTerms = i_y + 1;
+
+        // Compute true_range.
+        arpra_helper_compute_range(&(yy[i]));
+
+        // Mix with IA range, and trim error term.
+        arpra_helper_mix_trim(&(yy[i]), &(x[i].true_range));
+
+        // Check for NaN and Inf.
+        arpra_helper_check_result(&(yy[i]));
+
+        free(sum_x);
+        free(sum_x_ptr);
+    }
+
+    // Set y, now that x is no longer needed.
+    for (i = 0; i < n; i++) {
+        arpra_clear(&(y[i]));
+        y[i] = yy[i];
+    }
+
+    // Clear vars.
+    mpfr_clear(error);
+    mpfr_clear(temp);
+    for (j = 0; j < m; j++) {
+        mpfr_clear(&(score[j]));
+        mpfr_clear(&(norm_inf[j]));
+    }
+    free(score);
+    free(score_ptr);
+    free(norm_inf);
+    free(symbols);
+    free(merge);
+    free(yy);
+}
@@ -0,0 +1,91 @@
+/*
+ * renumber.c -- Renumber the deviation symbols of a set of live ranges.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-impl.h"
+
+/*
+ * Map the symbols used by the n ranges x[i] onto f, f + 1, f + 2, ...,
+ * preserving their order, and restart the symbol counter after the last of
+ * them. The floor f is above the symbols of cached constants, such as ODE
+ * method tableaus, which are left alone. Every other range which is still
+ * in use must be passed in x, since its symbols may afterwards collide
+ * with new symbols.
+ */
+
+static int renumber_cmp (const void *a, const void *b)
+{
+    arpra_uint sa = *((const arpra_uint *) a);
+    arpra_uint sb = *((const arpra_uint *) b);
+
+    return (sa > sb) - (sa < sb);
+}
+
+static int renumber_cmp_ptr (const void *a, const void *b)
+{
+    const arpra_range *pa = *((arpra_range * const *) a);
+    const arpra_range *pb = *((arpra_range * const *) b);
+
+    return (pa > pb) - (pa < pb);
+}
+
+void arpra_renumber_symbols (arpra_range **x, arpra_uint n)
+{
+    arpra_uint i, j, m, n_sym, n_ranges, i_x, base, *symbols, *found;
+    arpra_range **ranges;
+
+    // Each range must be renumbered only once.
+    ranges = malloc((n + 1) * sizeof(arpra_range *));
+    for (i = 0; i < n; i++) {
+        ranges[i] = x[i];
+    }
+    qsort(ranges, n, sizeof(arpra_range *), &renumber_cmp_ptr);
+    for (i = 0, n_ranges = 0; i < n; i++) {
+        if ((n_ranges == 0) || (ranges[i] != ranges[n_ranges - 1])) ranges[n_ranges++] = ranges[i];
+    }
+
+    // Collect the live symbols.
+    for (i = 0, n_sym = 0; i < n_ranges; i++) {
+        n_sym += ranges[i]->nTerms;
+    }
+    symbols = malloc((n_sym + 1) * sizeof(arpra_uint));
+    for (i = 0, n_sym = 0; i < n_ranges; i++) {
+        for (i_x = 0; i_x < ranges[i]->nTerms; i_x++) {
+            symbols[n_sym++] = ranges[i]->symbols[i_x];
+        }
+    }
+    qsort(symbols, n_sym, sizeof(arpra_uint), &renumber_cmp);
+    for (j = 0, m = 0; j < n_sym; j++) {
+        if ((m == 0) || (symbols[j] != symbols[m - 1])) symbols[m++] = symbols[j];
+    }
+
+    // Replace each symbol with its rank, above the floor.
+    base = arpra_helper_get_symbol_floor();
+    for (i = 0; i < n_ranges; i++) {
+        for (i_x = 0; i_x < ranges[i]->nTerms; i_x++) {
+            found = bsearch(&(ranges[i]->symbols[i_x]), symbols, m, sizeof(arpra_uint), &renumber_cmp);
+            ranges[i]->symbols[i_x] = base + (found - symbols);
+        }
+    }
+
+    arpra_helper_set_symbol_count(base + m);
+    free(symbols);
+    free(ranges);
+}
@@ -23,14 +23,11 @@
 
 void arpra_sum (arpra_range *y, arpra_range *x, arpra_uint n)
 {
-    mpfr_t temp1, temp2, error;
+    mpfr_t error;
     mpfr_ptr *summands;
     arpra_range yy;
     arpra_prec prec_internal;
-    arpra_uint i, n_sum;
-    arpra_uint i_y, *i_x;
-    arpra_uint symbol;
-    arpra_int xHasNext;
+    arpra_uint i;
 
     // Handle n <= 2 case.
     if (n <= 2) {
@@ -74,67 +71,26 @@ void arpra_sum (arpra_range *y, arpra_range *x, arpra_uint n)
 
     // Initialise vars.
     prec_internal = arpra_get_internal_precision();
-    mpfr_init2(temp1, prec_internal + 8);
-    mpfr_init2(temp2, prec_internal + 8);
     mpfr_init2(error, prec_internal);
     arpra_init2(&yy, y->precision);
     summands = malloc(n * sizeof(mpfr_ptr));
-    i_x = malloc(n * sizeof(arpra_uint));
     mpfr_set_zero(error, 1);
 
-    // Zero term indexes, and fill summand array with centre values.
-    i_y = 0;
+    // Fill summand array with centre values.
     for (i = 0; i < n; i++) {
-        i_x[i] = 0;
         summands[i] = &(x[i].centre);
     }
 
     // y[0] = x1[0] + ... + xn[0]
     ARPRA_MPFR_RNDERR_SUM(error, MPFR_RNDN, &(yy.centre), summands, n);
 
-    // Allocate memory for deviation terms.
-    yy.nTerms = 1;
-    for (i = 0; i < n; i++) {
-        yy.nTerms += x[i].nTerms;
-    }
-    yy.symbols = malloc(yy.nTerms * sizeof(arpra_uint));
-    yy.deviations = malloc(yy.nTerms * sizeof(mpfr_t));
-
-    // For all unique symbols in x.
-    xHasNext = yy.nTerms > 1;
-    while (xHasNext) {
-        mpfr_init2(&(yy.deviations[i_y]), prec_internal);
-        xHasNext = 0;
-        symbol = -1;
-
-        // Find and set the next lowest symbol in y.
-        for (i = 0; i < n; i++) {
-            if (i_x[i] < x[i].nTerms) {
-                if (x[i].symbols[i_x[i]] < symbol) {
-                    symbol = x[i].symbols[i_x[i]];
-                }
-            }
-        }
-        yy.symbols[i_y] = symbol;
-
-        // For all x with the next symbol:
-        for (n_sum = 0, i = 0; i < n; i++) {
-            if (x[i].symbols[i_x[i]] == symbol) {
-                // Get next deviation pointer of x[i].
-                summands[n_sum++] = &(x[i].deviations[i_x[i]]);
-                xHasNext += ++i_x[i] < x[i].nTerms;
-            }
-        }
-
-        // y[i] = x1[i] + ... + xn[i]
-        ARPRA_MPFR_RNDERR_SUM(error, MPFR_RNDN, &(yy.deviations[i_y]), summands, n_sum);
-        i_y++;
-    }
+    // y[i] = x1[i] + ... + xn[i]
+    arpra_helper_sum_terms(&yy, error, x, n);
 
     // Store new deviation term.
-    yy.symbols[i_y] = arpra_helper_next_symbol();
-    yy.deviations[i_y] = *error;
-    yy.nTerms = i_y + 1;
+    yy.symbols[yy.nTerms] = arpra_helper_next_symbol();
+    yy.deviations[yy.nTerms] = *error;
+    yy.nTerms++;
 
     // Compute true_range.
     arpra_helper_compute_range(&yy);
@@ -143,12 +99,9 @@ void arpra_sum (arpra_range *y, arpra_range *x, arpra_uint n)
     arpra_helper_check_result(&yy);
 
     // Clear vars, and set y.
-    mpfr_clear(temp1);
-    mpfr_clear(temp2);
     arpra_clear(y);
     *y = yy;
     free(summands);
-    free(i_x);
 }
 
 /*
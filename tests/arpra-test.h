@@ -49,6 +49,25 @@ enum test_rand_mode_enum
     TEST_RAND_NEG,        // (-oo <  z  <= -0)
 };
 
+// Linear ODE test system.
+typedef struct test_ode_struct test_ode;
+struct test_ode_struct
+{
+    arpra_ode_system system;
+    arpra_range t;
+    arpra_range lambda;
+    arpra_range *_x;
+    arpra_range **x;
+    arpra_ode_f *f;
+    void **params;
+    arpra_uint *dims;
+    arpra_ode_coupling coupling;
+    arpra_uint *row;
+    arpra_uint *col;
+    arpra_range *weight;
+    arpra_range *sum;
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -92,6 +111,26 @@ void test_log_mpfi (mpfi_srcptr x1, const char *var_name);
 void test_share_all_syms (arpra_range *x1, arpra_range *x2);
 void test_share_rand_syms (arpra_range *x1, arpra_range *x2);
 void test_share_n_syms (arpra_range *x1, arpra_range *x2, arpra_uint n);
+void test_spread_syms (arpra_range *y, const arpra_range *x, arpra_uint n, arpra_uint stride);
+
+// ODE test system functions.
+void test_ode_linear_f (arpra_range *dxdt, const void *params,
+                        const arpra_range *t, const arpra_range **x,
+                        const arpra_uint x_grp, const arpra_uint x_dim);
+void test_ode_init (test_ode *ode, arpra_uint grps, arpra_uint dims,
+                    double lambda, double radius, arpra_prec prec);
+void test_ode_coupled_f (arpra_range *dxdt, const void *params,
+                         const arpra_range *t, const arpra_range **x,
+                         const arpra_uint x_grp, const arpra_uint x_dim);
+void test_ode_couple (test_ode *ode, double weight);
+void test_ode_clear (test_ode *ode);
+int test_ode_contains_mpfr (const arpra_range *x, mpfr_srcptr y);
+int test_ode_contains (const test_ode *ode, const test_ode *ref);
+
+// Sampled evaluation functions.
+void test_sample_symbol (mpfr_ptr y, arpra_uint symbol, arpra_uint sample);
+void test_sample_value (mpfr_ptr y, const arpra_range *x, arpra_uint sample);
+int test_sample_contains (const arpra_range *y, mpfr_srcptr x, arpra_uint fresh, arpra_uint sample);
 
 // Test functions.
 int test_compare_arpra (const arpra_range *x1, const arpra_range *x2);
@@ -0,0 +1,173 @@
+/*
+ * ode_linear.c -- Linear ODE test system.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-test.h"
+
+void test_ode_linear_f (arpra_range *dxdt, const void *params,
+                        const arpra_range *t, const arpra_range **x,
+                        const arpra_uint x_grp, const arpra_uint x_dim)
+{
+    const arpra_range *lambda = (const arpra_range *) params;
+
+    // dx/dt = lambda x
+    arpra_mul(dxdt, lambda, &(x[x_grp][x_dim]));
+}
+
+void test_ode_coupled_f (arpra_range *dxdt, const void *params,
+                         const arpra_range *t, const arpra_range **x,
+                         const arpra_uint x_grp, const arpra_uint x_dim)
+{
+    const test_ode *ode = (const test_ode *) params;
+
+    // dx/dt = lambda x + s, where s is the coupled sum
+    arpra_mul(dxdt, &(ode->lambda), &(x[x_grp][x_dim]));
+    arpra_add(dxdt, dxdt, &(ode->sum[x_dim]));
+}
+
+void test_ode_init (test_ode *ode, arpra_uint grps, arpra_uint dims,
+                    double lambda, double radius, arpra_prec prec)
+{
+    arpra_uint x_grp, x_dim, i;
+    mpfi_t x0;
+
+    // Allocate system.
+    ode->_x = malloc(grps * dims * sizeof(arpra_range));
+    ode->x = malloc(grps * sizeof(arpra_range *));
+    ode->f = malloc(grps * sizeof(arpra_ode_f));
+    ode->params = malloc(grps * sizeof(void *));
+    ode->dims = malloc(grps * sizeof(arpra_uint));
+
+    // x_i(0) = 1 + i / 8 +/- radius, t(0) = 0
+    mpfi_init2(x0, prec);
+    arpra_init2(&(ode->t), prec);
+    arpra_init2(&(ode->lambda), prec);
+    arpra_set_zero(&(ode->t));
+    arpra_set_d(&(ode->lambda), lambda);
+    for (x_grp = 0, i = 0; x_grp < grps; x_grp++) {
+        ode->x[x_grp] = &(ode->_x[x_grp * dims]);
+        ode->f[x_grp] = test_ode_linear_f;
+        ode->params[x_grp] = &(ode->lambda);
+        ode->dims[x_grp] = dims;
+        for (x_dim = 0; x_dim < dims; x_dim++, i++) {
+            arpra_init2(&(ode->x[x_grp][x_dim]), prec);
+            mpfi_interv_d(x0, 1 + (i / 8.) - radius, 1 + (i / 8.) + radius);
+            arpra_set_mpfi(&(ode->x[x_grp][x_dim]), x0);
+        }
+    }
+    mpfi_clear(x0);
+
+    arpra_ode_system_init(&(ode->system), ode->f, ode->params, &(ode->t), ode->x,
+                          grps, ode->dims);
+}
+
+void test_ode_couple (test_ode *ode, double weight)
+{
+    arpra_range denominator;
+    arpra_uint grps, dims, r;
+
+    // Row r of group 0 sums weight / 3 (x[r] + x[r + 1]) of the last group.
+    grps = ode->system.grps;
+    dims = ode->dims[0];
+    ode->row = malloc((dims + 1) * sizeof(arpra_uint));
+    ode->col = malloc(2 * dims * sizeof(arpra_uint));
+    ode->weight = malloc(2 * dims * sizeof(arpra_range));
+    ode->sum = malloc(dims * sizeof(arpra_range));
+    arpra_init2(&denominator, arpra_get_precision(&(ode->t)));
+    arpra_set_d(&denominator, 3.0);
+    for (r = 0; r < dims; r++) {
+        ode->row[r] = 2 * r;
+        ode->col[2 * r] = r;
+        ode->col[(2 * r) + 1] = (r + 1) % dims;
+        arpra_init2(&(ode->weight[2 * r]), arpra_get_precision(&(ode->t)));
+        arpra_init2(&(ode->weight[(2 * r) + 1]), arpra_get_precision(&(ode->t)));
+        arpra_set_d(&(ode->weight[2 * r]), weight);
+        arpra_div(&(ode->weight[2 * r]), &(ode->weight[2 * r]), &denominator);
+        arpra_set(&(ode->weight[(2 * r) + 1]), &(ode->weight[2 * r]));
+        arpra_init2(&(ode->sum[r]), arpra_get_precision(&(ode->t)));
+        arpra_set_zero(&(ode->sum[r]));
+    }
+    ode->row[dims] = 2 * dims;
+    arpra_clear(&denominator);
+
+    ode->coupling = (arpra_ode_coupling) {
+        .x_grp = grps - 1,
+        .rows = dims,
+        .row = ode->row,
+        .col = ode->col,
+        .weight = ode->weight,
+        .sum = ode->sum,
+    };
+    ode->f[0] = test_ode_coupled_f;
+    ode->params[0] = ode;
+    ode->system.coupling = &(ode->coupling);
+    ode->system.n_coupling = 1;
+}
+
+void test_ode_clear (test_ode *ode)
+{
+    arpra_uint x_grp, x_dim, r;
+
+    for (x_grp = 0; x_grp < ode->system.grps; x_grp++) {
+        for (x_dim = 0; x_dim < ode->dims[x_grp]; x_dim++) {
+            arpra_clear(&(ode->x[x_grp][x_dim]));
+        }
+    }
+    if (ode->system.n_coupling > 0) {
+        for (r = 0; r < ode->coupling.rows; r++) {
+            arpra_clear(&(ode->weight[2 * r]));
+            arpra_clear(&(ode->weight[(2 * r) + 1]));
+            arpra_clear(&(ode->sum[r]));
+        }
+        free(ode->row);
+        free(ode->col);
+        free(ode->weight);
+        free(ode->sum);
+    }
+    arpra_clear(&(ode->t));
+    arpra_clear(&(ode->lambda));
+    free(ode->_x);
+    free(ode->x);
+    free(ode->f);
+    free(ode->params);
+    free(ode->dims);
+}
+
+int test_ode_contains_mpfr (const arpra_range *x, mpfr_srcptr y)
+{
+    return mpfr_lessequal_p(&(x->true_range.left), y)
+        && mpfr_lessequal_p(y, &(x->true_range.right));
+}
+
+int test_ode_contains (const test_ode *ode, const test_ode *ref)
+{
+    arpra_uint x_grp, x_dim;
+
+    // The centre of a high-precision run lies within a low-precision run.
+    for (x_grp = 0; x_grp < ode->system.grps; x_grp++) {
+        for (x_dim = 0; x_dim < ode->dims[x_grp]; x_dim++) {
+            if (!test_ode_contains_mpfr(&(ode->x[x_grp][x_dim]), &(ref->x[x_grp][x_dim].centre))) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
@@ -0,0 +1,144 @@
+/*
+ * sample_arpra.c -- Evaluate Arpra ranges at sampled symbol values.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-test.h"
+
+/*
+ * Samples fix every noise symbol to a value in [-1, 1], which depends only
+ * on the symbol and the sample number, so that correlated ranges agree on
+ * it. Samples 0 and 1 set every symbol to -1 and +1 respectively. The other
+ * values are multiples of 1/1024, so their products are exact.
+ */
+
+void test_sample_symbol (mpfr_ptr y, arpra_uint symbol, arpra_uint sample)
+{
+    unsigned long hash;
+
+    if (sample < 2) {
+        mpfr_set_si(y, (sample ? 1 : -1), MPFR_RNDN);
+        return;
+    }
+
+    hash = (symbol * 2654435761UL) ^ (sample * 40503UL);
+    hash = (hash ^ (hash >> 16)) * 73244475UL;
+    hash = hash ^ (hash >> 16);
+    mpfr_set_si_2exp(y, ((long int) (hash % 2049) - 1024), -10, MPFR_RNDN);
+}
+
+/*
+ * Set y to x evaluated at the given sample, rounded to nearest at the
+ * precision of y.
+ */
+
+void test_sample_value (mpfr_ptr y, const arpra_range *x, arpra_uint sample)
+{
+    mpfr_t symbol;
+    mpfr_ptr term, *term_ptr;
+    arpra_uint i;
+
+    mpfr_init2(symbol, 16);
+    term = malloc((x->nTerms + 1) * sizeof(mpfr_t));
+    term_ptr = malloc((x->nTerms + 1) * sizeof(mpfr_ptr));
+
+    // y = x[0] + sum(x[i] * e[i])
+    for (i = 0; i < x->nTerms; i++) {
+        mpfr_init2(&(term[i]), (mpfr_get_prec(&(x->deviations[i])) + 16));
+        test_sample_symbol(symbol, x->symbols[i], sample);
+        mpfr_mul(&(term[i]), &(x->deviations[i]), symbol, MPFR_RNDN);
+        term_ptr[i] = &(term[i]);
+    }
+    term_ptr[i] = (mpfr_ptr) &(x->centre);
+    mpfr_sum(y, term_ptr, (x->nTerms + 1), MPFR_RNDN);
+
+    for (i = 0; i < x->nTerms; i++) {
+        mpfr_clear(&(term[i]));
+    }
+    mpfr_clear(symbol);
+    free(term);
+    free(term_ptr);
+}
+
+/*
+ * Check that the affine form of y can take the value x at the given sample.
+ * Symbols of y less than fresh are fixed by the sample, and the remaining
+ * symbols, created after x was sampled, are free. The true_range is not
+ * checked, since it is rounded before the last rounding error is added to
+ * the affine form. Trimmed range methods shrink the affine form to the
+ * true_range, so callers should use ARPRA_AA.
+ */
+
+int test_sample_contains (const arpra_range *y, mpfr_srcptr x, arpra_uint fresh, arpra_uint sample)
+{
+    mpfr_t symbol, diff, slack;
+    mpfr_ptr term, *term_ptr, *slack_ptr;
+    arpra_prec prec_internal;
+    arpra_uint i, n_term, n_slack;
+    int result;
+
+    // An unbounded range contains every value.
+    if (!arpra_bounded_p(y)) return 1;
+
+    prec_internal = arpra_get_internal_precision();
+    mpfr_init2(symbol, 16);
+    mpfr_init2(diff, (4 * prec_internal));
+    mpfr_init2(slack, prec_internal);
+    term = malloc((y->nTerms + 2) * sizeof(mpfr_t));
+    term_ptr = malloc((y->nTerms + 2) * sizeof(mpfr_ptr));
+    slack_ptr = malloc((y->nTerms + 1) * sizeof(mpfr_ptr));
+
+    // diff = x - (y[0] + sum(y[i] * e[i])), over the fixed symbols.
+    // slack = sum(|y[i]|), over the free symbols.
+    n_term = 0;
+    n_slack = 0;
+    for (i = 0; i < y->nTerms; i++) {
+        mpfr_init2(&(term[i]), (mpfr_get_prec(&(y->deviations[i])) + 16));
+        if (y->symbols[i] < fresh) {
+            test_sample_symbol(symbol, y->symbols[i], sample);
+            mpfr_mul(&(term[i]), &(y->deviations[i]), symbol, MPFR_RNDN);
+            mpfr_neg(&(term[i]), &(term[i]), MPFR_RNDN);
+            term_ptr[n_term++] = &(term[i]);
+        }
+        else {
+            mpfr_abs(&(term[i]), &(y->deviations[i]), MPFR_RNDN);
+            slack_ptr[n_slack++] = &(term[i]);
+        }
+    }
+    mpfr_init2(&(term[i]), mpfr_get_prec(&(y->centre)));
+    mpfr_neg(&(term[i]), &(y->centre), MPFR_RNDN);
+    term_ptr[n_term++] = &(term[i]);
+    term_ptr[n_term++] = (mpfr_ptr) x;
+    mpfr_sum(diff, term_ptr, n_term, MPFR_RNDN);
+    mpfr_sum(slack, slack_ptr, n_slack, MPFR_RNDU);
+    mpfr_abs(diff, diff, MPFR_RNDN);
+
+    result = mpfr_lessequal_p(diff, slack);
+
+    for (i = 0; i <= y->nTerms; i++) {
+        mpfr_clear(&(term[i]));
+    }
+    mpfr_clear(symbol);
+    mpfr_clear(diff);
+    mpfr_clear(slack);
+    free(term);
+    free(term_ptr);
+    free(slack_ptr);
+    return result;
+}
@@ -127,3 +127,40 @@ void test_share_n_syms (arpra_range *x1, arpra_range *x2, arpra_uint n)
         x2_has_next = i < x2->nTerms;
     }
 }
+
+void test_spread_syms (arpra_range *y, const arpra_range *x, arpra_uint n, arpra_uint stride)
+{
+    arpra_uint base, symbol_min, symbol_max, i, i_x;
+
+    base = arpra_helper_get_symbol_count();
+    symbol_min = -1;
+    symbol_max = 0;
+    for (i = 0; i < n; i++) {
+        if (x[i].nTerms > 0) {
+            if (x[i].symbols[0] < symbol_min) symbol_min = x[i].symbols[0];
+            if (x[i].symbols[x[i].nTerms - 1] > symbol_max) symbol_max = x[i].symbols[x[i].nTerms - 1];
+        }
+    }
+
+    // Copy x to y, with symbols spread stride apart above the symbol count.
+    for (i = 0; i < n; i++) {
+        arpra_clear(&(y[i]));
+        arpra_init2(&(y[i]), x[i].precision);
+        mpfr_set(&(y[i].centre), &(x[i].centre), MPFR_RNDN);
+        mpfr_set(&(y[i].radius), &(x[i].radius), MPFR_RNDN);
+        mpfi_set(&(y[i].true_range), &(x[i].true_range));
+        y[i].symbols = malloc(x[i].nTerms * sizeof(arpra_uint));
+        y[i].deviations = malloc(x[i].nTerms * sizeof(mpfr_t));
+        for (i_x = 0; i_x < x[i].nTerms; i_x++) {
+            mpfr_init2(&(y[i].deviations[i_x]), mpfr_get_prec(&(x[i].deviations[i_x])));
+            mpfr_set(&(y[i].deviations[i_x]), &(x[i].deviations[i_x]), MPFR_RNDN);
+            y[i].symbols[i_x] = base + ((x[i].symbols[i_x] - symbol_min) * stride);
+        }
+        y[i].nTerms = x[i].nTerms;
+    }
+
+    // Skip the symbols that y may now use.
+    if (symbol_max >= symbol_min) {
+        arpra_helper_set_symbol_count(base + ((symbol_max - symbol_min + 1) * stride));
+    }
+}
@@ -0,0 +1,139 @@
+/*
+ * t_accumulator.c -- Test the arpra_accumulator functions.
+ *
+ * Copyright 2017-2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-test.h"
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 24;
+    const arpra_prec prec_internal = 256;
+    const arpra_uint test_n = 10000;
+    const arpra_uint sample_n = 16;
+    const arpra_uint pool_n = 12;
+    const arpra_uint range_n = 8;
+    arpra_accumulator acc;
+    arpra_range x1[range_n], x2[range_n];
+    arpra_uint pool[pool_n], kind[range_n];
+    mpfr_t alpha[range_n];
+    mpfr_t x1_value, x2_value, x_sum;
+    arpra_uint i, j, i_x, offset, fresh, sample, fail, fail_n;
+
+    // Init test.
+    test_fixture_init(prec, prec_internal);
+    arpra_set_range_method(ARPRA_AA);
+    test_log_init("accumulator");
+    test_rand_init();
+    arpra_accumulator_init(&acc, prec);
+    mpfr_init2(x1_value, (4 * prec_internal));
+    mpfr_init2(x2_value, (4 * prec_internal));
+    mpfr_init2(x_sum, (8 * prec_internal));
+    for (j = 0; j < range_n; j++) {
+        arpra_init2(&(x1[j]), prec);
+        arpra_init2(&(x2[j]), prec);
+        mpfr_init2(alpha[j], prec);
+    }
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < test_n; i++) {
+        fail = 0;
+
+        // Bound the products' remainders with both multiplication methods.
+        arpra_set_mul_method((i % 2) ? ARPRA_MUL_TRIVIAL : ARPRA_MUL_RUMP_KASHIWAGI);
+
+        // Draw the ranges' symbols from a common pool, so that they overlap.
+        for (j = 0; j < pool_n; j++) {
+            pool[j] = arpra_helper_next_symbol();
+        }
+        for (j = 0; j < range_n; j++) {
+            test_rand_arpra(&(x1[j]), TEST_RAND_MIXED, TEST_RAND_SMALL);
+            offset = gmp_urandomm_ui(test_randstate, (pool_n - x1[j].nTerms + 2));
+            for (i_x = 0; i_x < (x1[j].nTerms - 1); i_x++) {
+                x1[j].symbols[i_x] = pool[offset + i_x];
+            }
+            test_rand_arpra(&(x2[j]), TEST_RAND_MIXED, TEST_RAND_SMALL);
+            offset = gmp_urandomm_ui(test_randstate, (pool_n - x2[j].nTerms + 2));
+            for (i_x = 0; i_x < (x2[j].nTerms - 1); i_x++) {
+                x2[j].symbols[i_x] = pool[offset + i_x];
+            }
+            test_rand_mpfr(alpha[j], prec, TEST_RAND_MIXED);
+        }
+        fresh = arpra_helper_get_symbol_count();
+
+        // Accumulate a random mix of sums, scaled sums and products.
+        for (j = 0; j < range_n; j++) {
+            kind[j] = gmp_urandomm_ui(test_randstate, 3);
+            if (kind[j] == 0) {
+                arpra_accumulator_add(&acc, &(x1[j]));
+            }
+            else if (kind[j] == 1) {
+                arpra_accumulator_add_scaled(&acc, &(x1[j]), alpha[j]);
+            }
+            else {
+                arpra_accumulator_add_product(&acc, &(x1[j]), &(x2[j]));
+            }
+        }
+        arpra_accumulator_finalise(&y_A, &acc);
+
+        // Pass criteria:
+        // 1) Arpra y contains the accumulated sum, with its symbols correlated.
+        for (sample = 0; sample < sample_n; sample++) {
+            mpfr_set_zero(x_sum, 1);
+            for (j = 0; j < range_n; j++) {
+                test_sample_value(x1_value, &(x1[j]), sample);
+                if (kind[j] == 1) {
+                    mpfr_mul(x1_value, x1_value, alpha[j], MPFR_RNDN);
+                }
+                else if (kind[j] == 2) {
+                    test_sample_value(x2_value, &(x2[j]), sample);
+                    mpfr_mul(x1_value, x1_value, x2_value, MPFR_RNDN);
+                }
+                mpfr_add(x_sum, x_sum, x1_value, MPFR_RNDN);
+            }
+            if (!test_sample_contains(&y_A, x_sum, fresh, sample)) fail = 1;
+        }
+        test_log_printf("Test %lu: %lu terms\n", i, y_A.nTerms);
+
+        // Pass criteria (empty accumulator):
+        // 1) Arpra y = 0.
+        arpra_accumulator_finalise(&y_A, &acc);
+        if (!mpfr_zero_p(&(y_A.centre)) || !mpfr_zero_p(&(y_A.radius))) fail = 1;
+
+        test_log_printf("Result: %s\n\n", (fail ? "FAIL" : "PASS"));
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, test_n);
+    for (j = 0; j < range_n; j++) {
+        arpra_clear(&(x1[j]));
+        arpra_clear(&(x2[j]));
+        mpfr_clear(alpha[j]);
+    }
+    arpra_accumulator_clear(&acc);
+    mpfr_clear(x1_value);
+    mpfr_clear(x2_value);
+    mpfr_clear(x_sum);
+    test_fixture_clear();
+    test_log_clear();
+    test_rand_clear();
+    return fail_n > 0;
+}
@@ -0,0 +1,244 @@
+/*
+ * t_gallop.c -- Test the galloping symbol merge.
+ *
+ * Copyright 2017-2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-test.h"
+
+/*
+ * The term-by-term merge that arpra_helper_affine_2 used before galloping,
+ * kept as a reference.
+ */
+
+static void affine_2_linear (arpra_range *y, const arpra_range *x1, const arpra_range *x2,
+                             mpfi_srcptr alpha, mpfi_srcptr beta, mpfi_srcptr gamma, mpfr_srcptr delta)
+{
+    mpfr_t error;
+    arpra_range yy;
+    arpra_prec prec_internal;
+    arpra_uint i_y, i_x1, i_x2;
+
+    prec_internal = arpra_get_internal_precision();
+    mpfr_init2(error, prec_internal);
+    arpra_init2(&yy, y->precision);
+    mpfr_set_zero(error, 1);
+
+    // y[0] = (alpha * x1[0]) + (beta * x2[0]) + (gamma)
+    arpra_helper_term_fmmaa(error, &(yy.centre), &(x1->centre), &(x2->centre), alpha, beta, gamma);
+
+    yy.symbols = malloc((x1->nTerms + x2->nTerms + 1) * sizeof(arpra_uint));
+    yy.deviations = malloc((x1->nTerms + x2->nTerms + 1) * sizeof(mpfr_t));
+
+    for (i_y = 0, i_x1 = 0, i_x2 = 0; (i_x1 < x1->nTerms) || (i_x2 < x2->nTerms); i_y++) {
+        mpfr_init2(&(yy.deviations[i_y]), prec_internal);
+
+        if ((i_x2 == x2->nTerms) || ((i_x1 < x1->nTerms) && (x1->symbols[i_x1] < x2->symbols[i_x2]))) {
+            // y[i] = (alpha * x1[i])
+            yy.symbols[i_y] = x1->symbols[i_x1];
+            arpra_helper_term_mul(error, &(yy.deviations[i_y]), &(x1->deviations[i_x1]), alpha);
+            i_x1++;
+        }
+        else if ((i_x1 == x1->nTerms) || ((i_x2 < x2->nTerms) && (x2->symbols[i_x2] < x1->symbols[i_x1]))) {
+            // y[i] = (beta * x2[i])
+            yy.symbols[i_y] = x2->symbols[i_x2];
+            arpra_helper_term_mul(error, &(yy.deviations[i_y]), &(x2->deviations[i_x2]), beta);
+            i_x2++;
+        }
+        else {
+            // y[i] = (alpha * x1[i]) + (beta * x2[i])
+            yy.symbols[i_y] = x1->symbols[i_x1];
+            arpra_helper_term_fmma(error, &(yy.deviations[i_y]), &(x1->deviations[i_x1]), &(x2->deviations[i_x2]), alpha, beta);
+            i_x1++;
+            i_x2++;
+        }
+    }
+
+    // Add delta to error.
+    mpfr_add(error, error, delta, MPFR_RNDU);
+
+    // Store new deviation term.
+    yy.symbols[i_y] = arpra_helper_next_symbol();
+    yy.deviations[i_y] = *error;
+    yy.nTerms = i_y + 1;
+
+    arpra_clear(y);
+    *y = yy;
+}
+
+/*
+ * Set y to a random range with n terms, whose symbols are a random sorted
+ * subset of [base, base + span).
+ */
+
+static void rand_form (arpra_range *y, arpra_uint base, arpra_uint span, arpra_uint n)
+{
+    arpra_prec prec_internal;
+    arpra_uint i, i_y;
+
+    prec_internal = arpra_get_internal_precision();
+    arpra_clear(y);
+    arpra_init2(y, y->precision);
+    test_rand_mpfr(&(y->centre), prec_internal, TEST_RAND_SMALL);
+    y->symbols = malloc(n * sizeof(arpra_uint));
+    y->deviations = malloc(n * sizeof(mpfr_t));
+
+    // Choose each remaining symbol with probability (needed / remaining).
+    for (i = 0, i_y = 0; (i < span) && (i_y < n); i++) {
+        if (gmp_urandomm_ui(test_randstate, (span - i)) < (n - i_y)) {
+            mpfr_init2(&(y->deviations[i_y]), prec_internal);
+            test_rand_mpfr(&(y->deviations[i_y]), prec_internal, TEST_RAND_SMALL);
+            y->symbols[i_y] = base + i;
+            i_y++;
+        }
+    }
+    y->nTerms = i_y;
+
+    arpra_helper_compute_range(y);
+}
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 24;
+    const arpra_prec prec_internal = 256;
+    const arpra_uint test_n = 2000;
+    const arpra_uint sample_n = 4;
+    const arpra_uint span = 512;
+    arpra_range y_ref;
+    mpfi_t alpha, beta, gamma;
+    mpfr_t delta, x1_value, x2_value, x_value;
+    arpra_uint symbols[span];
+    arpra_uint i, j, lo, hi, symbol, expect, base, fresh, sample, fail, fail_n;
+
+    // Init test.
+    test_fixture_init(prec, prec_internal);
+    arpra_set_range_method(ARPRA_AA);
+    test_log_init("gallop");
+    test_rand_init();
+    arpra_init2(&y_ref, prec);
+    mpfi_init2(alpha, prec);
+    mpfi_init2(beta, prec);
+    mpfi_init2(gamma, prec);
+    mpfr_init2(delta, prec);
+    mpfr_init2(x1_value, (8 * prec_internal));
+    mpfr_init2(x2_value, (8 * prec_internal));
+    mpfr_init2(x_value, (8 * prec_internal));
+    mpfi_set_si(gamma, 0);
+    mpfr_set_zero(delta, 1);
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < test_n; i++) {
+        fail = 0;
+
+        // Pass criteria (gallop):
+        // 1) The result is the first index in [lo, hi) whose symbol is not
+        //    less than symbol, or hi, as found by linear search.
+        for (j = 0, symbol = 0; j < span; j++) {
+            symbol += gmp_urandomm_ui(test_randstate, 3) + 1;
+            symbols[j] = symbol;
+        }
+        lo = gmp_urandomm_ui(test_randstate, span + 1);
+        hi = lo + gmp_urandomm_ui(test_randstate, (span - lo + 1));
+        symbol = gmp_urandomm_ui(test_randstate, (symbol + 2));
+        for (expect = lo; (expect < hi) && (symbols[expect] < symbol); expect++);
+        if (arpra_helper_gallop(symbols, lo, hi, symbol) != expect) fail = 1;
+
+        // Merge a long form with a short one, in a random order.
+        base = arpra_helper_get_symbol_count();
+        rand_form(&x1_A, base, span, (gmp_urandomm_ui(test_randstate, span / 2) + 1));
+        rand_form(&x2_A, base, span, (gmp_urandomm_ui(test_randstate, 8) + 1));
+        if (gmp_urandomb_ui(test_randstate, 1)) {
+            arpra_swap(&x1_A, &x2_A);
+        }
+        arpra_helper_set_symbol_count(base + span);
+        fresh = base + span;
+
+        // Pass criteria (interval coefficients):
+        // 1) Arpra y (gallop) = Arpra y (linear merge).
+        test_rand_mpfr(&(alpha->left), prec, TEST_RAND_MIXED);
+        test_rand_mpfr(&(alpha->right), prec, TEST_RAND_SMALL_POS);
+        mpfr_add(&(alpha->right), &(alpha->right), &(alpha->left), MPFR_RNDU);
+        test_rand_mpfr(&(beta->left), prec, TEST_RAND_MIXED);
+        test_rand_mpfr(&(beta->right), prec, TEST_RAND_SMALL_POS);
+        mpfr_add(&(beta->right), &(beta->right), &(beta->left), MPFR_RNDU);
+        arpra_helper_affine_2(&y_A, &x1_A, &x2_A, alpha, beta, gamma, delta);
+        arpra_helper_set_symbol_count(fresh);
+        affine_2_linear(&y_ref, &x1_A, &x2_A, alpha, beta, gamma, delta);
+        arpra_helper_compute_range(&y_A);
+        arpra_helper_compute_range(&y_ref);
+        if (test_compare_arpra(&y_A, &y_ref)) fail = 1;
+
+        // Pass criteria (point coefficients):
+        // 1) Arpra y (gallop) has the symbols of Arpra y (linear merge).
+        // 2) Arpra y (gallop) contains alpha * x1 + beta * x2.
+        mpfi_set_fr(alpha, &(alpha->left));
+        mpfi_set_fr(beta, &(beta->left));
+        fresh = arpra_helper_get_symbol_count();
+        arpra_helper_affine_2(&y_A, &x1_A, &x2_A, alpha, beta, gamma, delta);
+        arpra_helper_set_symbol_count(fresh);
+        affine_2_linear(&y_ref, &x1_A, &x2_A, alpha, beta, gamma, delta);
+        arpra_helper_compute_range(&y_A);
+        if (y_A.nTerms != y_ref.nTerms) {
+            fail = 1;
+        }
+        else {
+            for (j = 0; j < y_A.nTerms; j++) {
+                if (y_A.symbols[j] != y_ref.symbols[j]) fail = 1;
+            }
+        }
+        for (sample = 0; sample < sample_n; sample++) {
+            test_sample_value(x1_value, &x1_A, sample);
+            test_sample_value(x2_value, &x2_A, sample);
+            mpfr_mul(x1_value, x1_value, &(alpha->left), MPFR_RNDN);
+            mpfr_mul(x2_value, x2_value, &(beta->left), MPFR_RNDN);
+            mpfr_add(x_value, x1_value, x2_value, MPFR_RNDN);
+            if (!test_sample_contains(&y_A, x_value, fresh, sample)) fail = 1;
+        }
+
+        // Pass criteria (multiplication):
+        // 1) Arpra y contains x1 * x2.
+        fresh = arpra_helper_get_symbol_count();
+        arpra_mul(&y_A, &x1_A, &x2_A);
+        for (sample = 0; sample < sample_n; sample++) {
+            test_sample_value(x1_value, &x1_A, sample);
+            test_sample_value(x2_value, &x2_A, sample);
+            mpfr_mul(x_value, x1_value, x2_value, MPFR_RNDN);
+            if (!test_sample_contains(&y_A, x_value, fresh, sample)) fail = 1;
+        }
+
+        test_log_printf("Test %lu: %lu and %lu terms\n", i, x1_A.nTerms, x2_A.nTerms);
+        test_log_printf("Result: %s\n\n", (fail ? "FAIL" : "PASS"));
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, test_n);
+    arpra_clear(&y_ref);
+    mpfi_clear(alpha);
+    mpfi_clear(beta);
+    mpfi_clear(gamma);
+    mpfr_clear(delta);
+    mpfr_clear(x1_value);
+    mpfr_clear(x2_value);
+    mpfr_clear(x_value);
+    test_fixture_clear();
+    test_log_clear();
+    test_rand_clear();
+    return fail_n > 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * t_lincomb.c -- Test the arpra_lincomb function.
+ *
+ * Copyright 2017-2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-test.h"
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 24;
+    const arpra_prec prec_internal = 256;
+    const arpra_uint test_n = 10000;
+    const arpra_uint sample_n = 16;
+    const arpra_uint pool_n = 12;
+    const arpra_uint range_n = 6;
+    const arpra_uint stride = 1000;
+    arpra_range x[range_n], x_sparse[range_n];
+    arpra_range y_dense, y_sparse;
+    arpra_uint pool[pool_n];
+    mpfr_t alpha[range_n];
+    mpfr_ptr alpha_ptr[range_n];
+    mpfr_t x_value, x_sum;
+    arpra_uint i, j, i_x, offset, fresh, fresh_sparse, sample, fail, fail_n;
+
+    // Init test.
+    test_fixture_init(prec, prec_internal);
+    arpra_set_range_method(ARPRA_AA);
+    test_log_init("lincomb");
+    test_rand_init();
+    mpfr_init2(x_value, (4 * prec_internal));
+    mpfr_init2(x_sum, (4 * prec_internal));
+    arpra_init2(&y_dense, prec);
+    arpra_init2(&y_sparse, prec);
+    for (j = 0; j < range_n; j++) {
+        arpra_init2(&(x[j]), prec);
+        arpra_init2(&(x_sparse[j]), prec);
+        mpfr_init2(alpha[j], prec);
+        alpha_ptr[j] = alpha[j];
+    }
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < test_n; i++) {
+        fail = 0;
+
+        // Draw the ranges' symbols from a common pool, so that they overlap
+        // and are packed densely, then make a sparse copy.
+        for (j = 0; j < pool_n; j++) {
+            pool[j] = arpra_helper_next_symbol();
+        }
+        for (j = 0; j < range_n; j++) {
+            test_rand_arpra(&(x[j]), TEST_RAND_MIXED, TEST_RAND_SMALL);
+            test_rand_mpfr(alpha[j], prec, TEST_RAND_MIXED);
+            offset = gmp_urandomm_ui(test_randstate, (pool_n - x[j].nTerms + 2));
+            for (i_x = 0; i_x < (x[j].nTerms - 1); i_x++) {
+                x[j].symbols[i_x] = pool[offset + i_x];
+            }
+        }
+        fresh = arpra_helper_get_symbol_count();
+        test_spread_syms(x_sparse, x, range_n, stride);
+        fresh_sparse = arpra_helper_get_symbol_count();
+
+        arpra_lincomb(&y_dense, x, alpha_ptr, range_n);
+        arpra_lincomb(&y_sparse, x_sparse, alpha_ptr, range_n);
+
+        // Pass criteria (dense symbols):
+        // 1) Arpra y contains the linear combination of x, with its symbols correlated.
+        for (sample = 0; sample < sample_n; sample++) {
+            mpfr_set_zero(x_sum, 1);
+            for (j = 0; j < range_n; j++) {
+                test_sample_value(x_value, &(x[j]), sample);
+                mpfr_mul(x_value, x_value, alpha[j], MPFR_RNDN);
+                mpfr_add(x_sum, x_sum, x_value, MPFR_RNDN);
+            }
+            if (!test_sample_contains(&y_dense, x_sum, fresh, sample)) fail = 1;
+        }
+
+        // Pass criteria (sparse symbols):
+        // 1) Arpra y contains the linear combination of x, with its symbols correlated.
+        // 2) Arpra y (sparse) = Arpra y (dense), up to the symbol names.
+        for (sample = 0; sample < sample_n; sample++) {
+            mpfr_set_zero(x_sum, 1);
+            for (j = 0; j < range_n; j++) {
+                test_sample_value(x_value, &(x_sparse[j]), sample);
+                mpfr_mul(x_value, x_value, alpha[j], MPFR_RNDN);
+                mpfr_add(x_sum, x_sum, x_value, MPFR_RNDN);
+            }
+            if (!test_sample_contains(&y_sparse, x_sum, fresh_sparse, sample)) fail = 1;
+        }
+        if (!mpfr_equal_p(&(y_sparse.centre), &(y_dense.centre))) fail = 1;
+        if (!mpfr_equal_p(&(y_sparse.radius), &(y_dense.radius))) fail = 1;
+        if (y_sparse.nTerms != y_dense.nTerms) {
+            fail = 1;
+        }
+        else {
+            for (i_x = 0; i_x < y_dense.nTerms; i_x++) {
+                if (!mpfr_equal_p(&(y_sparse.deviations[i_x]), &(y_dense.deviations[i_x]))) fail = 1;
+            }
+        }
+
+        test_log_printf("Test %lu: %lu terms (dense), %lu terms (sparse)\n", i, y_dense.nTerms, y_sparse.nTerms);
+        test_log_printf("Result: %s\n\n", (fail ? "FAIL" : "PASS"));
+        if (fail) fail_n++;
+    }
+
+    // Pass criteria (internal precision below that of the centres):
+    // 1) Arpra y contains (1 + 2^-20)^2 - (1 + 2^-19) = 2^-40, which is lost
+    //    if the products are sized by the internal precision.
+    fail = 0;
+    mpfr_set_ui_2exp(alpha[0], 1, -20, MPFR_RNDN);
+    mpfr_add_ui(alpha[0], alpha[0], 1, MPFR_RNDN);
+    mpfr_set_si(alpha[1], -1, MPFR_RNDN);
+    arpra_set_mpfr(&(x[0]), alpha[0]);
+    mpfr_set_ui_2exp(x_sum, 1, -19, MPFR_RNDN);
+    mpfr_add_ui(x_sum, x_sum, 1, MPFR_RNDN);
+    arpra_set_mpfr(&(x[1]), x_sum);
+    mpfr_sqr(x_value, alpha[0], MPFR_RNDN);
+    mpfr_sub(x_value, x_value, x_sum, MPFR_RNDN);
+    arpra_set_internal_precision(prec / 3);
+    arpra_lincomb(&y_dense, x, alpha_ptr, 2);
+    if (mpfr_less_p(x_value, &(y_dense.true_range.left))) fail = 1;
+    if (mpfr_greater_p(x_value, &(y_dense.true_range.right))) fail = 1;
+    arpra_set_internal_precision(prec_internal);
+    test_log_printf("Test %lu: internal precision %lu\n", test_n, (prec / 3));
+    test_log_printf("Result: %s\n\n", (fail ? "FAIL" : "PASS"));
+    if (fail) fail_n++;
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, test_n + 1);
+    for (j = 0; j < range_n; j++) {
+        arpra_clear(&(x[j]));
+        arpra_clear(&(x_sparse[j]));
+        mpfr_clear(alpha[j]);
+    }
+    arpra_clear(&y_dense);
+    arpra_clear(&y_sparse);
+    mpfr_clear(x_value);
+    mpfr_clear(x_sum);
+    test_fixture_clear();
+    test_log_clear();
+    test_rand_clear();
+    return fail_n > 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * t_max_terms.c -- Test the global cap on the number of deviation terms.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "arpra-test.h"
+
+static void max_terms_op (arpra_range *y, arpra_range *x, const mpfr_ptr *alpha, arpra_uint op)
+{
+    // y = op(x), for one of four operations.
+    switch (op) {
+    case 0:
+        arpra_add(y, &(x[0]), &(x[1]));
+        break;
+    case 1:
+        arpra_mul(y, &(x[0]), &(x[1]));
+        break;
+    case 2:
+        arpra_sum(y, x, 3);
+        break;
+    default:
+        arpra_lincomb(y, x, alpha, 3);
+        break;
+    }
+}
+
+static void max_terms_value (mpfr_ptr y, const arpra_range *x, const mpfr_ptr *alpha,
+                             arpra_uint op, arpra_uint sample)
+{
+    mpfr_t x_value;
+    arpra_uint j;
+
+    // The exact value of op(x) for the sampled symbols.
+    mpfr_init2(x_value, mpfr_get_prec(y));
+    test_sample_value(y, &(x[0]), sample);
+    if (op == 3) mpfr_mul(y, y, alpha[0], MPFR_RNDN);
+    for (j = 1; j < ((op < 2) ? 2 : 3); j++) {
+        test_sample_value(x_value, &(x[j]), sample);
+        if (op == 3) mpfr_mul(x_value, x_value, alpha[j], MPFR_RNDN);
+        if (op == 1) {
+            mpfr_mul(y, y, x_value, MPFR_RNDN);
+        }
+        else {
+            mpfr_add(y, y, x_value, MPFR_RNDN);
+        }
+    }
+    mpfr_clear(x_value);
+}
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 24;
+    const arpra_prec prec_internal = 256;
+    const arpra_uint test_n = 10000;
+    const arpra_uint sample_n = 16;
+    const char *op_names[] = {"add", "mul", "sum", "lincomb"};
+    arpra_range x[3], y, y_off, y_big;
+    mpfr_t alpha[3];
+    mpfr_ptr alpha_ptr[3];
+    mpfr_t y_value;
+    arpra_uint i, j, k, op, fresh, sample, fail, fail_n;
+
+    // Init test.
+    test_fixture_init(prec, prec_internal);
+    arpra_set_range_method(ARPRA_AA);
+    test_log_init("max_terms");
+    test_rand_init();
+    mpfr_init2(y_value, (4 * prec_internal));
+    arpra_init2(&y, prec);
+    arpra_init2(&y_off, prec);
+    arpra_init2(&y_big, prec);
+    for (j = 0; j < 3; j++) {
+        arpra_init2(&(x[j]), prec);
+        mpfr_init2(alpha[j], prec);
+        alpha_ptr[j] = alpha[j];
+    }
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < test_n; i++) {
+        fail = 0;
+        op = i % 4;
+        k = 1 + gmp_urandomm_ui(test_randstate, 4);
+        for (j = 0; j < 3; j++) {
+            test_rand_arpra(&(x[j]), TEST_RAND_MIXED, TEST_RAND_SMALL);
+            test_rand_mpfr(alpha[j], prec, TEST_RAND_MIXED);
+        }
+        test_share_rand_syms(&(x[0]), &(x[1]));
+        test_share_rand_syms(&(x[1]), &(x[2]));
+
+        // Each result gets the same new symbol, so that they can be compared.
+        fresh = arpra_helper_get_symbol_count();
+        arpra_set_max_terms(0);
+        max_terms_op(&y_off, x, alpha_ptr, op);
+        arpra_helper_set_symbol_count(fresh);
+        arpra_set_max_terms(y_off.nTerms);
+        max_terms_op(&y_big, x, alpha_ptr, op);
+        arpra_helper_set_symbol_count(fresh);
+        arpra_set_max_terms(k);
+        max_terms_op(&y, x, alpha_ptr, op);
+        arpra_set_max_terms(0);
+
+        // Pass criteria:
+        // 1) Arpra y (no cap) = Arpra y (cap not reached).
+        // 2) Arpra y (cap k) has at most k terms.
+        // 3) Arpra y (cap k) contains Arpra y (no cap).
+        // 4) Arpra y (cap k) contains op(x), with its kept symbols still correlated.
+        if (test_compare_arpra(&y_off, &y_big)) fail = 1;
+        if (y.nTerms > k) fail = 1;
+        if (arpra_bounded_p(&y_off)) {
+            if (mpfr_greater_p(&(y.true_range.left), &(y_off.true_range.left))) fail = 1;
+            if (mpfr_less_p(&(y.true_range.right), &(y_off.true_range.right))) fail = 1;
+        }
+        for (sample = 0; sample < sample_n; sample++) {
+            max_terms_value(y_value, x, alpha_ptr, op, sample);
+            if (!test_sample_contains(&y, y_value, fresh, sample)) fail = 1;
+        }
+
+        test_log_printf("Test %lu: %s, k = %lu, %lu terms to %lu terms\n",
+                        i, op_names[op], k, y_off.nTerms, y.nTerms);
+        test_log_printf("Result: %s\n\n", (fail ? "FAIL" : "PASS"));
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, test_n);
+    for (j = 0; j < 3; j++) {
+        arpra_clear(&(x[j]));
+        mpfr_clear(alpha[j]);
+    }
+    arpra_clear(&y);
+    arpra_clear(&y_off);
+    arpra_clear(&y_big);
+    mpfr_clear(y_value);
+    test_fixture_clear();
+    test_log_clear();
+    test_rand_clear();
+    return fail_n > 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * t_ode_adaptive.c -- Test the arpra_ode_stepper_step_adaptive function.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-test.h"
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 53;
+    const arpra_prec prec_internal = 256;
+    const arpra_ode_method *methods[] = {
+        arpra_ode_bogsham32, arpra_ode_dopri54, arpra_ode_dopri87
+    };
+    const arpra_uint methods_n = sizeof(methods) / sizeof(methods[0]);
+    arpra_uint i, n_reject, fail, fail_n;
+    arpra_ode_stepper stepper;
+    arpra_range h;
+    mpfr_t tol, tol_tiny, t_old, x_old, r_old;
+    test_ode ode;
+
+    // Init test.
+    arpra_set_internal_precision(prec_internal);
+    arpra_init2(&h, prec);
+    mpfr_init2(tol, prec);
+    mpfr_init2(tol_tiny, prec);
+    mpfr_init2(t_old, prec_internal);
+    mpfr_init2(x_old, prec_internal);
+    mpfr_init2(r_old, prec_internal);
+    mpfr_set_d(tol, 1e-8, MPFR_RNDN);
+    mpfr_set_d(tol_tiny, 1e-300, MPFR_RNDN);
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < methods_n; i++) {
+        fail = 0;
+        test_ode_init(&ode, 1, 2, -1.0, 0.0, prec);
+        arpra_ode_stepper_init(&stepper, &(ode.system), methods[i]);
+
+        // Pass criteria (accepted step):
+        // 1) An oversized step is rejected, then accepted with a smaller h.
+        // 2) t advances, and x is within tolerance of exp(-t) x(0).
+        arpra_set_d(&h, 4.0);
+        n_reject = arpra_ode_stepper_step_adaptive(&stepper, &h, tol, NULL);
+        if ((n_reject == 0) || (n_reject == ARPRA_ODE_STEP_FAILED)) fail = 1;
+        if (mpfr_sgn(&(ode.t.centre)) <= 0) fail = 1;
+        if (fabs(mpfr_get_d(&(ode.x[0][0].centre), MPFR_RNDN)
+                 - exp(-mpfr_get_d(&(ode.t.centre), MPFR_RNDN))) > 1e-6) fail = 1;
+
+        // Pass criteria (failed step):
+        // 1) The step is reported as failed.
+        // 2) t and x are unchanged.
+        // 3) h is reduced.
+        mpfr_set(t_old, &(ode.t.centre), MPFR_RNDN);
+        mpfr_set(x_old, &(ode.x[0][0].centre), MPFR_RNDN);
+        mpfr_set(r_old, &(ode.x[0][0].radius), MPFR_RNDN);
+        arpra_set_d(&h, 1.0);
+        n_reject = arpra_ode_stepper_step_adaptive(&stepper, &h, tol_tiny, NULL);
+        if (n_reject != ARPRA_ODE_STEP_FAILED) fail = 1;
+        if (!mpfr_equal_p(t_old, &(ode.t.centre))) fail = 1;
+        if (!mpfr_equal_p(x_old, &(ode.x[0][0].centre))) fail = 1;
+        if (!mpfr_equal_p(r_old, &(ode.x[0][0].radius))) fail = 1;
+        if (mpfr_cmp_d(&(h.centre), 1.0) >= 0) fail = 1;
+
+        printf("Method %lu: %s\n", i, (fail ? "FAIL" : "PASS"));
+        arpra_ode_stepper_clear(&stepper);
+        test_ode_clear(&ode);
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, methods_n);
+    arpra_clear(&h);
+    mpfr_clear(tol);
+    mpfr_clear(tol_tiny);
+    mpfr_clear(t_old);
+    mpfr_clear(x_old);
+    mpfr_clear(r_old);
+    arpra_ode_clear_tableaus();
+    arpra_clear_buffers();
+    mpfr_free_cache();
+    return fail_n > 0;
+}
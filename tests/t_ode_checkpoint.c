@@ -0,0 +1,206 @@
+/*
+ * t_ode_checkpoint.c -- Test ODE checkpoints and binary range import.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "arpra-test.h"
+
+static int same_terms_p (const arpra_range *x, const arpra_range *y, arpra_uint symbol_offset)
+{
+    arpra_uint i;
+
+    // Check that x and y are equal, with the symbols of y shifted by symbol_offset.
+    if (!mpfr_equal_p(&(x->centre), &(y->centre))) return 0;
+    if (!mpfr_equal_p(&(x->radius), &(y->radius))) return 0;
+    if (x->nTerms != y->nTerms) return 0;
+    for (i = 0; i < x->nTerms; i++) {
+        if (x->symbols[i] != (y->symbols[i] + symbol_offset)) return 0;
+        if (!mpfr_equal_p(&(x->deviations[i]), &(y->deviations[i]))) return 0;
+    }
+
+    return 1;
+}
+
+static int truncate_file (const char *path, const char *path_bad)
+{
+    FILE *stream;
+    char *buf;
+    long n;
+
+    // Copy the first half of path to path_bad.
+    stream = fopen(path, "rb");
+    if (stream == NULL) return 1;
+    fseek(stream, 0, SEEK_END);
+    n = ftell(stream) / 2;
+    rewind(stream);
+    buf = malloc(n);
+    n = fread(buf, 1, n, stream);
+    fclose(stream);
+    stream = fopen(path_bad, "wb");
+    if (stream == NULL) return 1;
+    fwrite(buf, 1, n, stream);
+    fclose(stream);
+    free(buf);
+
+    return 0;
+}
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 53;
+    const arpra_prec prec_internal = 256;
+    const arpra_ode_method *methods[] = {
+        arpra_ode_bogsham32, arpra_ode_dopri54, arpra_ode_ab3, arpra_ode_abm3
+    };
+    const arpra_uint methods_n = sizeof(methods) / sizeof(methods[0]);
+    const arpra_uint grps = 2;
+    const arpra_uint dims = 2;
+    const char *path = "t_ode_checkpoint.dat";
+    const char *path_bad = "t_ode_checkpoint_bad.dat";
+    arpra_uint i, j, x_grp, x_dim, lo, hi, n_before, symbol_count, fail, fail_n;
+    arpra_ode_stepper stepper, stepper_load;
+    arpra_range h, x_saved[2], x_loaded[2], *x_first;
+    mpfr_t c_before, r_before;
+    test_ode ode, ode_load;
+    FILE *stream;
+
+    // Init test.
+    arpra_set_internal_precision(prec_internal);
+    arpra_init2(&h, prec);
+    mpfr_init2(c_before, prec_internal);
+    mpfr_init2(r_before, prec_internal);
+    for (j = 0; j < 2; j++) {
+        arpra_init2(&(x_saved[j]), prec);
+        arpra_init2(&(x_loaded[j]), prec);
+    }
+    arpra_set_d(&h, 0.125);
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < methods_n; i++) {
+        fail = 0;
+        arpra_set_mul_method(ARPRA_MUL_TRIVIAL);
+        test_ode_init(&ode, grps, dims, -1.0, 0.01, prec);
+        test_ode_init(&ode_load, grps, dims, -1.0, 0.01, prec);
+        arpra_ode_stepper_init(&stepper, &(ode.system), methods[i]);
+        arpra_ode_stepper_init(&stepper_load, &(ode_load.system), methods[i]);
+        for (j = 0; j < 4; j++) {
+            arpra_ode_stepper_step(&stepper, &h);
+        }
+        if (arpra_ode_checkpoint_save(path, &stepper)) fail = 1;
+
+        // Pass criteria (load):
+        // 1) The loaded state equals the saved state, with its symbols shifted
+        //    past those in use before loading.
+        // 2) The saved configuration is not restored unless asked for.
+        arpra_set_mul_method(ARPRA_MUL_RUMP_KASHIWAGI);
+        lo = arpra_helper_get_symbol_count();
+        if (arpra_ode_checkpoint_load(path, &stepper_load, 0)) fail = 1;
+        hi = arpra_helper_get_symbol_count();
+        if (arpra_get_mul_method() != ARPRA_MUL_RUMP_KASHIWAGI) fail = 1;
+        if (!same_terms_p(&(ode_load.t), &(ode.t), lo)) fail = 1;
+        for (x_grp = 0; x_grp < grps; x_grp++) {
+            for (x_dim = 0; x_dim < dims; x_dim++) {
+                if (!same_terms_p(&(ode_load.x[x_grp][x_dim]), &(ode.x[x_grp][x_dim]), lo)) fail = 1;
+                if ((ode_load.x[x_grp][x_dim].nTerms > 0)
+                    && (ode_load.x[x_grp][x_dim].symbols[0] < lo)) fail = 1;
+                if ((ode_load.x[x_grp][x_dim].nTerms > 0)
+                    && (ode_load.x[x_grp][x_dim].symbols[ode_load.x[x_grp][x_dim].nTerms - 1] >= hi)) fail = 1;
+            }
+        }
+
+        // Pass criteria (steps after loading):
+        // 1) The loaded stepper matches the saved one, which was not
+        //    interrupted. Multistep methods resume from their saved history.
+        arpra_set_mul_method(ARPRA_MUL_TRIVIAL);
+        for (j = 0; j < 4; j++) {
+            arpra_ode_stepper_step(&stepper, &h);
+            arpra_ode_stepper_step(&stepper_load, &h);
+        }
+        for (x_grp = 0; x_grp < grps; x_grp++) {
+            for (x_dim = 0; x_dim < dims; x_dim++) {
+                if (!mpfr_equal_p(&(ode_load.x[x_grp][x_dim].centre), &(ode.x[x_grp][x_dim].centre))) fail = 1;
+                if (fabs(mpfr_get_d(&(ode_load.x[x_grp][x_dim].radius), MPFR_RNDN)
+                         / mpfr_get_d(&(ode.x[x_grp][x_dim].radius), MPFR_RNDN) - 1) > 1e-9) fail = 1;
+            }
+        }
+
+        // Pass criteria (truncated checkpoint):
+        // 1) Loading fails, and leaves the system unchanged.
+        if (truncate_file(path, path_bad)) fail = 1;
+        x_first = &(ode_load.x[0][0]);
+        mpfr_set(c_before, &(x_first->centre), MPFR_RNDN);
+        mpfr_set(r_before, &(x_first->radius), MPFR_RNDN);
+        n_before = x_first->nTerms;
+        if (!arpra_ode_checkpoint_load(path_bad, &stepper_load, 1)) fail = 1;
+        if (!mpfr_equal_p(&(x_first->centre), c_before)) fail = 1;
+        if (!mpfr_equal_p(&(x_first->radius), r_before)) fail = 1;
+        if (x_first->nTerms != n_before) fail = 1;
+
+        // Pass criteria (restored configuration):
+        // 1) The saved configuration is restored if asked for.
+        arpra_set_mul_method(ARPRA_MUL_RUMP_KASHIWAGI);
+        if (arpra_ode_checkpoint_load(path, &stepper_load, 1)) fail = 1;
+        if (arpra_get_mul_method() != ARPRA_MUL_TRIVIAL) fail = 1;
+
+        // Pass criteria (binary range import):
+        // 1) Imported ranges keep their saved symbols, and the symbol counter
+        //    is advanced past them. The counter is rewound to check this.
+        stream = tmpfile();
+        for (j = 0; j < 2; j++) {
+            arpra_set(&(x_saved[j]), &(ode.x[0][j]));
+            if (arpra_fpif_export(stream, &(x_saved[j]))) fail = 1;
+        }
+        rewind(stream);
+        symbol_count = arpra_helper_get_symbol_count();
+        arpra_helper_set_symbol_count(0);
+        for (j = 0; j < 2; j++) {
+            if (arpra_fpif_import(&(x_loaded[j]), stream)) fail = 1;
+            if (!same_terms_p(&(x_loaded[j]), &(x_saved[j]), 0)) fail = 1;
+            if ((x_loaded[j].nTerms > 0)
+                && (x_loaded[j].symbols[x_loaded[j].nTerms - 1] >= arpra_helper_get_symbol_count())) fail = 1;
+        }
+        fclose(stream);
+        arpra_helper_set_symbol_count(symbol_count);
+
+        printf("Method %lu: %s\n", i, (fail ? "FAIL" : "PASS"));
+        arpra_ode_stepper_clear(&stepper);
+        arpra_ode_stepper_clear(&stepper_load);
+        test_ode_clear(&ode);
+        test_ode_clear(&ode_load);
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, methods_n);
+    remove(path);
+    remove(path_bad);
+    arpra_clear(&h);
+    mpfr_clear(c_before);
+    mpfr_clear(r_before);
+    for (j = 0; j < 2; j++) {
+        arpra_clear(&(x_saved[j]));
+        arpra_clear(&(x_loaded[j]));
+    }
+    arpra_ode_clear_tableaus();
+    arpra_clear_buffers();
+    mpfr_free_cache();
+    return fail_n > 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * t_ode_ensemble.c -- Test parallel runs of ODE system ensembles.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "arpra-test.h"
+
+typedef struct progress_count_struct
+{
+    arpra_uint calls;
+    arpra_uint bad;
+    arpra_uint n_systems;
+} progress_count;
+
+static void count_progress (void *data, const arpra_uint member,
+                            const arpra_uint step, const arpra_uint n_steps)
+{
+    progress_count *count = (progress_count *) data;
+
+    // Count the calls, and those with a bad member or step.
+    count->calls++;
+    if ((member >= count->n_systems) || (step < 1) || (step > n_steps)) count->bad++;
+}
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 53;
+    const arpra_prec prec_internal = 256;
+    const arpra_ode_method *methods[] = {
+        arpra_ode_dopri54, arpra_ode_abm3
+    };
+    const arpra_uint methods_n = sizeof(methods) / sizeof(methods[0]);
+    const arpra_uint n_systems = 6;
+    const arpra_uint grps = 1;
+    const arpra_uint dims = 2;
+    const arpra_uint steps = 8;
+    arpra_uint i, j, k, x_dim, fail, fail_n;
+    arpra_ode_system systems[n_systems];
+    arpra_ode_stepper stepper;
+    progress_count count;
+    arpra_range h;
+    test_ode ode[n_systems], ode_ref;
+
+    // Init test.
+    arpra_set_internal_precision(prec_internal);
+    arpra_init2(&h, prec);
+    arpra_set_d(&h, 0.125);
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < methods_n; i++) {
+        fail = 0;
+
+        // Members differ in their decay rate.
+        for (k = 0; k < n_systems; k++) {
+            test_ode_init(&(ode[k]), grps, dims, -0.5 * (k + 1), 0.01, prec);
+            systems[k] = ode[k].system;
+        }
+        count = (progress_count) {.calls = 0, .bad = 0, .n_systems = n_systems};
+        arpra_ode_ensemble_run(systems, n_systems, methods[i], &h, steps, NULL,
+                               count_progress, &count);
+
+        // Pass criteria:
+        // 1) Progress is reported once per step of each member.
+        // 2) Each member matches a run of the same system on its own.
+        if (count.calls != (n_systems * steps)) fail = 1;
+        if (count.bad > 0) fail = 1;
+        for (k = 0; k < n_systems; k++) {
+            test_ode_init(&ode_ref, grps, dims, -0.5 * (k + 1), 0.01, prec);
+            arpra_ode_stepper_init(&stepper, &(ode_ref.system), methods[i]);
+            for (j = 0; j < steps; j++) {
+                arpra_ode_stepper_step(&stepper, &h);
+            }
+            if (!mpfr_equal_p(&(ode[k].t.centre), &(ode_ref.t.centre))) fail = 1;
+            for (x_dim = 0; x_dim < dims; x_dim++) {
+                if (!mpfr_equal_p(&(ode[k].x[0][x_dim].centre), &(ode_ref.x[0][x_dim].centre))) fail = 1;
+                if (!mpfr_equal_p(&(ode[k].x[0][x_dim].radius), &(ode_ref.x[0][x_dim].radius))) fail = 1;
+            }
+            arpra_ode_stepper_clear(&stepper);
+            test_ode_clear(&ode_ref);
+        }
+
+        printf("Method %lu: %s\n", i, (fail ? "FAIL" : "PASS"));
+        for (k = 0; k < n_systems; k++) {
+            test_ode_clear(&(ode[k]));
+        }
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, methods_n);
+    arpra_clear(&h);
+    arpra_ode_clear_tableaus();
+    arpra_clear_buffers();
+    mpfr_free_cache();
+    return fail_n > 0;
+}
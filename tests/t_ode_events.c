@@ -0,0 +1,170 @@
+/*
+ * t_ode_events.c -- Test the detection and location of ODE events.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "arpra-test.h"
+
+static void oscillator_f (arpra_range *dxdt, const void *params,
+                          const arpra_range *t, const arpra_range **x,
+                          const arpra_uint x_grp, const arpra_uint x_dim)
+{
+    // dx0/dt = x1, dx1/dt = -x0
+    if (x_dim == 0) {
+        arpra_set(dxdt, &(x[x_grp][1]));
+    }
+    else {
+        arpra_neg(dxdt, &(x[x_grp][0]));
+    }
+}
+
+static void threshold_g (arpra_range *g, const void *params,
+                         const arpra_range *t, const arpra_range **x)
+{
+    const arpra_range *threshold = (const arpra_range *) params;
+
+    // g = x0 - threshold
+    arpra_sub(g, &(x[0][0]), threshold);
+}
+
+static void reset_apply (arpra_range **x, const void *params,
+                         const arpra_range *t)
+{
+    arpra_range one;
+
+    // x0 = x0 + 1
+    arpra_init2(&one, arpra_get_precision(&(x[0][0])));
+    arpra_set_d(&one, 1.0);
+    arpra_add(&(x[0][0]), &(x[0][0]), &one);
+    arpra_clear(&one);
+}
+
+static int contains_d (const arpra_range *x, double y)
+{
+    mpfr_t yy;
+    int contains;
+
+    mpfr_init2(yy, 53);
+    mpfr_set_d(yy, y, MPFR_RNDN);
+    contains = test_ode_contains_mpfr(x, yy);
+    mpfr_clear(yy);
+    return contains;
+}
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 53;
+    const arpra_prec prec_internal = 256;
+    const arpra_ode_method *methods[] = {
+        arpra_ode_dopri54, arpra_ode_dopri87
+    };
+    const arpra_uint methods_n = sizeof(methods) / sizeof(methods[0]);
+    const double tol = 1e-2;
+    arpra_uint i, j, r, events_n, fail, fail_n;
+    arpra_ode_stepper stepper;
+    arpra_ode_event event;
+    arpra_range h, threshold;
+    test_ode ode;
+
+    // Init test.
+    arpra_set_internal_precision(prec_internal);
+    arpra_init2(&h, prec);
+    arpra_init2(&threshold, prec);
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < methods_n; i++) {
+        fail = 0;
+
+        // x(t) = x(0) exp(-t), with x(0) = 1 +/- 0.05, reset by 1 when it falls to 0.5.
+        test_ode_init(&ode, 1, 1, -1.0, 0.05, prec);
+        arpra_set_d(&threshold, 0.5);
+        event = (arpra_ode_event) {
+            .g = threshold_g,
+            .apply = reset_apply,
+            .params = &threshold,
+            .direction = -1,
+        };
+        ode.system.events = &event;
+        ode.system.n_events = 1;
+        arpra_ode_stepper_init(&stepper, &(ode.system), methods[i]);
+        arpra_set_d(&h, 0.25);
+        events_n = 0;
+        for (j = 0; (j < 100) && (mpfr_get_d(&(ode.t.centre), MPFR_RNDN) < 3.0); j++) {
+            r = arpra_ode_stepper_step_events(&stepper, &h);
+            if (r == 0) continue;
+            if (r != 1) fail = 1;
+
+            // Pass criteria (first event):
+            // 1) t encloses the crossing times log(2 x(0)) of every x(0).
+            if (events_n == 0) {
+                if (!contains_d(&(ode.t), log(1.9) + tol)) fail = 1;
+                if (!contains_d(&(ode.t), log(2.1) - tol)) fail = 1;
+            }
+            events_n++;
+        }
+
+        // Pass criteria (decay):
+        // 1) The event occurs once per crossing, at about 0.69, 1.79 and 2.89.
+        if (events_n != 3) fail = 1;
+        arpra_ode_stepper_clear(&stepper);
+        test_ode_clear(&ode);
+
+        // x0(t) = cos(t), which dips below -0.95 and back within the step [2.8, 3.5].
+        test_ode_init(&ode, 1, 2, 0.0, 0.0, prec);
+        ode.f[0] = oscillator_f;
+        arpra_set_d(&(ode.x[0][0]), 1.0);
+        arpra_set_zero(&(ode.x[0][1]));
+        arpra_set_d(&threshold, -0.95);
+        event = (arpra_ode_event) {
+            .g = threshold_g,
+            .params = &threshold,
+            .direction = -1,
+        };
+        ode.system.events = &event;
+        ode.system.n_events = 1;
+        arpra_ode_stepper_init(&stepper, &(ode.system), methods[i]);
+        arpra_set_d(&h, 0.7);
+
+        // Pass criteria (double crossing):
+        // 1) The event occurs in the fifth step, although g > 0 at both its ends.
+        // 2) t encloses both crossing times, acos(-0.95) and 2 pi - acos(-0.95).
+        for (j = 0; j < 4; j++) {
+            if (arpra_ode_stepper_step_events(&stepper, &h) != 0) fail = 1;
+        }
+        if (arpra_ode_stepper_step_events(&stepper, &h) != 1) fail = 1;
+        if (!contains_d(&(ode.t), acos(-0.95) + tol)) fail = 1;
+        if (!contains_d(&(ode.t), (2 * M_PI) - acos(-0.95) - tol)) fail = 1;
+        arpra_ode_stepper_clear(&stepper);
+        test_ode_clear(&ode);
+
+        printf("Method %lu: %s\n", i, (fail ? "FAIL" : "PASS"));
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, methods_n);
+    arpra_clear(&h);
+    arpra_clear(&threshold);
+    arpra_ode_clear_tableaus();
+    arpra_clear_buffers();
+    mpfr_free_cache();
+    return fail_n > 0;
+}
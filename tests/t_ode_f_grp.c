@@ -0,0 +1,109 @@
+/*
+ * t_ode_f_grp.c -- Test group-level ODE callbacks.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "arpra-test.h"
+
+static arpra_uint grp_calls;
+
+static void grp_linear_f (arpra_range *dxdt, const void *params, arpra_range *temp,
+                          const arpra_range *t, const arpra_range **x,
+                          const arpra_uint x_grp, const arpra_uint x_dims)
+{
+    const arpra_range *lambda = (const arpra_range *) params;
+    arpra_uint x_dim;
+
+    // dx/dt = lambda x, formed in the group's scratch range.
+    grp_calls++;
+    for (x_dim = 0; x_dim < x_dims; x_dim++) {
+        arpra_mul(&(temp[0]), lambda, &(x[x_grp][x_dim]));
+        arpra_swap(&(dxdt[x_dim]), &(temp[0]));
+    }
+}
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 53;
+    const arpra_prec prec_internal = 256;
+    const arpra_ode_method *methods[] = {
+        arpra_ode_euler, arpra_ode_dopri54, arpra_ode_abm3
+    };
+    const arpra_uint methods_n = sizeof(methods) / sizeof(methods[0]);
+    const arpra_uint grps = 2;
+    const arpra_uint dims = 3;
+    const arpra_uint steps = 6;
+    arpra_ode_f_grp f_grp[2] = {grp_linear_f, NULL};
+    arpra_uint f_grp_temps[2] = {1, 0};
+    arpra_uint i, j, x_grp, x_dim, fail, fail_n;
+    arpra_ode_stepper stepper, stepper_ref;
+    arpra_range h;
+    test_ode ode, ode_ref;
+
+    // Init test.
+    arpra_set_internal_precision(prec_internal);
+    arpra_init2(&h, prec);
+    arpra_set_d(&h, 0.125);
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < methods_n; i++) {
+        fail = 0;
+
+        // Group 0 is evaluated by its group callback, and group 1 by f.
+        test_ode_init(&ode, grps, dims, -1.0, 0.01, prec);
+        test_ode_init(&ode_ref, grps, dims, -1.0, 0.01, prec);
+        ode.system.f_grp = f_grp;
+        ode.system.f_grp_temps = f_grp_temps;
+        arpra_ode_stepper_init(&stepper, &(ode.system), methods[i]);
+        arpra_ode_stepper_init(&stepper_ref, &(ode_ref.system), methods[i]);
+        grp_calls = 0;
+        for (j = 0; j < steps; j++) {
+            arpra_ode_stepper_step(&stepper, &h);
+            arpra_ode_stepper_step(&stepper_ref, &h);
+        }
+
+        // Pass criteria:
+        // 1) The group callback was called.
+        // 2) The state matches that of a system evaluated by f alone.
+        if (grp_calls == 0) fail = 1;
+        for (x_grp = 0; x_grp < grps; x_grp++) {
+            for (x_dim = 0; x_dim < dims; x_dim++) {
+                if (!mpfr_equal_p(&(ode.x[x_grp][x_dim].centre), &(ode_ref.x[x_grp][x_dim].centre))) fail = 1;
+                if (!mpfr_equal_p(&(ode.x[x_grp][x_dim].radius), &(ode_ref.x[x_grp][x_dim].radius))) fail = 1;
+            }
+        }
+
+        printf("Method %lu: %s\n", i, (fail ? "FAIL" : "PASS"));
+        arpra_ode_stepper_clear(&stepper);
+        arpra_ode_stepper_clear(&stepper_ref);
+        test_ode_clear(&ode);
+        test_ode_clear(&ode_ref);
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, methods_n);
+    arpra_clear(&h);
+    arpra_ode_clear_tableaus();
+    arpra_clear_buffers();
+    mpfr_free_cache();
+    return fail_n > 0;
+}
@@ -0,0 +1,88 @@
+/*
+ * t_ode_interpolate.c -- Test the arpra_ode_stepper_interpolate function.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "arpra-test.h"
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 53;
+    const arpra_prec prec_internal = 256;
+    const arpra_ode_method *methods[] = {
+        arpra_ode_bogsham32, arpra_ode_dopri54, arpra_ode_dopri87
+    };
+    const double tols[] = {1e-3, 1e-6, 1e-4};
+    const arpra_uint methods_n = sizeof(methods) / sizeof(methods[0]);
+    arpra_uint i, j, fail, fail_n;
+    arpra_ode_stepper stepper;
+    arpra_range h, t_mid;
+    double t;
+    test_ode ode, ode_mid;
+
+    // Init test.
+    arpra_set_internal_precision(prec_internal);
+    arpra_init2(&h, prec);
+    arpra_init2(&t_mid, prec);
+    arpra_set_d(&h, 0.25);
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < methods_n; i++) {
+        fail = 0;
+        test_ode_init(&ode, 1, 2, -1.0, 0.0, prec);
+        test_ode_init(&ode_mid, 1, 2, -1.0, 0.0, prec);
+        arpra_ode_stepper_init(&stepper, &(ode.system), methods[i]);
+        arpra_ode_stepper_step(&stepper, &h);
+        arpra_ode_stepper_step(&stepper, &h);
+
+        // Pass criteria (middle of the last step):
+        // 1) x is within the method's tolerance of exp(-t) x(0).
+        arpra_set_d(&t_mid, 0.375);
+        arpra_ode_stepper_interpolate(&stepper, ode_mid.x, &t_mid);
+        t = mpfr_get_d(&(t_mid.centre), MPFR_RNDN);
+        for (j = 0; j < 2; j++) {
+            if (fabs(mpfr_get_d(&(ode_mid.x[0][j].centre), MPFR_RNDN)
+                     - (1 + (j / 8.)) * exp(-t)) > tols[i]) fail = 1;
+        }
+
+        // Pass criteria (end of the last step):
+        // 1) The interpolant encloses the centre of the stepped state.
+        arpra_ode_stepper_interpolate(&stepper, ode_mid.x, &(ode.t));
+        for (j = 0; j < 2; j++) {
+            if (!test_ode_contains_mpfr(&(ode_mid.x[0][j]), &(ode.x[0][j].centre))) fail = 1;
+        }
+
+        printf("Method %lu: %s\n", i, (fail ? "FAIL" : "PASS"));
+        arpra_ode_stepper_clear(&stepper);
+        test_ode_clear(&ode);
+        test_ode_clear(&ode_mid);
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, methods_n);
+    arpra_clear(&h);
+    arpra_clear(&t_mid);
+    arpra_ode_clear_tableaus();
+    arpra_clear_buffers();
+    mpfr_free_cache();
+    return fail_n > 0;
+}
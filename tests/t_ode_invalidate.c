@@ -0,0 +1,129 @@
+/*
+ * t_ode_invalidate.c -- Test reuse of data carried between ODE steps.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "arpra-test.h"
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 53;
+    const arpra_prec prec_internal = 256;
+    const arpra_ode_method *methods[] = {
+        arpra_ode_bogsham32, arpra_ode_dopri54, arpra_ode_dopri87,
+        arpra_ode_ab3, arpra_ode_abm3
+    };
+    const int methods_carry[] = {1, 1, 0, 1, 1};
+    const arpra_uint methods_n = sizeof(methods) / sizeof(methods[0]);
+    arpra_uint i, j, i_x, i_h, fail, fail_n;
+    arpra_ode_stepper stepper, stepper_ref;
+    arpra_range h;
+    mpfr_t delta;
+    mpfi_t h_i;
+    test_ode ode, ode_ref;
+
+    // Init test.
+    arpra_set_internal_precision(prec_internal);
+    arpra_init2(&h, prec);
+    mpfr_init2(delta, prec);
+    mpfi_init2(h_i, prec);
+    mpfr_set_d(delta, 0.25, MPFR_RNDN);
+    mpfi_interv_d(h_i, 0.125 - 1e-6, 0.125 + 1e-6);
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < methods_n; i++) {
+        fail = 0;
+        arpra_set_d(&h, 0.125);
+        test_ode_init(&ode, 1, 2, -1.0, 0.0, prec);
+        test_ode_init(&ode_ref, 1, 2, -1.0, 0.0, prec);
+        arpra_ode_stepper_init(&stepper, &(ode.system), methods[i]);
+        arpra_ode_stepper_init(&stepper_ref, &(ode_ref.system), methods[i]);
+
+        // Pass criteria (record):
+        // 1) Only methods which carry data between steps record the state.
+        if ((stepper.record != NULL) != methods_carry[i]) fail = 1;
+
+        for (j = 0; j < 6; j++) {
+            arpra_ode_stepper_step(&stepper, &h);
+            arpra_ode_stepper_step(&stepper_ref, &h);
+        }
+        if (fabs(mpfr_get_d(&(ode.x[0][0].centre), MPFR_RNDN)
+                 - exp(-mpfr_get_d(&(ode.t.centre), MPFR_RNDN))) > 1e-3) fail = 1;
+
+        // Pass criteria (state changed between steps):
+        // 1) Widening x discards the carried data without an explicit invalidate.
+        // 2) The next step matches that of a stepper which was invalidated.
+        arpra_increase(&(ode.x[0][0]), &(ode.x[0][0]), delta);
+        arpra_increase(&(ode_ref.x[0][0]), &(ode_ref.x[0][0]), delta);
+        arpra_ode_stepper_invalidate(&stepper_ref);
+        arpra_ode_stepper_step(&stepper, &h);
+        arpra_ode_stepper_step(&stepper_ref, &h);
+        for (j = 0; j < 2; j++) {
+            if (!mpfr_equal_p(&(ode.x[0][j].centre), &(ode_ref.x[0][j].centre))) fail = 1;
+            if (!mpfr_equal_p(&(ode.x[0][j].radius), &(ode_ref.x[0][j].radius))) fail = 1;
+        }
+
+        // Pass criteria (parameters changed between steps):
+        // 1) After an explicit invalidate, the step uses the new parameters.
+        arpra_set_d(&(ode.lambda), -2.0);
+        arpra_set_d(&(ode_ref.lambda), -2.0);
+        arpra_ode_stepper_invalidate(&stepper);
+        arpra_ode_stepper_invalidate(&stepper_ref);
+        arpra_ode_stepper_step(&stepper, &h);
+        arpra_ode_stepper_step(&stepper_ref, &h);
+        for (j = 0; j < 2; j++) {
+            if (!mpfr_equal_p(&(ode.x[0][j].centre), &(ode_ref.x[0][j].centre))) fail = 1;
+            if (!mpfr_equal_p(&(ode.x[0][j].radius), &(ode_ref.x[0][j].radius))) fail = 1;
+        }
+
+        // Pass criteria (h updated in place):
+        // 1) After h is set to the same value with new symbols, the step
+        //    correlates x with the new symbols of h.
+        arpra_set_mpfi(&h, h_i);
+        for (j = 0; j < 4; j++) {
+            arpra_ode_stepper_step(&stepper, &h);
+        }
+        arpra_set_mpfi(&h, h_i);
+        arpra_ode_stepper_step(&stepper, &h);
+        for (i_h = 0; i_h < h.nTerms; i_h++) {
+            for (i_x = 0; (i_x < ode.x[0][0].nTerms)
+                     && (ode.x[0][0].symbols[i_x] != h.symbols[i_h]); i_x++);
+            if (i_x == ode.x[0][0].nTerms) fail = 1;
+        }
+
+        printf("Method %lu: %s\n", i, (fail ? "FAIL" : "PASS"));
+        arpra_ode_stepper_clear(&stepper);
+        arpra_ode_stepper_clear(&stepper_ref);
+        test_ode_clear(&ode);
+        test_ode_clear(&ode_ref);
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, methods_n);
+    arpra_clear(&h);
+    mpfr_clear(delta);
+    mpfi_clear(h_i);
+    arpra_ode_clear_tableaus();
+    arpra_clear_buffers();
+    mpfr_free_cache();
+    return fail_n > 0;
+}
@@ -0,0 +1,155 @@
+/*
+ * t_ode_multirate.c -- Test multi-rate ODE stepping.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "arpra-test.h"
+
+struct rate_params
+{
+    arpra_range lambda;
+    arpra_uint n_eval;
+};
+
+static void slow_f (arpra_range *dxdt, const void *params,
+                    const arpra_range *t, const arpra_range **x,
+                    const arpra_uint x_grp, const arpra_uint x_dim)
+{
+    struct rate_params *p = (struct rate_params *) params;
+
+    // dx/dt = lambda x
+    arpra_mul(dxdt, &(p->lambda), &(x[x_grp][x_dim]));
+    p->n_eval++;
+}
+
+static void fast_f (arpra_range *dxdt, const void *params,
+                    const arpra_range *t, const arpra_range **x,
+                    const arpra_uint x_grp, const arpra_uint x_dim)
+{
+    struct rate_params *p = (struct rate_params *) params;
+
+    // dx/dt = lambda (x - x_slow)
+    arpra_sub(dxdt, &(x[x_grp][x_dim]), &(x[0][x_dim]));
+    arpra_mul(dxdt, &(p->lambda), dxdt);
+    p->n_eval++;
+}
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 53;
+    const arpra_prec prec_internal = 256;
+    const arpra_ode_method *methods[] = {
+        arpra_ode_bogsham32, arpra_ode_dopri54, arpra_ode_dopri87
+    };
+    const arpra_uint methods_n = sizeof(methods) / sizeof(methods[0]);
+    const arpra_uint ratio[3] = {1, 10, 10}, ratio_bad[3] = {1, 10, 5};
+    const arpra_uint m = 10, steps = 4;
+    const double tol = 5e-3;
+    arpra_uint i, j, x_grp, n_slow, n_fast, fail, fail_n;
+    struct rate_params p_slow, p_fast;
+    arpra_ode_stepper stepper;
+    arpra_ode_reduce reduce;
+    arpra_range h, h_sub;
+    double t, x;
+    test_ode ode;
+
+    // Init test.
+    arpra_set_internal_precision(prec_internal);
+    arpra_init2(&h, prec);
+    arpra_init2(&h_sub, prec);
+    arpra_init2(&(p_slow.lambda), prec);
+    arpra_init2(&(p_fast.lambda), prec);
+    arpra_set_d(&h, 0.25);
+    arpra_set_d(&h_sub, 0.025);
+    arpra_set_d(&(p_slow.lambda), -1.0);
+    arpra_set_d(&(p_fast.lambda), -20.0);
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < methods_n; i++) {
+        fail = 0;
+
+        // x_0 is slow, and x_1 and x_2 are fast, with h lambda = -5 for the fast groups.
+        test_ode_init(&ode, 3, 1, 0.0, 0.0, prec);
+        ode.f[0] = slow_f;
+        ode.params[0] = &p_slow;
+        for (x_grp = 1; x_grp < 3; x_grp++) {
+            ode.f[x_grp] = fast_f;
+            ode.params[x_grp] = &p_fast;
+        }
+        arpra_ode_stepper_init(&stepper, &(ode.system), methods[i]);
+        reduce = (arpra_ode_reduce) {
+            .step_terms = 1,
+        };
+        arpra_ode_stepper_set_reduce(&stepper, &reduce);
+        for (j = 0; j < steps; j++) {
+            p_slow.n_eval = 0;
+            p_fast.n_eval = 0;
+            if (arpra_ode_stepper_step_multirate(&stepper, &h, ratio) != 0) fail = 1;
+        }
+        n_slow = p_slow.n_eval;
+        n_fast = p_fast.n_eval;
+
+        // Pass criteria (accuracy):
+        // 1) x_0 = exp(-t), and the fast groups track it as x = 20/19 exp(-t).
+        t = mpfr_get_d(&(ode.t.centre), MPFR_RNDN);
+        if (fabs(t - (steps * 0.25)) > 1e-12) fail = 1;
+        for (x_grp = 0; x_grp < 3; x_grp++) {
+            x = mpfr_get_d(&(ode.x[x_grp][0].centre), MPFR_RNDN);
+            if (fabs(x - (((x_grp == 0) ? 1.0 : (20. / 19.)) * exp(-t))) > tol) fail = 1;
+        }
+
+        // Pass criteria (cost):
+        // 1) The slow groups are evaluated as often as in one plain step of h.
+        // 2) The fast groups are evaluated as often as in m plain steps of h / m.
+        p_slow.n_eval = 0;
+        arpra_ode_stepper_invalidate(&stepper);
+        arpra_ode_stepper_step(&stepper, &h);
+        if (n_slow != p_slow.n_eval) fail = 1;
+        p_fast.n_eval = 0;
+        arpra_ode_stepper_invalidate(&stepper);
+        for (j = 0; j < m; j++) {
+            arpra_ode_stepper_step(&stepper, &h_sub);
+        }
+        if (n_fast != p_fast.n_eval) fail = 1;
+
+        // Pass criteria (invalid ratios):
+        // 1) The step fails, and leaves t unchanged.
+        t = mpfr_get_d(&(ode.t.centre), MPFR_RNDN);
+        if (arpra_ode_stepper_step_multirate(&stepper, &h, ratio_bad) != ARPRA_ODE_STEP_FAILED) fail = 1;
+        if (mpfr_get_d(&(ode.t.centre), MPFR_RNDN) != t) fail = 1;
+
+        printf("Method %lu: %s\n", i, (fail ? "FAIL" : "PASS"));
+        arpra_ode_stepper_clear(&stepper);
+        test_ode_clear(&ode);
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, methods_n);
+    arpra_clear(&h);
+    arpra_clear(&h_sub);
+    arpra_clear(&(p_slow.lambda));
+    arpra_clear(&(p_fast.lambda));
+    arpra_ode_clear_tableaus();
+    arpra_clear_buffers();
+    mpfr_free_cache();
+    return fail_n > 0;
+}
@@ -0,0 +1,113 @@
+/*
+ * t_ode_precision.c -- Test ODE steppers after precision changes.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "arpra-test.h"
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec_lo = 24;
+    const arpra_prec prec_hi = 113;
+    const arpra_prec prec_internal = 256;
+    const arpra_ode_method *methods[] = {
+        arpra_ode_euler, arpra_ode_dopri54, arpra_ode_abm3, arpra_ode_ros2
+    };
+    const arpra_uint methods_n = sizeof(methods) / sizeof(methods[0]);
+    const arpra_uint dims = 2;
+    const arpra_uint steps = 3;
+    arpra_uint i, j, x_dim, fail, fail_n;
+    arpra_ode_stepper stepper, stepper_ref;
+    arpra_range h, t_hi, x_hi[2];
+    test_ode ode, ode_ref;
+
+    // Init test.
+    arpra_set_internal_precision(prec_internal);
+    arpra_init2(&h, prec_lo);
+    arpra_init2(&t_hi, prec_hi);
+    for (x_dim = 0; x_dim < dims; x_dim++) {
+        arpra_init2(&(x_hi[x_dim]), prec_hi);
+    }
+    arpra_set_d(&h, 0.125);
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < methods_n; i++) {
+        fail = 0;
+        test_ode_init(&ode, 1, dims, -1.0, 0.01, prec_lo);
+        arpra_ode_stepper_init(&stepper, &(ode.system), methods[i]);
+        for (j = 0; j < steps; j++) {
+            arpra_ode_stepper_step(&stepper, &h);
+        }
+
+        // Raise the precision of t and x, keeping their values.
+        arpra_set(&t_hi, &(ode.t));
+        arpra_set_precision(&(ode.t), prec_hi);
+        arpra_set(&(ode.t), &t_hi);
+        for (x_dim = 0; x_dim < dims; x_dim++) {
+            arpra_set(&(x_hi[x_dim]), &(ode.x[0][x_dim]));
+            arpra_set_precision(&(ode.x[0][x_dim]), prec_hi);
+            arpra_set(&(ode.x[0][x_dim]), &(x_hi[x_dim]));
+        }
+        arpra_ode_system_precision_changed(&(ode.system));
+
+        // The reference starts from the same state, at the higher precision.
+        test_ode_init(&ode_ref, 1, dims, -1.0, 0.01, prec_hi);
+        ode_ref.params[0] = &(ode.lambda);
+        arpra_set(&(ode_ref.t), &t_hi);
+        for (x_dim = 0; x_dim < dims; x_dim++) {
+            arpra_set(&(ode_ref.x[0][x_dim]), &(x_hi[x_dim]));
+        }
+        arpra_ode_stepper_init(&stepper_ref, &(ode_ref.system), methods[i]);
+        for (j = 0; j < steps; j++) {
+            arpra_ode_stepper_step(&stepper, &h);
+            arpra_ode_stepper_step(&stepper_ref, &h);
+        }
+
+        // Pass criteria:
+        // 1) The state keeps its new precision.
+        // 2) The state matches that of a stepper initialised at the new
+        //    precision, so the scratch memory was resized.
+        for (x_dim = 0; x_dim < dims; x_dim++) {
+            if (arpra_get_precision(&(ode.x[0][x_dim])) != prec_hi) fail = 1;
+            if (!mpfr_equal_p(&(ode.x[0][x_dim].centre), &(ode_ref.x[0][x_dim].centre))) fail = 1;
+            if (!mpfr_equal_p(&(ode.x[0][x_dim].radius), &(ode_ref.x[0][x_dim].radius))) fail = 1;
+        }
+
+        printf("Method %lu: %s\n", i, (fail ? "FAIL" : "PASS"));
+        arpra_ode_stepper_clear(&stepper);
+        arpra_ode_stepper_clear(&stepper_ref);
+        test_ode_clear(&ode);
+        test_ode_clear(&ode_ref);
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, methods_n);
+    arpra_clear(&h);
+    arpra_clear(&t_hi);
+    for (x_dim = 0; x_dim < dims; x_dim++) {
+        arpra_clear(&(x_hi[x_dim]));
+    }
+    arpra_ode_clear_tableaus();
+    arpra_clear_buffers();
+    mpfr_free_cache();
+    return fail_n > 0;
+}
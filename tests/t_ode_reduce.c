@@ -0,0 +1,146 @@
+/*
+ * t_ode_reduce.c -- Test the deviation term reduction policy of ODE steppers.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "arpra-test.h"
+
+static void copy_exact (arpra_range *y, const arpra_range *x1)
+{
+    arpra_uint i;
+
+    // Copy x1 to y without adding a rounding error term.
+    arpra_helper_clear_terms(y);
+    y->precision = x1->precision;
+    mpfr_set_prec(&(y->centre), mpfr_get_prec(&(x1->centre)));
+    mpfr_set(&(y->centre), &(x1->centre), MPFR_RNDN);
+    mpfr_set_prec(&(y->radius), mpfr_get_prec(&(x1->radius)));
+    mpfr_set(&(y->radius), &(x1->radius), MPFR_RNDN);
+    mpfi_set_prec(&(y->true_range), mpfi_get_prec(&(x1->true_range)));
+    mpfi_set(&(y->true_range), &(x1->true_range));
+    if (x1->nTerms > 0) {
+        y->symbols = malloc(x1->nTerms * sizeof(arpra_uint));
+        y->deviations = malloc(x1->nTerms * sizeof(mpfr_t));
+        for (i = 0; i < x1->nTerms; i++) {
+            y->symbols[i] = x1->symbols[i];
+            mpfr_init2(&(y->deviations[i]), mpfr_get_prec(&(x1->deviations[i])));
+            mpfr_set(&(y->deviations[i]), &(x1->deviations[i]), MPFR_RNDN);
+        }
+    }
+    y->nTerms = x1->nTerms;
+}
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 53;
+    const arpra_prec prec_internal = 256;
+    const arpra_uint dims = 3;
+    const arpra_uint steps = 12;
+    const arpra_uint interval = 3;
+    const arpra_uint max_terms = 3;
+    const arpra_uint policies_n = 2;
+    arpra_uint i, j, x_dim, n_pre, n_post, condensed, fail, fail_n;
+    arpra_ode_stepper stepper, stepper_ref;
+    arpra_ode_reduce reduce;
+    arpra_range h;
+    mpfr_t rel_threshold;
+    test_ode ode, ode_ref;
+
+    // Init test.
+    arpra_set_internal_precision(prec_internal);
+    arpra_init2(&h, prec);
+    mpfr_init2(rel_threshold, prec);
+    arpra_set_d(&h, 0.125);
+    mpfr_set_d(rel_threshold, 1e-6, MPFR_RNDN);
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < policies_n; i++) {
+        fail = 0;
+
+        // Policy 0 condenses small terms every interval steps, and policy 1
+        // keeps at most max_terms terms.
+        reduce = (arpra_ode_reduce) {
+            .step_terms = 0,
+            .rel_threshold = (i == 0) ? rel_threshold : NULL,
+            .interval = (i == 0) ? interval : 0,
+            .max_terms = (i == 0) ? 0 : max_terms,
+            .step_count = 0,
+            .condensed = 0,
+        };
+        test_ode_init(&ode, 1, dims, -1.0, 0.01, prec);
+        test_ode_init(&ode_ref, 1, dims, -1.0, 0.01, prec);
+        ode_ref.params[0] = &(ode.lambda);
+        arpra_ode_stepper_init(&stepper, &(ode.system), arpra_ode_euler);
+        arpra_ode_stepper_init(&stepper_ref, &(ode_ref.system), arpra_ode_euler);
+        arpra_ode_stepper_set_reduce(&stepper, &reduce);
+
+        for (j = 1; j <= steps; j++) {
+            // The reference steps from the same state, with the same lambda,
+            // without reduction.
+            copy_exact(&(ode_ref.t), &(ode.t));
+            for (x_dim = 0; x_dim < dims; x_dim++) {
+                copy_exact(&(ode_ref.x[0][x_dim]), &(ode.x[0][x_dim]));
+            }
+            condensed = reduce.condensed;
+            arpra_ode_stepper_step(&stepper, &h);
+            arpra_ode_stepper_step(&stepper_ref, &h);
+
+            // Pass criteria (each step):
+            // 1) The step count is the number of steps taken.
+            // 2) The condensed count grows by the number of terms removed.
+            // 3) Small terms are condensed every interval steps, and only then.
+            // 4) No variable has more than max_terms terms.
+            // 5) The reduced state contains the unreduced state.
+            if (reduce.step_count != j) fail = 1;
+            for (x_dim = 0, n_pre = 0, n_post = 0; x_dim < dims; x_dim++) {
+                n_pre += ode_ref.x[0][x_dim].nTerms;
+                n_post += ode.x[0][x_dim].nTerms;
+                if ((i == 1) && (ode.x[0][x_dim].nTerms > max_terms)) fail = 1;
+                if (mpfr_greater_p(&(ode.x[0][x_dim].true_range.left),
+                                   &(ode_ref.x[0][x_dim].true_range.left))) fail = 1;
+                if (mpfr_less_p(&(ode.x[0][x_dim].true_range.right),
+                                &(ode_ref.x[0][x_dim].true_range.right))) fail = 1;
+            }
+            if ((reduce.condensed - condensed) != (n_pre - n_post)) fail = 1;
+            if ((i == 0) && (((j % interval) == 0) != (n_post < n_pre))) fail = 1;
+        }
+
+        // Pass criteria (after all steps):
+        // 1) Terms were condensed.
+        if (reduce.condensed == 0) fail = 1;
+
+        printf("Policy %lu: %s\n", i, (fail ? "FAIL" : "PASS"));
+        arpra_ode_stepper_clear(&stepper);
+        arpra_ode_stepper_clear(&stepper_ref);
+        test_ode_clear(&ode);
+        test_ode_clear(&ode_ref);
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, policies_n);
+    arpra_clear(&h);
+    mpfr_clear(rel_threshold);
+    arpra_ode_clear_tableaus();
+    arpra_clear_buffers();
+    mpfr_free_cache();
+    return fail_n > 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * t_ode_renumber.c -- Test the arpra_ode_stepper_renumber function.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-test.h"
+
+static int symbols_below (const arpra_range *x, arpra_uint n, arpra_uint lo, arpra_uint hi)
+{
+    arpra_uint i, i_x;
+
+    // Check that every symbol of x[0], ..., x[n - 1] lies in [lo, hi).
+    for (i = 0; i < n; i++) {
+        for (i_x = 0; i_x < x[i].nTerms; i_x++) {
+            if ((x[i].symbols[i_x] < lo) || (x[i].symbols[i_x] >= hi)) return 0;
+        }
+    }
+
+    return 1;
+}
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 53;
+    const arpra_prec prec_internal = 256;
+    const arpra_ode_method *methods[] = {
+        arpra_ode_bogsham32, arpra_ode_dopri54
+    };
+    const arpra_uint methods_n = sizeof(methods) / sizeof(methods[0]);
+    const arpra_uint grps = 2;
+    const arpra_uint dims = 3;
+    arpra_uint i, j, x_grp, x_dim, lo, hi, fail, fail_n;
+    arpra_ode_stepper stepper, stepper_ref, stepper_other;
+    arpra_range h, h_ref, *extra;
+    test_ode ode, ode_ref, ode_other;
+
+    // Init test.
+    arpra_set_internal_precision(prec_internal);
+    arpra_init2(&h, prec);
+    arpra_init2(&h_ref, prec);
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < methods_n; i++) {
+        fail = 0;
+        arpra_set_d(&h, 0.125);
+        arpra_set_d(&h_ref, 0.125);
+        test_ode_init(&ode, grps, dims, -1.0, 0.01, prec);
+        test_ode_init(&ode_ref, grps, dims, -1.0, 0.01, prec);
+        test_ode_init(&ode_other, grps, dims, -1.0, 0.01, prec);
+        test_ode_couple(&ode, 0.5);
+        test_ode_couple(&ode_ref, 0.5);
+        test_ode_couple(&ode_other, 0.5);
+        arpra_ode_stepper_init(&stepper, &(ode.system), methods[i]);
+        arpra_ode_stepper_init(&stepper_ref, &(ode_ref.system), methods[i]);
+        arpra_ode_stepper_init(&stepper_other, &(ode_other.system), methods[i]);
+        for (j = 0; j < 4; j++) {
+            arpra_ode_stepper_step(&stepper, &h);
+            arpra_ode_stepper_step(&stepper_ref, &h_ref);
+            arpra_ode_stepper_step(&stepper_other, &h_ref);
+        }
+
+        // Pass criteria (after renumbering):
+        // 1) The symbols of the state, coupling weights and sums lie between
+        //    the reserved symbols of cached constants and the symbol counter.
+        extra = &h;
+        arpra_ode_stepper_renumber(&stepper, &extra, 1);
+        lo = arpra_helper_get_symbol_floor();
+        hi = arpra_helper_get_symbol_count();
+        if (!symbols_below(&(ode.t), 1, lo, hi)) fail = 1;
+        for (x_grp = 0; x_grp < grps; x_grp++) {
+            if (!symbols_below(ode.x[x_grp], dims, lo, hi)) fail = 1;
+        }
+        if (!symbols_below(ode.weight, (2 * dims), lo, hi)) fail = 1;
+        if (!symbols_below(ode.sum, dims, lo, hi)) fail = 1;
+
+        // Pass criteria (steps after renumbering):
+        // 1) The renumbered stepper matches one which was not renumbered.
+        //    Cached constants now precede the state in symbol order, which
+        //    may change the rounding of the radius.
+        // 2) Other steppers of the same method are unaffected.
+        for (j = 0; j < 4; j++) {
+            arpra_ode_stepper_step(&stepper, &h);
+            arpra_ode_stepper_step(&stepper_ref, &h_ref);
+            arpra_ode_stepper_step(&stepper_other, &h_ref);
+        }
+        for (x_grp = 0; x_grp < grps; x_grp++) {
+            for (x_dim = 0; x_dim < dims; x_dim++) {
+                if (!mpfr_equal_p(&(ode.x[x_grp][x_dim].centre), &(ode_ref.x[x_grp][x_dim].centre))) fail = 1;
+                if (fabs(mpfr_get_d(&(ode.x[x_grp][x_dim].radius), MPFR_RNDN)
+                         / mpfr_get_d(&(ode_ref.x[x_grp][x_dim].radius), MPFR_RNDN) - 1) > 1e-9) fail = 1;
+                if (!mpfr_equal_p(&(ode_other.x[x_grp][x_dim].centre), &(ode_ref.x[x_grp][x_dim].centre))) fail = 1;
+                if (!mpfr_equal_p(&(ode_other.x[x_grp][x_dim].radius), &(ode_ref.x[x_grp][x_dim].radius))) fail = 1;
+            }
+        }
+
+        printf("Method %lu: %s\n", i, (fail ? "FAIL" : "PASS"));
+        arpra_ode_stepper_clear(&stepper);
+        arpra_ode_stepper_clear(&stepper_ref);
+        arpra_ode_stepper_clear(&stepper_other);
+        test_ode_clear(&ode);
+        test_ode_clear(&ode_ref);
+        test_ode_clear(&ode_other);
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, methods_n);
+    arpra_clear(&h);
+    arpra_clear(&h_ref);
+    arpra_ode_clear_tableaus();
+    arpra_clear_buffers();
+    mpfr_free_cache();
+    return fail_n > 0;
+}
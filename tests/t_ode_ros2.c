@@ -0,0 +1,114 @@
+/*
+ * t_ode_ros2.c -- Test the ROS2 Rosenbrock step method.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "arpra-test.h"
+
+static void linear_jac (arpra_range *dfdx, const void *params,
+                        const arpra_range *t, const arpra_range **x,
+                        const arpra_uint x_grp, const arpra_uint x_dim,
+                        const arpra_uint y_grp, const arpra_uint y_dim)
+{
+    const arpra_range *lambda = (const arpra_range *) params;
+
+    // d(lambda x_i)/dx_j = lambda if i = j, else 0
+    if ((x_grp == y_grp) && (x_dim == y_dim)) {
+        arpra_set(dfdx, lambda);
+    }
+    else {
+        arpra_set_zero(dfdx);
+    }
+}
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 53;
+    const arpra_prec prec_internal = 256;
+    const double lambdas[] = {-1.0, -1000.0};
+    const arpra_uint lambdas_n = sizeof(lambdas) / sizeof(lambdas[0]);
+    const arpra_uint grps = 3, dims = 2, steps = 40;
+    arpra_uint i, j, x_grp, x_dim, fail, fail_n;
+    arpra_uint deps_0[1] = {0}, deps_1[1] = {1}, deps_2[1] = {2};
+    arpra_uint *deps[3] = {deps_0, deps_1, deps_2};
+    arpra_uint n_deps[3] = {1, 1, 1};
+    arpra_ode_jac jac[3] = {linear_jac, linear_jac, linear_jac};
+    arpra_ode_stepper stepper, stepper_block, stepper_jac;
+    arpra_range h;
+    double t, x, x_block, x_jac;
+    test_ode ode, ode_block, ode_jac;
+
+    // Init test.
+    arpra_set_internal_precision(prec_internal);
+    arpra_init2(&h, prec);
+    arpra_set_d(&h, 0.05);
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < lambdas_n; i++) {
+        fail = 0;
+        test_ode_init(&ode, grps, dims, lambdas[i], 0.0, prec);
+        test_ode_init(&ode_block, grps, dims, lambdas[i], 0.0, prec);
+        test_ode_init(&ode_jac, grps, dims, lambdas[i], 0.0, prec);
+        ode_block.system.deps = deps;
+        ode_block.system.n_deps = n_deps;
+        ode_jac.system.jac = jac;
+        arpra_ode_stepper_init(&stepper, &(ode.system), arpra_ode_ros2);
+        arpra_ode_stepper_init(&stepper_block, &(ode_block.system), arpra_ode_ros2);
+        arpra_ode_stepper_init(&stepper_jac, &(ode_jac.system), arpra_ode_ros2);
+        for (j = 0; j < steps; j++) {
+            arpra_ode_stepper_step(&stepper, &h);
+            arpra_ode_stepper_step(&stepper_block, &h);
+            arpra_ode_stepper_step(&stepper_jac, &h);
+        }
+
+        // Pass criteria:
+        // 1) x is within 1e-2 of exp(lambda t) x(0), even for stiff lambda.
+        // 2) The dense, block structured and user-supplied Jacobians agree.
+        t = mpfr_get_d(&(ode.t.centre), MPFR_RNDN);
+        for (x_grp = 0, j = 0; x_grp < grps; x_grp++) {
+            for (x_dim = 0; x_dim < dims; x_dim++, j++) {
+                x = mpfr_get_d(&(ode.x[x_grp][x_dim].centre), MPFR_RNDN);
+                x_block = mpfr_get_d(&(ode_block.x[x_grp][x_dim].centre), MPFR_RNDN);
+                x_jac = mpfr_get_d(&(ode_jac.x[x_grp][x_dim].centre), MPFR_RNDN);
+                if (!(fabs(x - (1 + (j / 8.)) * exp(lambdas[i] * t)) <= 1e-2)) fail = 1;
+                if (!(fabs(x - x_block) <= 1e-12)) fail = 1;
+                if (!(fabs(x - x_jac) <= 1e-6)) fail = 1;
+            }
+        }
+
+        printf("Lambda %lu: %s\n", i, (fail ? "FAIL" : "PASS"));
+        arpra_ode_stepper_clear(&stepper);
+        arpra_ode_stepper_clear(&stepper_block);
+        arpra_ode_stepper_clear(&stepper_jac);
+        test_ode_clear(&ode);
+        test_ode_clear(&ode_block);
+        test_ode_clear(&ode_jac);
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, lambdas_n);
+    arpra_clear(&h);
+    arpra_ode_clear_tableaus();
+    arpra_clear_buffers();
+    mpfr_free_cache();
+    return fail_n > 0;
+}
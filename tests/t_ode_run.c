@@ -0,0 +1,116 @@
+/*
+ * t_ode_run.c -- Test batched multi-step ODE runs.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "arpra-test.h"
+
+typedef struct observed_struct
+{
+    arpra_uint n;
+    arpra_uint step[16];
+    int bad_t;
+} observed;
+
+static void observe_steps (void *data, const arpra_ode_system *system, const arpra_uint step)
+{
+    observed *obs = (observed *) data;
+
+    // Record the step, and check that t has advanced by step h.
+    if (obs->n < 16) obs->step[obs->n] = step;
+    obs->n++;
+    if (mpfr_cmp_d(&(system->t->centre), 0.125 * step) != 0) obs->bad_t = 1;
+}
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 53;
+    const arpra_prec prec_internal = 256;
+    const arpra_uint intervals[] = {0, 3, 5, 10};
+    const arpra_uint intervals_n = sizeof(intervals) / sizeof(intervals[0]);
+    const arpra_uint expected[4][4] = {{10}, {3, 6, 9, 10}, {5, 10}, {10}};
+    const arpra_uint expected_n[4] = {1, 4, 2, 1};
+    const arpra_uint steps = 10;
+    const arpra_uint dims = 2;
+    arpra_uint i, j, x_dim, fail, fail_n;
+    arpra_ode_stepper stepper, stepper_ref;
+    arpra_ode_observer observer;
+    observed obs;
+    arpra_range h;
+    test_ode ode, ode_ref;
+
+    // Init test.
+    arpra_set_internal_precision(prec_internal);
+    arpra_init2(&h, prec);
+    arpra_set_d(&h, 0.125);
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < intervals_n; i++) {
+        fail = 0;
+        test_ode_init(&ode, 1, dims, -1.0, 0.01, prec);
+        test_ode_init(&ode_ref, 1, dims, -1.0, 0.01, prec);
+        arpra_ode_stepper_init(&stepper, &(ode.system), arpra_ode_dopri54);
+        arpra_ode_stepper_init(&stepper_ref, &(ode_ref.system), arpra_ode_dopri54);
+        obs = (observed) {.n = 0, .bad_t = 0};
+        observer = (arpra_ode_observer) {
+            .observe = observe_steps,
+            .data = &obs,
+            .interval = intervals[i],
+        };
+        arpra_ode_stepper_run(&stepper, &h, steps, &observer, NULL);
+        for (j = 0; j < steps; j++) {
+            arpra_ode_stepper_step(&stepper_ref, &h);
+        }
+
+        // Pass criteria:
+        // 1) The observer is called every interval steps, and after the last step.
+        // 2) The observer sees the state after the step it is called for.
+        // 3) The final state matches that of single steps.
+        if (obs.n != expected_n[i]) {
+            fail = 1;
+        }
+        else {
+            for (j = 0; j < obs.n; j++) {
+                if (obs.step[j] != expected[i][j]) fail = 1;
+            }
+        }
+        if (obs.bad_t) fail = 1;
+        for (x_dim = 0; x_dim < dims; x_dim++) {
+            if (!mpfr_equal_p(&(ode.x[0][x_dim].centre), &(ode_ref.x[0][x_dim].centre))) fail = 1;
+            if (!mpfr_equal_p(&(ode.x[0][x_dim].radius), &(ode_ref.x[0][x_dim].radius))) fail = 1;
+        }
+
+        printf("Interval %lu: %s\n", intervals[i], (fail ? "FAIL" : "PASS"));
+        arpra_ode_stepper_clear(&stepper);
+        arpra_ode_stepper_clear(&stepper_ref);
+        test_ode_clear(&ode);
+        test_ode_clear(&ode_ref);
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, intervals_n);
+    arpra_clear(&h);
+    arpra_ode_clear_tableaus();
+    arpra_clear_buffers();
+    mpfr_free_cache();
+    return fail_n > 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * t_ode_stages.c -- Test the scheduled evaluation of ODE stages.
+ *
+ * Copyright 2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-test.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif // _OPENMP
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 53;
+    const arpra_prec prec_internal = 256;
+    const arpra_ode_method *methods[] = {
+        arpra_ode_bogsham32, arpra_ode_dopri54, arpra_ode_dopri87
+    };
+    const arpra_uint methods_n = sizeof(methods) / sizeof(methods[0]);
+    const arpra_uint grps = 3, dims = 2, steps = 20;
+    arpra_uint i, j, x_grp, x_dim, fail, fail_n;
+    arpra_uint deps_0[1] = {0}, deps_1[2] = {0, 1}, deps_2[1] = {2};
+    arpra_uint *deps[3] = {deps_0, deps_1, deps_2};
+    arpra_uint n_deps[3] = {1, 2, 1};
+    arpra_ode_stepper stepper, stepper_ref;
+    arpra_range h;
+    test_ode ode, ode_ref;
+
+    // Init test. Use several threads, even on one core, so that tasks interleave.
+#ifdef _OPENMP
+    omp_set_num_threads(4);
+#endif // _OPENMP
+    arpra_set_internal_precision(prec_internal);
+    arpra_init2(&h, prec);
+    arpra_set_d(&h, 0.0625);
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < methods_n; i++) {
+        fail = 0;
+        test_ode_init(&ode, grps, dims, -1.0, 0.01, prec);
+        test_ode_init(&ode_ref, grps, dims, -1.0, 0.01, prec);
+        test_ode_couple(&ode, 0.5);
+        test_ode_couple(&ode_ref, 0.5);
+        ode.system.deps = deps;
+        ode.system.n_deps = n_deps;
+        arpra_ode_stepper_init(&stepper, &(ode.system), methods[i]);
+        arpra_ode_stepper_init(&stepper_ref, &(ode_ref.system), methods[i]);
+
+        // Pass criteria:
+        // 1) Stages run as a task graph match stages run in order, after
+        //    every step. Symbols are created in a different order, which
+        //    may change the rounding of the radius.
+        // 2) So do the coupled sums that the steps leave behind.
+        for (j = 0; j < steps; j++) {
+            arpra_ode_stepper_step(&stepper, &h);
+            arpra_ode_stepper_step(&stepper_ref, &h);
+            for (x_grp = 0; x_grp < grps; x_grp++) {
+                for (x_dim = 0; x_dim < dims; x_dim++) {
+                    if (!mpfr_equal_p(&(ode.x[x_grp][x_dim].centre), &(ode_ref.x[x_grp][x_dim].centre))) fail = 1;
+                    if (fabs(mpfr_get_d(&(ode.x[x_grp][x_dim].radius), MPFR_RNDN)
+                             / mpfr_get_d(&(ode_ref.x[x_grp][x_dim].radius), MPFR_RNDN) - 1) > 1e-9) fail = 1;
+                }
+            }
+            for (x_dim = 0; x_dim < dims; x_dim++) {
+                if (!mpfr_equal_p(&(ode.sum[x_dim].centre), &(ode_ref.sum[x_dim].centre))) fail = 1;
+            }
+        }
+
+        printf("Method %lu: %s\n", i, (fail ? "FAIL" : "PASS"));
+        arpra_ode_stepper_clear(&stepper);
+        arpra_ode_stepper_clear(&stepper_ref);
+        test_ode_clear(&ode);
+        test_ode_clear(&ode_ref);
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, methods_n);
+    arpra_clear(&h);
+    arpra_ode_clear_tableaus();
+    arpra_clear_buffers();
+    mpfr_free_cache();
+    return fail_n > 0;
+}
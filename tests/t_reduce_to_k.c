@@ -0,0 +1,70 @@
+/*
+ * t_reduce_to_k.c -- Test the arpra_reduce_to_k function.
+ *
+ * Copyright 2017-2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-test.h"
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 24;
+    const arpra_prec prec_internal = 256;
+    const arpra_uint test_n = 10000;
+    const arpra_uint sample_n = 16;
+    mpfr_t x_value;
+    arpra_uint i, k, fresh, sample, fail, fail_n;
+
+    // Init test.
+    test_fixture_init(prec, prec_internal);
+    arpra_set_range_method(ARPRA_AA);
+    test_log_init("reduce_to_k");
+    test_rand_init();
+    mpfr_init2(x_value, (4 * prec_internal));
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < test_n; i++) {
+        fail = 0;
+        test_rand_arpra(&x1_A, TEST_RAND_MIXED, TEST_RAND_SMALL);
+        k = gmp_urandomm_ui(test_randstate, 10);
+        fresh = arpra_helper_get_symbol_count();
+        arpra_reduce_to_k(&y_A, &x1_A, k);
+
+        // Pass criteria:
+        // 1) Arpra y has at most k + 1 terms.
+        // 2) Arpra y contains x, with the k kept symbols still correlated.
+        if (y_A.nTerms > (k + 1)) fail = 1;
+        for (sample = 0; sample < sample_n; sample++) {
+            test_sample_value(x_value, &x1_A, sample);
+            if (!test_sample_contains(&y_A, x_value, fresh, sample)) fail = 1;
+        }
+
+        test_log_printf("Test %lu: k = %lu, %lu terms to %lu terms\n", i, k, x1_A.nTerms, y_A.nTerms);
+        test_log_printf("Result: %s\n\n", (fail ? "FAIL" : "PASS"));
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, test_n);
+    mpfr_clear(x_value);
+    test_fixture_clear();
+    test_log_clear();
+    test_rand_clear();
+    return fail_n > 0;
+}
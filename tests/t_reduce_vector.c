@@ -0,0 +1,113 @@
+/*
+ * t_reduce_vector.c -- Test the arpra_reduce_vector function.
+ *
+ * Copyright 2017-2020 James Paul Turner.
+ *
+ * This file is part of the Arpra library.
+ *
+ * The Arpra library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Arpra library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the Arpra library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arpra-test.h"
+
+int main (int argc, char *argv[])
+{
+    const arpra_prec prec = 24;
+    const arpra_prec prec_internal = 256;
+    const arpra_uint test_n = 10000;
+    const arpra_uint sample_n = 16;
+    const arpra_uint pool_n = 12;
+    const arpra_uint range_n = 4;
+    arpra_range x[range_n], y[range_n];
+    arpra_uint pool[pool_n];
+    mpfr_t x_value;
+    arpra_uint i, j, k, i_x, m, n_kept, offset, fresh, sample, fail, fail_n;
+    char kept[pool_n];
+
+    // Init test.
+    test_fixture_init(prec, prec_internal);
+    arpra_set_range_method(ARPRA_AA);
+    test_log_init("reduce_vector");
+    test_rand_init();
+    mpfr_init2(x_value, (4 * prec_internal));
+    for (j = 0; j < range_n; j++) {
+        arpra_init2(&(x[j]), prec);
+        arpra_init2(&(y[j]), prec);
+    }
+    fail_n = 0;
+
+    // Run test.
+    for (i = 0; i < test_n; i++) {
+        fail = 0;
+
+        // Draw the ranges' symbols from a common pool, so that they overlap.
+        for (m = 0; m < pool_n; m++) {
+            pool[m] = arpra_helper_next_symbol();
+        }
+        for (j = 0; j < range_n; j++) {
+            test_rand_arpra(&(x[j]), TEST_RAND_MIXED, TEST_RAND_SMALL);
+            offset = gmp_urandomm_ui(test_randstate, (pool_n - x[j].nTerms + 2));
+            for (i_x = 0; i_x < (x[j].nTerms - 1); i_x++) {
+                x[j].symbols[i_x] = pool[offset + i_x];
+            }
+        }
+        k = gmp_urandomm_ui(test_randstate, 10);
+        fresh = arpra_helper_get_symbol_count();
+        arpra_reduce_vector(y, x, range_n, k);
+
+        // Pass criteria:
+        // 1) At most k old symbols are kept, across all Arpra y.
+        // 2) Each Arpra y has at most k + 1 terms.
+        // 3) Each Arpra y contains its x, with the kept symbols correlated.
+        memset(kept, 0, pool_n);
+        n_kept = 0;
+        for (j = 0; j < range_n; j++) {
+            if (y[j].nTerms > (k + 1)) fail = 1;
+            for (i_x = 0; i_x < y[j].nTerms; i_x++) {
+                if (y[j].symbols[i_x] >= fresh) continue;
+                for (m = 0; (m < pool_n) && (y[j].symbols[i_x] != pool[m]); m++);
+                if (m == pool_n) {
+                    n_kept++;
+                }
+                else if (!kept[m]) {
+                    kept[m] = 1;
+                    n_kept++;
+                }
+            }
+        }
+        if (n_kept > k) fail = 1;
+        for (sample = 0; sample < sample_n; sample++) {
+            for (j = 0; j < range_n; j++) {
+                test_sample_value(x_value, &(x[j]), sample);
+                if (!test_sample_contains(&(y[j]), x_value, fresh, sample)) fail = 1;
+            }
+        }
+
+        test_log_printf("Test %lu: k = %lu, %lu symbols kept\n", i, k, n_kept);
+        test_log_printf("Result: %s\n\n", (fail ? "FAIL" : "PASS"));
+        if (fail) fail_n++;
+    }
+
+    // Cleanup test.
+    printf("%lu out of %lu failed.\n", fail_n, test_n);
+    for (j = 0; j < range_n; j++) {
+        arpra_clear(&(x[j]));
+        arpra_clear(&(y[j]));
+    }
+    mpfr_clear(x_value);
+    test_fixture_clear();
+    test_log_clear();
+    test_rand_clear();
+    return fail_n > 0;
+}